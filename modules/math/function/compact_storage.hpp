@@ -0,0 +1,226 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <math/index.hpp>
+#include <math/function/grid_storage.hpp>
+
+namespace math {
+namespace function {
+
+// Codecs of compact storages, packing float values in 16 bits.
+// A codec provides code_type, encode(float) and decode(code_type). The conversions are
+// inline and free of branches, so loops over many values are vectorised by the compiler.
+
+namespace internal {
+
+inline std::uint32_t floatBits(float value) {
+	std::uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+inline float bitsFloat(std::uint32_t bits) {
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+}	// Namespace internal.
+
+// IEEE 754 half precision: 11 significant bits, about 3 decimal digits, magnitudes up to
+// 65504. Rounds to nearest even; larger values become infinite.
+struct HalfCodec {
+	using code_type = std::uint16_t;
+
+	static code_type encode(float value);
+	static float decode(code_type code);
+};
+
+// Upper half of a float: 8 significant bits, about 2 decimal digits, with the whole float
+// range. Rounds to nearest even.
+struct BFloat16Codec {
+	using code_type = std::uint16_t;
+
+	static code_type encode(float value);
+	static float decode(code_type code);
+};
+
+// 16 bit integers with an offset and a scale shared by the grid: value = offset + scale * code.
+// The absolute error is at most scale / 2, uniform over the range. Values outside of the
+// range saturate.
+class ScaledInt16Codec {
+	float _offset;
+	float _scale;
+	float _inverse;
+
+public:
+	using code_type = std::int16_t;
+
+	ScaledInt16Codec(float offset = 0.0f, float scale = 1.0f);
+
+	// Codec covering [lower, upper] with the finest scale.
+	static ScaledInt16Codec range(float lower, float upper);
+
+	// Accessor functions.
+	inline float offset() const {return _offset;}
+	inline float scale() const {return _scale;}
+
+	code_type encode(float value) const;
+	float decode(code_type code) const;
+};
+
+
+// Reference to a value of a compact storage, converting on access.
+template <typename Codec>
+class CompactReference {
+	using code_type = typename Codec::code_type;
+
+	const Codec* _codec;
+	code_type* _code;
+
+public:
+	CompactReference(const Codec& codec, code_type& code) : _codec(&codec), _code(&code) {}
+
+	inline operator float() const {return _codec->decode(*_code);}
+	inline CompactReference& operator=(float value) {*_code = _codec->encode(value); return *this;}
+	inline CompactReference& operator=(const CompactReference& other) {return *this = static_cast<float>(other);}
+	inline CompactReference& operator+=(float value) {return *this = static_cast<float>(*this) + value;}
+	inline CompactReference& operator-=(float value) {return *this = static_cast<float>(*this) - value;}
+	inline CompactReference& operator*=(float value) {return *this = static_cast<float>(*this) * value;}
+	inline CompactReference& operator/=(float value) {return *this = static_cast<float>(*this) / value;}
+};
+
+
+// Storage of float values packed in 16 bits by a codec, for large read-mostly grids such
+// as lookup tables. Halves the memory and bandwidth of float grids.
+// Values are widened to float on access: const access returns a float and non-const
+// access a CompactReference, so interpolation, derivatives and reductions all compute in
+// float. The grid element type must be float.
+// Grids returned by partial_x() and partial_y() get a default codec, which for
+// ScaledInt16Codec is rarely the right scale: use the evaluate_partial functions instead.
+template <typename Codec>
+class CompactStorage {
+public:
+	using code_type = typename Codec::code_type;
+	using value_type = float;
+	using reference = CompactReference<Codec>;
+	using const_reference = float;
+
+private:
+	Codec _codec;
+	std::vector<code_type> _codes;
+
+public:
+	explicit CompactStorage(math::index_t size = 0, const Codec& codec = Codec());
+
+	// Accessor functions.
+	inline math::index_t size() const {return _codes.size();}
+	inline const Codec& codec() const {return _codec;}
+	inline const code_type* data() const {return _codes.data();}
+	inline code_type* data() {return _codes.data();}
+	inline float operator[](math::index_t k) const {return _codec.decode(_codes[k]);}
+	inline reference operator[](math::index_t k) {return reference(_codec, _codes[k]);}
+
+	// Conversion of count consecutive values, from position first.
+	void decode(math::index_t first, math::index_t count, float* values) const;
+	void encode(math::index_t first, math::index_t count, const float* values);
+};
+
+using HalfStorage = CompactStorage<HalfCodec>;
+using BFloat16Storage = CompactStorage<BFloat16Codec>;
+using ScaledInt16Storage = CompactStorage<ScaledInt16Codec>;
+
+// Grids of other element types, such as gradients, are stored at full precision.
+template <typename Codec, typename F>
+struct StorageRebind<CompactStorage<Codec>, F> {
+	using type = std::vector<F>;
+};
+
+
+inline HalfCodec::code_type HalfCodec::encode(float value) {
+	std::uint32_t bits = internal::floatBits(value);
+	std::uint32_t sign = (bits >> 16) & 0x8000u;
+	bits &= 0x7fffffffu;
+
+	// Normal halves: rebias the exponent, and round the mantissa to nearest even.
+	std::uint32_t normal = (bits + 0xc8000fffu + ((bits >> 13) & 1u)) >> 13;
+
+	// Subnormal halves: the float addition aligns and rounds the mantissa.
+	std::uint32_t subnormal = internal::floatBits(internal::bitsFloat(bits) + 0.5f) - 0x3f000000u;
+
+	std::uint32_t special = (bits > 0x7f800000u) ? 0x7e00u : 0x7c00u;
+	std::uint32_t code = (bits < 0x38800000u) ? subnormal : normal;
+	code = (bits >= 0x47800000u) ? special : code;
+	return static_cast<code_type>(code | sign);
+}
+
+inline float HalfCodec::decode(code_type code) {
+	std::uint32_t bits = (static_cast<std::uint32_t>(code) & 0x7fffu) << 13;
+	std::uint32_t exponent = bits & 0x0f800000u;
+	bits += 0x38000000u;
+
+	// Infinities and NaN keep the maximum exponent. Subnormals are normalised by a float subtraction.
+	std::uint32_t special = bits + 0x38000000u;
+	std::uint32_t subnormal = internal::floatBits(internal::bitsFloat(bits + 0x00800000u) - internal::bitsFloat(0x38800000u));
+
+	std::uint32_t result = (exponent == 0) ? subnormal : bits;
+	result = (exponent == 0x0f800000u) ? special : result;
+	return internal::bitsFloat(result | ((static_cast<std::uint32_t>(code) & 0x8000u) << 16));
+}
+
+
+inline BFloat16Codec::code_type BFloat16Codec::encode(float value) {
+	std::uint32_t bits = internal::floatBits(value);
+	std::uint32_t rounded = (bits + 0x7fffu + ((bits >> 16) & 1u)) >> 16;
+
+	// NaN stays a quiet NaN, rounding could turn it into infinity.
+	std::uint32_t nan = (bits >> 16) | 0x0040u;
+	return static_cast<code_type>(((bits & 0x7fffffffu) > 0x7f800000u) ? nan : rounded);
+}
+
+inline float BFloat16Codec::decode(code_type code) {
+	return internal::bitsFloat(static_cast<std::uint32_t>(code) << 16);
+}
+
+
+inline ScaledInt16Codec::ScaledInt16Codec(float offset, float scale) : _offset(offset), _scale(scale), _inverse(1.0f / scale) {
+	if (not (scale > 0.0f)) throw std::invalid_argument("Scale must be positive.");
+}
+
+inline ScaledInt16Codec ScaledInt16Codec::range(float lower, float upper) {
+	if (not (upper > lower)) throw std::invalid_argument("Empty range.");
+	return ScaledInt16Codec(0.5f * (lower + upper), (upper - lower) / 65534.0f);
+}
+
+inline ScaledInt16Codec::code_type ScaledInt16Codec::encode(float value) const {
+	float code = (value - _offset) * _inverse;
+	code = std::min(std::max(-32767.0f, code), 32767.0f);
+	return static_cast<code_type>(std::floor(code + 0.5f));
+}
+
+inline float ScaledInt16Codec::decode(code_type code) const {
+	return _offset + _scale * static_cast<float>(code);
+}
+
+
+template <typename Codec>
+CompactStorage<Codec>::CompactStorage(math::index_t size, const Codec& codec) : _codec(codec), _codes(size, codec.encode(0.0f)) {}
+
+template <typename Codec>
+void CompactStorage<Codec>::decode(math::index_t first, math::index_t count, float* values) const {
+	const code_type* codes = _codes.data() + first;
+	for (math::index_t k = 0; k < count; ++k) values[k] = _codec.decode(codes[k]);
+}
+
+template <typename Codec>
+void CompactStorage<Codec>::encode(math::index_t first, math::index_t count, const float* values) {
+	code_type* codes = _codes.data() + first;
+	for (math::index_t k = 0; k < count; ++k) codes[k] = _codec.encode(values[k]);
+}
+
+}	// Namespace function.
+}	// Namespace math.
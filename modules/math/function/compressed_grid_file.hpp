@@ -0,0 +1,353 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <math/linear/static_vector.hpp>
+#include <math/function/square_grid.hpp>
+#include <math/function/grid_file.hpp>
+#include <math/function/tile_codec.hpp>
+#include <math/parallel/parallel_for.hpp>
+
+namespace math {
+namespace function {
+
+// Chunked, compressed file format for scalar floating point SquareGrids.
+// The grid is cut in square tiles, each compressed on its own by the tile codec, so
+// tiles are compressed and decompressed in parallel, and a reader only decompresses
+// the tiles a query touches. The file holds a 128 byte header, the tile index
+// (offset and size of each compressed tile) and the compressed tiles.
+
+// Options of saveCompressedGrid.
+struct CompressionOptions {
+	unsigned tileSize = 64;
+	double errorBound = 0.0;		// Zero is lossless. Otherwise the maximum absolute error.
+	unsigned threads = 0;			// Zero uses all hardware threads.
+};
+
+// File header. Every field has a fixed width; the whole header is 128 bytes.
+struct CompressedGridFileHeader {
+	static const std::uint32_t currentVersion = 1;
+
+	char magic[8];				// "SQTILE\0\0".
+	std::uint32_t version;
+	std::uint32_t byteOrder;	// 0x01020304 as written by the producer.
+	std::uint32_t sizex;
+	std::uint32_t sizey;
+	std::uint32_t scalarType;	// GridScalarType.
+	std::uint32_t tileSize;
+	std::uint32_t tilesx;
+	std::uint32_t tilesy;
+	double errorBound;
+	double spacing;
+	double startx;
+	double starty;
+	std::uint64_t indexOffset;
+	char padding[128 - 80];
+};
+
+static_assert(sizeof(CompressedGridFileHeader) == 128, "The compressed grid file header must be 128 bytes");
+
+// Position of a compressed tile in the file.
+struct CompressedTileEntry {
+	std::uint64_t offset;
+	std::uint64_t size;
+};
+
+
+namespace internal {
+
+inline void writeAll(int file, const void* data, std::size_t size) {
+	const char* bytes = static_cast<const char*>(data);
+	while (size > 0) {
+		ssize_t count = write(file, bytes, size);
+		if (count <= 0) throw std::runtime_error("Could not write the compressed grid file.");
+		bytes += count;
+		size -= count;
+	}
+}
+
+inline void readAll(int file, void* data, std::size_t size, std::uint64_t offset) {
+	char* bytes = static_cast<char*>(data);
+	while (size > 0) {
+		ssize_t count = pread(file, bytes, size, static_cast<off_t>(offset));
+		if (count <= 0) throw std::runtime_error("Could not read the compressed grid file.");
+		bytes += count;
+		size -= count;
+		offset += count;
+	}
+}
+
+}	// Namespace internal.
+
+
+// Compress a grid into path.
+template <typename T, typename E, typename Layout, typename Storage>
+void saveCompressedGrid(const std::string& path, const SquareGrid<T,E,Layout,Storage>& grid, const CompressionOptions& options = CompressionOptions()) {
+	static_assert(std::is_floating_point<E>::value, "Compressed grids hold floating point values");
+	if (options.tileSize == 0) throw std::invalid_argument("Tiles must have at least one value.");
+	if (options.errorBound < 0.0) throw std::invalid_argument("The error bound can not be negative.");
+
+	unsigned tile = options.tileSize;
+	unsigned tilesx = (grid.sizex() + tile - 1) / tile;
+	unsigned tilesy = (grid.sizey() + tile - 1) / tile;
+	unsigned tiles = tilesx * tilesy;
+
+	// Compress the tiles in parallel, each into its own buffer.
+	std::vector<std::vector<std::uint8_t>> blobs(tiles);
+	math::parallel::parallelFor(0, tiles, options.threads, [&](unsigned first, unsigned last) {
+		std::vector<E> values;
+		for (unsigned t = first; t < last; ++t) {
+			unsigned i0 = (t % tilesx) * tile;
+			unsigned j0 = (t / tilesx) * tile;
+			unsigned width = std::min(tile, grid.sizex() - i0);
+			unsigned height = std::min(tile, grid.sizey() - j0);
+
+			values.resize(static_cast<std::size_t>(width) * height);
+			for (unsigned j = 0; j < height; ++j) {
+				for (unsigned i = 0; i < width; ++i) values[j*width + i] = grid.dataEvaluation(i0+i, j0+j);
+			}
+
+			if (options.errorBound == 0.0) codec::compressLossless(values.data(), width, height, blobs[t]);
+			else codec::compressLossy(values.data(), width, height, static_cast<E>(options.errorBound), blobs[t]);
+		}
+	});
+
+	CompressedGridFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "SQTILE\0\0", 8);
+	header.version = CompressedGridFileHeader::currentVersion;
+	header.byteOrder = GridFileHeader::nativeByteOrder;
+	header.sizex = grid.sizex();
+	header.sizey = grid.sizey();
+	header.scalarType = static_cast<std::uint32_t>(GridElementTraits<E>::scalar);
+	header.tileSize = tile;
+	header.tilesx = tilesx;
+	header.tilesy = tilesy;
+	header.errorBound = options.errorBound;
+	header.spacing = static_cast<double>(grid.spacing());
+	header.startx = static_cast<double>(grid.start().x());
+	header.starty = static_cast<double>(grid.start().y());
+	header.indexOffset = sizeof(header);
+
+	std::vector<CompressedTileEntry> index(tiles);
+	std::uint64_t offset = header.indexOffset + tiles * sizeof(CompressedTileEntry);
+	for (unsigned t = 0; t < tiles; ++t) {
+		index[t].offset = offset;
+		index[t].size = blobs[t].size();
+		offset += blobs[t].size();
+	}
+
+	int file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (file < 0) throw std::runtime_error("Could not create the compressed grid file.");
+	try {
+		internal::writeAll(file, &header, sizeof(header));
+		internal::writeAll(file, index.data(), index.size() * sizeof(CompressedTileEntry));
+		for (const auto& blob : blobs) internal::writeAll(file, blob.data(), blob.size());
+	} catch (...) {
+		close(file);
+		throw;
+	}
+
+	close(file);
+}
+
+
+// Random access reader of compressed grid files.
+// Decompressed tiles are kept in a small cache. Not safe to share between threads.
+template <typename T, typename E>
+class CompressedGridReader {
+	int _file;
+	CompressedGridFileHeader _header;
+	std::vector<CompressedTileEntry> _index;
+
+	// Cache of decompressed tiles. Shared, so tiles handed out outlive their eviction.
+	unsigned _cachecapacity;
+	mutable std::map<unsigned, std::shared_ptr<const std::vector<E>>> _cache;
+
+	void decompress(unsigned tile, std::vector<E>& values) const;
+
+public:
+	explicit CompressedGridReader(const std::string& path, unsigned cachecapacity = 16);
+	CompressedGridReader(const CompressedGridReader&) = delete;
+	CompressedGridReader& operator=(const CompressedGridReader&) = delete;
+	~CompressedGridReader();
+
+	// Accessor functions.
+	inline unsigned sizex() const {return _header.sizex;}
+	inline unsigned sizey() const {return _header.sizey;}
+	inline unsigned tileSize() const {return _header.tileSize;}
+	inline unsigned tilesx() const {return _header.tilesx;}
+	inline unsigned tilesy() const {return _header.tilesy;}
+	inline T spacing() const {return static_cast<T>(_header.spacing);}
+	inline double errorBound() const {return _header.errorBound;}
+	math::linear::StaticVector<T,2> start() const;
+	std::uint64_t compressedSize() const;
+
+	// Decompressed tile tx,ty, row-major, clipped at the grid edges.
+	std::shared_ptr<const std::vector<E>> tile(unsigned tx, unsigned ty) const;
+
+	// Value at a grid point. Decompresses its tile if needed.
+	E dataEvaluation(unsigned i, unsigned j) const;
+
+	// Bilinear interpolation, like SquareGrid::evaluate. Touches at most four tiles.
+	E evaluate(const T& x, const T& y) const;
+
+	// Sub-grid [i0, i0+nx) x [j0, j0+ny), decompressing only the touched tiles, in parallel.
+	SquareGrid<T,E> read(unsigned i0, unsigned j0, unsigned nx, unsigned ny, unsigned threads = 0) const;
+	SquareGrid<T,E> read(unsigned threads = 0) const;
+};
+
+
+template <typename T, typename E>
+CompressedGridReader<T,E>::CompressedGridReader(const std::string& path, unsigned cachecapacity) : _file(-1), _cachecapacity(std::max(cachecapacity, 1u)) {
+	static_assert(std::is_floating_point<E>::value, "Compressed grids hold floating point values");
+	_file = open(path.c_str(), O_RDONLY);
+	if (_file < 0) throw std::runtime_error("Could not open the compressed grid file.");
+
+	try {
+		internal::readAll(_file, &_header, sizeof(_header), 0);
+		if (std::memcmp(_header.magic, "SQTILE\0\0", 8) != 0) throw std::runtime_error("Not a compressed grid file.");
+		if (_header.byteOrder != GridFileHeader::nativeByteOrder) throw std::runtime_error("Compressed grid file written with another byte order.");
+		if (_header.version > CompressedGridFileHeader::currentVersion) throw std::runtime_error("Compressed grid file version not supported.");
+		if (_header.scalarType != static_cast<std::uint32_t>(GridElementTraits<E>::scalar)) throw std::runtime_error("Compressed grid file holds another element type.");
+		if (_header.tileSize == 0) throw std::runtime_error("Compressed grid file with empty tiles.");
+		std::uint64_t tilesx = (static_cast<std::uint64_t>(_header.sizex) + _header.tileSize - 1) / _header.tileSize;
+		std::uint64_t tilesy = (static_cast<std::uint64_t>(_header.sizey) + _header.tileSize - 1) / _header.tileSize;
+		if (_header.tilesx != tilesx  or  _header.tilesy != tilesy) throw std::runtime_error("Compressed grid file tiles do not cover the grid.");
+
+		_index.resize(static_cast<std::size_t>(_header.tilesx) * _header.tilesy);
+		internal::readAll(_file, _index.data(), _index.size() * sizeof(CompressedTileEntry), _header.indexOffset);
+	} catch (...) {
+		close(_file);
+		throw;
+	}
+}
+
+template <typename T, typename E>
+CompressedGridReader<T,E>::~CompressedGridReader() {
+	if (_file >= 0) close(_file);
+}
+
+template <typename T, typename E>
+math::linear::StaticVector<T,2> CompressedGridReader<T,E>::start() const {
+	return math::linear::StaticVector<T,2>({static_cast<T>(_header.startx), static_cast<T>(_header.starty)});
+}
+
+template <typename T, typename E>
+std::uint64_t CompressedGridReader<T,E>::compressedSize() const {
+	std::uint64_t size = 0;
+	for (const auto& entry : _index) size += entry.size;
+	return size;
+}
+
+template <typename T, typename E>
+void CompressedGridReader<T,E>::decompress(unsigned tile, std::vector<E>& values) const {
+	unsigned size = _header.tileSize;
+	unsigned width = std::min(size, _header.sizex - (tile % _header.tilesx) * size);
+	unsigned height = std::min(size, _header.sizey - (tile / _header.tilesx) * size);
+
+	std::vector<std::uint8_t> blob(_index[tile].size);
+	internal::readAll(_file, blob.data(), blob.size(), _index[tile].offset);
+
+	values.resize(static_cast<std::size_t>(width) * height);
+	if (_header.errorBound == 0.0) codec::decompressLossless(blob.data(), blob.size(), width, height, values.data());
+	else codec::decompressLossy(blob.data(), blob.size(), width, height, static_cast<E>(_header.errorBound), values.data());
+}
+
+template <typename T, typename E>
+std::shared_ptr<const std::vector<E>> CompressedGridReader<T,E>::tile(unsigned tx, unsigned ty) const {
+	if (tx >= _header.tilesx  or  ty >= _header.tilesy) throw std::invalid_argument("Outside of the tiles of the grid.");
+	unsigned id = ty * _header.tilesx + tx;
+
+	auto found = _cache.find(id);
+	if (found != _cache.end()) return found->second;
+
+	auto values = std::make_shared<std::vector<E>>();
+	decompress(id, *values);
+	if (_cache.size() >= _cachecapacity) _cache.clear();
+	_cache[id] = values;
+	return values;
+}
+
+template <typename T, typename E>
+E CompressedGridReader<T,E>::dataEvaluation(unsigned i, unsigned j) const {
+	unsigned size = _header.tileSize;
+	auto values = tile(i / size, j / size);
+	unsigned width = std::min(size, _header.sizex - (i / size) * size);
+	return (*values)[(j % size) * width + (i % size)];
+}
+
+template <typename T, typename E>
+E CompressedGridReader<T,E>::evaluate(const T& x, const T& y) const {
+	// Same conventions as SquareGrid::linearInterpolationEvaluation.
+	math::linear::StaticVector<T,2> origin = start();
+	T end_x = origin.x() + spacing() * static_cast<T>(sizex()-1);
+	T end_y = origin.y() + spacing() * static_cast<T>(sizey()-1);
+	if (x < origin.x()  or  y < origin.y()  or  x > end_x  or  y > end_y) throw std::invalid_argument("Outside of domain of the function.");
+
+	T fx = (x - origin.x()) / spacing();
+	T fy = (y - origin.y()) / spacing();
+	unsigned i = std::min(static_cast<unsigned>(std::floor(fx)), sizex()-1);
+	unsigned j = std::min(static_cast<unsigned>(std::floor(fy)), sizey()-1);
+	if (i == sizex()-1  or  j == sizey()-1) return dataEvaluation(i,j);
+
+	T u = fx - static_cast<T>(i);
+	T v = fy - static_cast<T>(j);
+	return
+		+ dataEvaluation(i,j) * ((T(1.0) - u) * (T(1.0) - v))
+		+ dataEvaluation(i+1,j) * (u * (T(1.0) - v))
+		+ dataEvaluation(i,j+1) * ((T(1.0) - u) * v)
+		+ dataEvaluation(i+1,j+1) * (u * v)
+	;
+}
+
+template <typename T, typename E>
+SquareGrid<T,E> CompressedGridReader<T,E>::read(unsigned i0, unsigned j0, unsigned nx, unsigned ny, unsigned threads) const {
+	if (nx == 0  or  ny == 0  or  i0 + nx > sizex()  or  j0 + ny > sizey()) throw std::invalid_argument("Region outside of the grid.");
+
+	math::linear::StaticVector<T,2> offset({static_cast<T>(i0), static_cast<T>(j0)});
+	SquareGrid<T,E> grid(nx, ny, spacing(), start() + spacing() * offset);
+
+	// Touched tiles.
+	unsigned size = _header.tileSize;
+	unsigned tx0 = i0 / size, tx1 = (i0 + nx - 1) / size;
+	unsigned ty0 = j0 / size, ty1 = (j0 + ny - 1) / size;
+	unsigned touchedx = tx1 - tx0 + 1;
+	unsigned touched = touchedx * (ty1 - ty0 + 1);
+
+	// Each tile covers its own part of the output grid.
+	math::parallel::parallelFor(0, touched, threads, [&](unsigned first, unsigned last) {
+		std::vector<E> values;
+		for (unsigned t = first; t < last; ++t) {
+			unsigned tx = tx0 + t % touchedx;
+			unsigned ty = ty0 + t / touchedx;
+			decompress(ty * _header.tilesx + tx, values);
+
+			unsigned width = std::min(size, sizex() - tx * size);
+			unsigned ibegin = std::max(i0, tx * size), iend = std::min(i0 + nx, tx * size + width);
+			unsigned jbegin = std::max(j0, ty * size), jend = std::min(j0 + ny, (ty + 1) * size);
+			for (unsigned j = jbegin; j < jend; ++j) {
+				for (unsigned i = ibegin; i < iend; ++i) {
+					grid.dataEvaluation(i - i0, j - j0) = values[(j - ty * size) * width + (i - tx * size)];
+				}
+			}
+		}
+	});
+
+	return grid;
+}
+
+template <typename T, typename E>
+SquareGrid<T,E> CompressedGridReader<T,E>::read(unsigned threads) const {
+	return read(0, 0, sizex(), sizey(), threads);
+}
+
+}	// Namespace function.
+}	// Namespace math.
@@ -0,0 +1,190 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <math/index.hpp>
+#include <math/linear/static_vector.hpp>
+#include <math/memory/aligned_allocator.hpp>
+
+namespace math {
+namespace function {
+
+// Cubic kernels of CubicInterpolator.
+enum class CubicKernel {
+	CatmullRom,		// Interpolating: goes through the grid values, exact for quadratics.
+	BSpline			// Approximating: twice continuously differentiable, smoothest fields.
+};
+
+
+// Piecewise bicubic interpolation of a grid.
+// The 16 polynomial coefficients of every cell are computed once, from the 4x4 grid
+// points around it (replicated at the edges), and stored in cache-line aligned cells.
+// Evaluating is then a cell lookup and a Horner evaluation of a single polynomial.
+// Works with any grid providing sizex, sizey, spacing, start and dataEvaluation.
+template <typename T, typename E=T>
+class CubicInterpolator {
+	// Coefficients a[m][n] of u^m v^n, u and v the local coordinates in the cell.
+	struct alignas(64) Cell {
+		E a[4][4];
+	};
+
+	unsigned _sizex;
+	unsigned _sizey;
+	T _spacing;
+	math::linear::StaticVector<T,2> _start;
+	std::vector<Cell, math::memory::AlignedAllocator<Cell, 64>> _cells;
+
+	void locateCell(const math::linear::StaticVector<T,2>& coord, unsigned& i, unsigned& j, T& u, T& v) const;
+
+public:
+	template <typename Grid>
+	explicit CubicInterpolator(const Grid& grid, CubicKernel kernel = CubicKernel::CatmullRom);
+
+	// Accessor functions.
+	inline unsigned sizex() const {return _sizex;}
+	inline unsigned sizey() const {return _sizey;}
+	inline const T& spacing() const {return _spacing;}
+	inline const math::linear::StaticVector<T,2>& start() const {return _start;}
+	inline math::linear::StaticVector<T,2> end() const {return _start + _spacing * math::linear::StaticVector<T,2>({static_cast<T>(_sizex-1), static_cast<T>(_sizey-1)});}
+
+	// Interpolated evaluation.
+	E evaluate(const math::linear::StaticVector<T,2>& coord) const;
+	E operator()(const math::linear::StaticVector<T,2>& coord) const;
+	E evaluate(const T& x, const T& y) const;
+	E operator()(const T& x, const T& y) const;
+	void evaluate(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const;
+
+	// Exact gradient of the interpolating polynomial.
+	math::linear::StaticVector<E,2> evaluate_gradient(const math::linear::StaticVector<T,2>& coord) const;
+};
+
+
+template <typename T, typename E>
+template <typename Grid>
+CubicInterpolator<T,E>::CubicInterpolator(const Grid& grid, CubicKernel kernel)
+: _sizex(grid.sizex()), _sizey(grid.sizey()), _spacing(grid.spacing()), _start(grid.start()) {
+	if (_sizex < 2 or _sizey < 2) throw std::invalid_argument("Cubic interpolation needs at least 2x2 grid points.");
+
+	// Basis matrix: p(t) = [1 t t^2 t^3] M [f(-1) f(0) f(1) f(2)].
+	static const T catmullrom[4][4] = {
+		{T(0.0), T(1.0), T(0.0), T(0.0)},
+		{T(-0.5), T(0.0), T(0.5), T(0.0)},
+		{T(1.0), T(-2.5), T(2.0), T(-0.5)},
+		{T(-0.5), T(1.5), T(-1.5), T(0.5)}
+	};
+
+	static const T bspline[4][4] = {
+		{T(1.0/6.0), T(4.0/6.0), T(1.0/6.0), T(0.0)},
+		{T(-0.5), T(0.0), T(0.5), T(0.0)},
+		{T(0.5), T(-1.0), T(0.5), T(0.0)},
+		{T(-1.0/6.0), T(0.5), T(-0.5), T(1.0/6.0)}
+	};
+
+	const T (*M)[4] = (kernel == CubicKernel::CatmullRom) ? catmullrom : bspline;
+
+	unsigned cellsx = _sizex - 1;
+	unsigned cellsy = _sizey - 1;
+	_cells.resize(static_cast<std::size_t>(cellsx) * cellsy);
+
+	for (unsigned j = 0; j < cellsy; ++j) {
+		for (unsigned i = 0; i < cellsx; ++i) {
+			// Values around the cell, replicated at the edges.
+			E F[4][4];
+			for (unsigned r = 0; r < 4; ++r) {
+				unsigned ii = static_cast<unsigned>(std::min(std::max(static_cast<int>(i) + static_cast<int>(r) - 1, 0), static_cast<int>(_sizex) - 1));
+				for (unsigned c = 0; c < 4; ++c) {
+					unsigned jj = static_cast<unsigned>(std::min(std::max(static_cast<int>(j) + static_cast<int>(c) - 1, 0), static_cast<int>(_sizey) - 1));
+					F[r][c] = grid.dataEvaluation(ii, jj);
+				}
+			}
+
+			// MF = M F, then a = MF M^T.
+			E MF[4][4];
+			for (unsigned m = 0; m < 4; ++m) {
+				for (unsigned c = 0; c < 4; ++c) {
+					MF[m][c] = F[0][c] * M[m][0] + F[1][c] * M[m][1] + F[2][c] * M[m][2] + F[3][c] * M[m][3];
+				}
+			}
+
+			Cell& cell = _cells[static_cast<std::size_t>(j) * cellsx + i];
+			for (unsigned m = 0; m < 4; ++m) {
+				for (unsigned n = 0; n < 4; ++n) {
+					cell.a[m][n] = MF[m][0] * M[n][0] + MF[m][1] * M[n][1] + MF[m][2] * M[n][2] + MF[m][3] * M[n][3];
+				}
+			}
+		}
+	}
+}
+
+template <typename T, typename E>
+void CubicInterpolator<T,E>::locateCell(const math::linear::StaticVector<T,2>& coord, unsigned& i, unsigned& j, T& u, T& v) const {
+	// Check limits to verify if we are inside domain.
+	if (coord.x() < start().x()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.y() < start().y()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.x() > end().x()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.y() > end().y()) throw std::invalid_argument("Outside of domain of the function.");
+
+	T x = (coord.x() - _start.x()) / _spacing;
+	T y = (coord.y() - _start.y()) / _spacing;
+	i = std::min(static_cast<unsigned>(std::floor(x)), _sizex-2);
+	j = std::min(static_cast<unsigned>(std::floor(y)), _sizey-2);
+	u = x - static_cast<T>(i);
+	v = y - static_cast<T>(j);
+}
+
+template <typename T, typename E>
+E CubicInterpolator<T,E>::evaluate(const math::linear::StaticVector<T,2>& coord) const {
+	unsigned i, j;
+	T u, v;
+	locateCell(coord, i, j, u, v);
+
+	const Cell& cell = _cells[static_cast<std::size_t>(j) * (_sizex-1) + i];
+	E rows[4];
+	for (unsigned m = 0; m < 4; ++m) rows[m] = ((cell.a[m][3] * v + cell.a[m][2]) * v + cell.a[m][1]) * v + cell.a[m][0];
+	return ((rows[3] * u + rows[2]) * u + rows[1]) * u + rows[0];
+}
+
+template <typename T, typename E>
+E CubicInterpolator<T,E>::operator()(const math::linear::StaticVector<T,2>& coord) const {
+	return evaluate(coord);
+}
+
+template <typename T, typename E>
+E CubicInterpolator<T,E>::evaluate(const T& x, const T& y) const {
+	return evaluate(math::linear::StaticVector<T,2>({x, y}));
+}
+
+template <typename T, typename E>
+E CubicInterpolator<T,E>::operator()(const T& x, const T& y) const {
+	return evaluate(math::linear::StaticVector<T,2>({x, y}));
+}
+
+template <typename T, typename E>
+void CubicInterpolator<T,E>::evaluate(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const {
+	math::index_t size = coords.size();
+	values.resize(size);
+	for (math::index_t k = 0; k < size; ++k) values[k] = evaluate(coords[k]);
+}
+
+template <typename T, typename E>
+math::linear::StaticVector<E,2> CubicInterpolator<T,E>::evaluate_gradient(const math::linear::StaticVector<T,2>& coord) const {
+	unsigned i, j;
+	T u, v;
+	locateCell(coord, i, j, u, v);
+
+	const Cell& cell = _cells[static_cast<std::size_t>(j) * (_sizex-1) + i];
+	E rows[4];
+	E drows[4];
+	for (unsigned m = 0; m < 4; ++m) {
+		rows[m] = ((cell.a[m][3] * v + cell.a[m][2]) * v + cell.a[m][1]) * v + cell.a[m][0];
+		drows[m] = (cell.a[m][3] * (T(3.0) * v) + cell.a[m][2] * T(2.0)) * v + cell.a[m][1];
+	}
+
+	E xpartial = (rows[3] * (T(3.0) * u) + rows[2] * T(2.0)) * u + rows[1];
+	E ypartial = ((drows[3] * u + drows[2]) * u + drows[1]) * u + drows[0];
+	return math::linear::StaticVector<E,2>({xpartial / _spacing, ypartial / _spacing});
+}
+
+}	// Namespace function.
+}	// Namespace math.
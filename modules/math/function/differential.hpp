@@ -0,0 +1,140 @@
+#pragma once
+#include <cmath>
+#include <stdexcept>
+#include <math/linear/static_vector.hpp>
+#include <math/function/square_grid.hpp>
+#include <math/parallel/parallel_for.hpp>
+
+namespace math {
+namespace function {
+
+// Differential operators writing into caller-provided grids.
+// All outputs cover the interior of the input, exactly like partial_x(), partial_y() and
+// gradient() do: sizes (sizex-2, sizey-2), started one spacing inside. Output grids can be
+// allocated once and reused. Rows are split across threads; threads=0 uses all of them.
+// Inputs can be any grid with sizex, sizey, spacing and dataEvaluation, such as views.
+
+// Outputs of fusedDifferential(). Null pointers are skipped.
+template <typename T, typename E, typename Layout=RowMajorLayout, typename Storage=std::vector<E>>
+struct DifferentialOutputs {
+	SquareGrid<T,math::linear::StaticVector<E,2>,Layout,RebindStorage<Storage,math::linear::StaticVector<E,2>>>* gradient = nullptr;
+	SquareGrid<T,E,Layout,Storage>* gradientMagnitude = nullptr;
+	SquareGrid<T,E,Layout,Storage>* laplacian = nullptr;
+};
+
+namespace internal {
+
+template <typename Grid, typename Output>
+void checkInteriorGrid(const Grid& input, const Output& output) {
+	if (input.sizex() < 3 or input.sizey() < 3) throw std::invalid_argument("Grid too small for central differences.");
+	if (output.sizex() != input.sizex()-2) throw std::invalid_argument("Output grid has the wrong size.");
+	if (output.sizey() != input.sizey()-2) throw std::invalid_argument("Output grid has the wrong size.");
+}
+
+}	// Namespace internal.
+
+
+// Interior grid matching the outputs of the operators below.
+template <typename F, typename T, typename E, typename Layout, typename Storage>
+SquareGrid<T,F,Layout,RebindStorage<Storage,F>> interiorGrid(const SquareGrid<T,E,Layout,Storage>& grid) {
+	math::linear::StaticVector<T,2> one({static_cast<T>(1.0), static_cast<T>(1.0)});
+	return SquareGrid<T,F,Layout,RebindStorage<Storage,F>>(grid.sizex()-2, grid.sizey()-2, grid.spacing(), grid.start() + grid.spacing() * one);
+}
+
+
+// Gradient, gradient magnitude and Laplacian in a single pass over the input.
+template <typename Grid, typename T, typename E, typename Layout, typename OutputStorage>
+void fusedDifferential(const Grid& phi, const DifferentialOutputs<T,E,Layout,OutputStorage>& outputs, unsigned threads = 1) {
+	if (outputs.gradient) internal::checkInteriorGrid(phi, *outputs.gradient);
+	if (outputs.gradientMagnitude) internal::checkInteriorGrid(phi, *outputs.gradientMagnitude);
+	if (outputs.laplacian) internal::checkInteriorGrid(phi, *outputs.laplacian);
+
+	unsigned sx = phi.sizex();
+	T halfinverse = T(1.0) / (T(2.0) * phi.spacing());
+	T squareinverse = T(1.0) / (phi.spacing() * phi.spacing());
+
+	math::parallel::parallelFor(1, phi.sizey()-1, threads, [&](unsigned first, unsigned last) {
+		for (unsigned j = first; j < last; ++j) {
+			for (unsigned i = 1; i < sx-1; ++i) {
+				E center = phi.dataEvaluation(i,j);
+				E right = phi.dataEvaluation(i+1,j);
+				E left = phi.dataEvaluation(i-1,j);
+				E up = phi.dataEvaluation(i,j+1);
+				E down = phi.dataEvaluation(i,j-1);
+
+				E xpartial = (right - left) * halfinverse;
+				E ypartial = (up - down) * halfinverse;
+
+				if (outputs.gradient) outputs.gradient->dataEvaluation(i-1,j-1) = math::linear::StaticVector<E,2>({xpartial, ypartial});
+				if (outputs.gradientMagnitude) outputs.gradientMagnitude->dataEvaluation(i-1,j-1) = std::sqrt(xpartial*xpartial + ypartial*ypartial);
+				if (outputs.laplacian) outputs.laplacian->dataEvaluation(i-1,j-1) = (right + left + up + down - E(4.0)*center) * squareinverse;
+			}
+		}
+	});
+}
+
+
+// Gradient of a scalar field.
+template <typename Grid, typename T, typename E, typename Layout, typename OutputStorage>
+void gradient(const Grid& phi, SquareGrid<T,math::linear::StaticVector<E,2>,Layout,OutputStorage>& output, unsigned threads = 1) {
+	DifferentialOutputs<T,E,Layout,RebindStorage<OutputStorage,E>> outputs;
+	outputs.gradient = &output;
+	fusedDifferential(phi, outputs, threads);
+}
+
+// Euclidean norm of the gradient of a scalar field.
+template <typename Grid, typename T, typename E, typename Layout, typename OutputStorage>
+void gradientMagnitude(const Grid& phi, SquareGrid<T,E,Layout,OutputStorage>& output, unsigned threads = 1) {
+	DifferentialOutputs<T,E,Layout,OutputStorage> outputs;
+	outputs.gradientMagnitude = &output;
+	fusedDifferential(phi, outputs, threads);
+}
+
+// Five point Laplacian of a scalar field.
+template <typename Grid, typename T, typename E, typename Layout, typename OutputStorage>
+void laplacian(const Grid& phi, SquareGrid<T,E,Layout,OutputStorage>& output, unsigned threads = 1) {
+	DifferentialOutputs<T,E,Layout,OutputStorage> outputs;
+	outputs.laplacian = &output;
+	fusedDifferential(phi, outputs, threads);
+}
+
+
+// Divergence and scalar curl (dFy/dx - dFx/dy) of a vector field in a single pass.
+// Either output may be null.
+template <typename T, typename E, typename Layout, typename OutputStorage, typename Grid>
+void divergenceAndCurl(const Grid& field, SquareGrid<T,E,Layout,OutputStorage>* divergence, SquareGrid<T,E,Layout,OutputStorage>* curl, unsigned threads = 1) {
+	if (divergence) internal::checkInteriorGrid(field, *divergence);
+	if (curl) internal::checkInteriorGrid(field, *curl);
+
+	unsigned sx = field.sizex();
+	T halfinverse = T(1.0) / (T(2.0) * field.spacing());
+
+	math::parallel::parallelFor(1, field.sizey()-1, threads, [&](unsigned first, unsigned last) {
+		for (unsigned j = first; j < last; ++j) {
+			for (unsigned i = 1; i < sx-1; ++i) {
+				const math::linear::StaticVector<E,2>& right = field.dataEvaluation(i+1,j);
+				const math::linear::StaticVector<E,2>& left = field.dataEvaluation(i-1,j);
+				const math::linear::StaticVector<E,2>& up = field.dataEvaluation(i,j+1);
+				const math::linear::StaticVector<E,2>& down = field.dataEvaluation(i,j-1);
+
+				if (divergence) divergence->dataEvaluation(i-1,j-1) = ((right.x() - left.x()) + (up.y() - down.y())) * halfinverse;
+				if (curl) curl->dataEvaluation(i-1,j-1) = ((right.y() - left.y()) - (up.x() - down.x())) * halfinverse;
+			}
+		}
+	});
+}
+
+// Divergence of a vector field.
+template <typename Grid, typename T, typename E, typename Layout, typename OutputStorage>
+void divergence(const Grid& field, SquareGrid<T,E,Layout,OutputStorage>& output, unsigned threads = 1) {
+	divergenceAndCurl<T,E,Layout,OutputStorage>(field, &output, nullptr, threads);
+}
+
+// Scalar curl of a vector field.
+template <typename Grid, typename T, typename E, typename Layout, typename OutputStorage>
+void curl(const Grid& field, SquareGrid<T,E,Layout,OutputStorage>& output, unsigned threads = 1) {
+	divergenceAndCurl<T,E,Layout,OutputStorage>(field, nullptr, &output, threads);
+}
+
+}	// Namespace function.
+}	// Namespace math.
@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <math/index.hpp>
+#include <math/linear/static_vector.hpp>
+#include <math/function/grid_layout.hpp>
+#include <math/function/fixed_storage.hpp>
+#include <math/function/square_grid.hpp>
+
+namespace math {
+namespace function {
+
+// SquareGrid of NX x NY points fixed at compile time, for small grids used in hot loops.
+// Values are held in place, without allocation, and sizes and index math are constants:
+// algorithms taking any grid see constant loop bounds and strides, which compilers unroll
+// and vectorise. Operators inherited from SquareGrid, such as gradient(), return grids of
+// the same fixed layout and storage.
+template <typename T, typename E, unsigned NX, unsigned NY>
+class FixedSquareGrid : public SquareGrid<T, E, FixedLayout<NX,NY>, FixedStorage<E, static_cast<math::index_t>(NX) * NY>> {
+	static_assert(NX > 1 and NY > 1, "Fixed grids need at least 2x2 points");
+
+public:
+	using Base = SquareGrid<T, E, FixedLayout<NX,NY>, FixedStorage<E, static_cast<math::index_t>(NX) * NY>>;
+
+	FixedSquareGrid(const T& spacing, math::linear::StaticVector<T,2> start = math::linear::StaticVector<T,2>()) : Base(NX, NY, spacing, start) {}
+	using Base::operator=;
+
+	// Accessor functions
+	static constexpr unsigned sizex() {return NX;}
+	static constexpr unsigned sizey() {return NY;}
+
+	// Transfer from ij-coordinates to the image coordinates.
+	static constexpr math::index_t datafromij(unsigned i, unsigned j) {return static_cast<math::index_t>(j) * NX + i;}
+
+	// Evaluation at grid points.
+	inline const E& dataEvaluation(unsigned i, unsigned j) const {return this->_data[datafromij(i,j)];}
+	inline E& dataEvaluation(unsigned i, unsigned j) {return this->_data[datafromij(i,j)];}
+
+	// Interpolated evaluation.
+	E evaluate(const math::linear::StaticVector<T,2>& coord) const;
+	E operator()(const math::linear::StaticVector<T,2>& coord) const {return evaluate(coord);}
+	E evaluate(const T& x, const T& y) const {return evaluate(math::linear::StaticVector<T,2>({x, y}));}
+	E operator()(const T& x, const T& y) const {return evaluate(math::linear::StaticVector<T,2>({x, y}));}
+	void evaluate(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const;
+};
+
+
+template <typename T, typename E, unsigned NX, unsigned NY>
+E FixedSquareGrid<T,E,NX,NY>::evaluate(const math::linear::StaticVector<T,2>& coord) const {
+	// Check limits to verify if we are inside domain.
+	T x = (coord.x() - this->start().x()) / this->spacing();
+	T y = (coord.y() - this->start().y()) / this->spacing();
+	if (not (x >= T(0.0) and y >= T(0.0))) throw std::invalid_argument("Outside of domain of the function.");
+	if (x > static_cast<T>(NX-1) or y > static_cast<T>(NY-1)) throw std::invalid_argument("Outside of domain of the function.");
+
+	// Cell and local coordinates. Points on the upper edges belong to the last cell.
+	unsigned i = std::min(static_cast<unsigned>(x), NX-2);
+	unsigned j = std::min(static_cast<unsigned>(y), NY-2);
+	T u = x - static_cast<T>(i);
+	T v = y - static_cast<T>(j);
+
+	const E* values = this->_data.data() + datafromij(i,j);
+	return
+		+ values[0] * ((T(1.0) - u) * (T(1.0) - v))
+		+ values[1] * (u * (T(1.0) - v))
+		+ values[NX] * ((T(1.0) - u) * v)
+		+ values[NX+1] * (u * v)
+	;
+}
+
+template <typename T, typename E, unsigned NX, unsigned NY>
+void FixedSquareGrid<T,E,NX,NY>::evaluate(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const {
+	math::index_t size = coords.size();
+	values.resize(size);
+	for (math::index_t k = 0; k < size; ++k) values[k] = evaluate(coords[k]);
+}
+
+}	// Namespace function.
+}	// Namespace math.
@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <stdexcept>
+#include <math/index.hpp>
+#include <math/function/grid_storage.hpp>
+
+namespace math {
+namespace function {
+
+// Storage of N values held in place, in a std::array: no allocation, and grids using it
+// can live on the stack or inside other objects. Storages of any size up to N are
+// accepted, and always hold N values, so they pair with FixedLayout.
+template <typename E, math::index_t N>
+class FixedStorage {
+	std::array<E,N> _values;
+
+public:
+	using value_type = E;
+	using reference = E&;
+	using const_reference = const E&;
+
+	explicit FixedStorage(math::index_t size = N, const E& value = E());
+
+	// Accessor functions.
+	static constexpr math::index_t size() {return N;}
+	inline const E* data() const {return _values.data();}
+	inline E* data() {return _values.data();}
+	inline const E& operator[](math::index_t i) const {return _values[i];}
+	inline E& operator[](math::index_t i) {return _values[i];}
+};
+
+template <typename E, math::index_t N, typename F>
+struct StorageRebind<FixedStorage<E,N>, F> {
+	using type = FixedStorage<F,N>;
+};
+
+
+template <typename E, math::index_t N>
+FixedStorage<E,N>::FixedStorage(math::index_t size, const E& value) {
+	if (size > N) throw std::invalid_argument("Storage larger than its capacity.");
+	_values.fill(value);
+}
+
+}	// Namespace function.
+}	// Namespace math.
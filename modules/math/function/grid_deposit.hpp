@@ -0,0 +1,125 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <math/index.hpp>
+#include <math/linear/static_vector.hpp>
+#include <math/function/grid_storage.hpp>
+#include <math/parallel/parallel_for.hpp>
+
+namespace math {
+namespace function {
+
+// Deposit of particle quantities on a grid with bilinear weights, the transpose of the
+// bilinear interpolation of SquareGrid: a particle adds its quantity times the weight
+// evaluate() would give each corner of its cell. Quantities add to the grid values.
+//
+// Particles are binned by tiles of TileCells x TileCells cells, keeping their order. Each
+// tile is accumulated in a buffer private to its thread, then added to the grid. Tiles
+// share their edge points, so they are added in four phases, by parity of the tile
+// position, where no two tiles touch the same point. No atomics are needed, and every
+// grid point receives its sums in the same order for any number of threads.
+template <unsigned TileCells = 16, typename Grid, typename T, typename Q>
+void deposit(Grid& grid, const std::vector<math::linear::StaticVector<T,2>>& positions, const std::vector<Q>& quantities, unsigned threads = 1) {
+	using E = typename std::decay<decltype(std::declval<const Grid&>().dataEvaluation(0,0))>::type;
+	static_assert(TileCells > 0, "Tiles need at least one cell");
+	if (positions.size() != quantities.size()) throw std::invalid_argument("Positions and quantities have different sizes.");
+	if (grid.sizex() < 2 or grid.sizey() < 2) throw std::invalid_argument("Deposit needs at least 2x2 grid points.");
+
+	math::index_t count = positions.size();
+	unsigned cellsx = grid.sizex() - 1;
+	unsigned cellsy = grid.sizey() - 1;
+	unsigned tilesx = (cellsx + TileCells - 1) / TileCells;
+	unsigned tilesy = (cellsy + TileCells - 1) / TileCells;
+	T spacing = grid.spacing();
+	math::linear::StaticVector<T,2> start = grid.start();
+	math::linear::StaticVector<T,2> end = grid.end();
+
+	// Cell of a particle, in grid coordinates. Points on the upper edges belong to the last cell.
+	auto locate = [&](const math::linear::StaticVector<T,2>& position, unsigned& i, unsigned& j, T& u, T& v) {
+		T x = (position.x() - start.x()) / spacing;
+		T y = (position.y() - start.y()) / spacing;
+		i = std::min(static_cast<unsigned>(std::floor(x)), cellsx-1);
+		j = std::min(static_cast<unsigned>(std::floor(y)), cellsy-1);
+		u = x - static_cast<T>(i);
+		v = y - static_cast<T>(j);
+	};
+
+	// Bin the particles by tile, with a stable counting sort. Nothing is written before
+	// every particle is known to be inside the domain.
+	math::index_t tiles = static_cast<math::index_t>(tilesx) * tilesy;
+	std::vector<math::index_t> tileof(count);
+	std::vector<math::index_t> offsets(tiles + 1, 0);
+	for (math::index_t p = 0; p < count; ++p) {
+		const math::linear::StaticVector<T,2>& position = positions[p];
+		if (position.x() < start.x() or position.y() < start.y()) throw std::invalid_argument("Outside of domain of the function.");
+		if (position.x() > end.x() or position.y() > end.y()) throw std::invalid_argument("Outside of domain of the function.");
+
+		unsigned i, j;
+		T u, v;
+		locate(position, i, j, u, v);
+		tileof[p] = static_cast<math::index_t>(j / TileCells) * tilesx + i / TileCells;
+		++offsets[tileof[p] + 1];
+	}
+
+	for (math::index_t t = 0; t < tiles; ++t) offsets[t+1] += offsets[t];
+	std::vector<math::index_t> order(count);
+	std::vector<math::index_t> next(offsets.begin(), offsets.end() - 1);
+	for (math::index_t p = 0; p < count; ++p) order[next[tileof[p]]++] = p;
+
+	threads = internal::concurrentWriteThreads(grid, threads, 0);
+	unsigned width = TileCells + 1;
+	for (unsigned phase = 0; phase < 4; ++phase) {
+		// Occupied tiles of the phase.
+		std::vector<math::index_t> occupied;
+		for (unsigned ty = phase / 2; ty < tilesy; ty += 2) {
+			for (unsigned tx = phase % 2; tx < tilesx; tx += 2) {
+				math::index_t t = static_cast<math::index_t>(ty) * tilesx + tx;
+				if (offsets[t] < offsets[t+1]) occupied.push_back(t);
+			}
+		}
+
+		math::parallel::parallelFor(0, occupied.size(), threads, [&](math::index_t first, math::index_t last) {
+			std::vector<E> buffer(width * width);
+			for (math::index_t k = first; k < last; ++k) {
+				math::index_t t = occupied[k];
+				unsigned i0 = static_cast<unsigned>(t % tilesx) * TileCells;
+				unsigned j0 = static_cast<unsigned>(t / tilesx) * TileCells;
+				std::fill(buffer.begin(), buffer.end(), E());
+
+				for (math::index_t n = offsets[t]; n < offsets[t+1]; ++n) {
+					math::index_t p = order[n];
+					unsigned i, j;
+					T u, v;
+					locate(positions[p], i, j, u, v);
+
+					unsigned b = (j - j0) * width + (i - i0);
+					const Q& q = quantities[p];
+					buffer[b] += q * ((T(1.0) - u) * (T(1.0) - v));
+					buffer[b+1] += q * (u * (T(1.0) - v));
+					buffer[b+width] += q * ((T(1.0) - u) * v);
+					buffer[b+width+1] += q * (u * v);
+				}
+
+				// Add the buffer to the points of the tile.
+				unsigned nx = std::min(width, grid.sizex() - i0);
+				unsigned ny = std::min(width, grid.sizey() - j0);
+				for (unsigned jj = 0; jj < ny; ++jj) {
+					for (unsigned ii = 0; ii < nx; ++ii) grid.dataEvaluation(i0 + ii, j0 + jj) += buffer[jj * width + ii];
+				}
+			}
+		});
+	}
+}
+
+// Deposit of the same quantity for every particle, such as the charge of one species.
+template <unsigned TileCells = 16, typename Grid, typename T, typename Q>
+auto deposit(Grid& grid, const std::vector<math::linear::StaticVector<T,2>>& positions, const Q& quantity, unsigned threads = 1) -> typename std::enable_if<std::is_arithmetic<Q>::value>::type {
+	deposit<TileCells>(grid, positions, std::vector<Q>(positions.size(), quantity), threads);
+}
+
+}	// Namespace function.
+}	// Namespace math.
@@ -0,0 +1,261 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <math/linear/static_vector.hpp>
+
+namespace math {
+namespace solver {
+template <typename T> class FiniteElement;
+}	// Namespace solver.
+}	// Namespace math.
+
+namespace math {
+namespace function {
+
+// Streaming exporters of grids to VTK image data and CSV.
+// Grids are read row by row through dataEvaluation and formatted into a large buffer
+// that is written out whenever it fills, so no copy of the grid is ever made.
+// Any grid with sizex, sizey, spacing, start, domainfromij and dataEvaluation works:
+// SquareGrid with any layout or storage, and FDM solutions.
+
+// Options of the exporters.
+struct ExportOptions {
+	unsigned stride = 1;				// Export every stride-th point in each direction.
+	unsigned precision = 0;				// Significant digits of text output. Zero is exact round trip.
+	std::size_t bufferSize = 1 << 20;	// Bytes buffered between writes.
+	std::string name = "value";			// Name of the exported field.
+};
+
+// Scalar type and components of exported elements.
+template <typename E>
+struct ExportTraits {
+	using scalar = E;
+	static const unsigned components = 1;
+	static scalar component(const E& value, unsigned) {return value;}
+};
+
+template <typename S, unsigned D>
+struct ExportTraits<math::linear::StaticVector<S,D>> {
+	using scalar = S;
+	static const unsigned components = D;
+	static scalar component(const math::linear::StaticVector<S,D>& value, unsigned c) {return value[c];}
+};
+
+template <typename S>
+struct ExportTraits<math::solver::FiniteElement<S>> {
+	using scalar = S;
+	static const unsigned components = 1;
+	static scalar component(const math::solver::FiniteElement<S>& value, unsigned) {return value.value();}
+};
+
+
+// File writer with a large buffer.
+class BufferedFileWriter {
+	int _file;
+	std::vector<char> _buffer;
+	std::size_t _used;
+
+public:
+	BufferedFileWriter(const std::string& path, std::size_t size) : _file(-1), _buffer(std::max<std::size_t>(size, 64)), _used(0) {
+		_file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (_file < 0) throw std::runtime_error("Could not create the export file.");
+	}
+
+	BufferedFileWriter(const BufferedFileWriter&) = delete;
+	BufferedFileWriter& operator=(const BufferedFileWriter&) = delete;
+
+	~BufferedFileWriter() {
+		if (_file >= 0) close(_file);
+	}
+
+	void flush() {
+		const char* bytes = _buffer.data();
+		while (_used > 0) {
+			ssize_t count = write(_file, bytes, _used);
+			if (count <= 0) throw std::runtime_error("Could not write the export file.");
+			bytes += count;
+			_used -= count;
+		}
+	}
+
+	// Room for at least size bytes at the end of the buffer.
+	char* reserve(std::size_t size) {
+		if (size > _buffer.size()) {
+			flush();
+			_buffer.resize(size);
+		}
+
+		if (_used + size > _buffer.size()) flush();
+		return _buffer.data() + _used;
+	}
+
+	void commit(std::size_t size) {_used += size;}
+
+	void append(const void* data, std::size_t size) {
+		std::memcpy(reserve(size), data, size);
+		commit(size);
+	}
+
+	void append(const std::string& text) {append(text.data(), text.size());}
+
+	// Text of a number, formatted straight into the buffer. Texts longer than the usual
+	// room are formatted again once there is room for them.
+	template <typename S>
+	void appendNumber(S value, unsigned precision) {
+		const std::size_t room = 32;
+		char* out = reserve(room);
+		int count = std::snprintf(out, room, "%.*g", static_cast<int>(precision), static_cast<double>(value));
+		if (count < 0) throw std::runtime_error("Could not format an exported number.");
+
+		std::size_t size = static_cast<std::size_t>(count);
+		if (size >= room) {
+			out = reserve(size + 1);
+			std::snprintf(out, size + 1, "%.*g", static_cast<int>(precision), static_cast<double>(value));
+		}
+
+		commit(size);
+	}
+
+	void closeFile() {
+		flush();
+		if (::close(_file) != 0) throw std::runtime_error("Could not close the export file.");
+		_file = -1;
+	}
+};
+
+
+namespace internal {
+
+template <typename Grid>
+using GridElement = typename std::decay<decltype(std::declval<const Grid&>().dataEvaluation(0,0))>::type;
+
+// Digits beyond max_digits10 carry nothing of the value, so they are never written.
+template <typename S>
+unsigned exportPrecision(unsigned precision) {
+	unsigned exact = std::numeric_limits<S>::max_digits10;
+	return (precision == 0) ? exact : std::min(precision, exact);
+}
+
+template <typename S> const char* vtkTypeName();
+template <> inline const char* vtkTypeName<float>() {return "Float32";}
+template <> inline const char* vtkTypeName<double>() {return "Float64";}
+template <> inline const char* vtkTypeName<std::int32_t>() {return "Int32";}
+template <> inline const char* vtkTypeName<std::uint32_t>() {return "UInt32";}
+template <> inline const char* vtkTypeName<std::int64_t>() {return "Int64";}
+template <> inline const char* vtkTypeName<std::uint64_t>() {return "UInt64";}
+
+inline bool littleEndianHost() {
+	std::uint16_t value = 1;
+	std::uint8_t first;
+	std::memcpy(&first, &value, 1);
+	return first == 1;
+}
+
+inline std::string exportText(double value) {
+	char text[32];
+	std::snprintf(text, sizeof(text), "%.17g", value);
+	return text;
+}
+
+}	// Namespace internal.
+
+
+// Export to VTK XML image data (.vti) with the values in raw binary appended data.
+template <typename Grid>
+void exportVTK(const std::string& path, const Grid& grid, const ExportOptions& options = ExportOptions()) {
+	using E = internal::GridElement<Grid>;
+	using Traits = ExportTraits<E>;
+	using S = typename Traits::scalar;
+	if (options.stride == 0) throw std::invalid_argument("The export stride must be positive.");
+
+	// VTK vectors have 3 components: 2-D vectors are written with a zero z component.
+	const unsigned components = (Traits::components == 1) ? 1 : std::max(Traits::components, 3u);
+
+	unsigned stride = options.stride;
+	unsigned nx = (grid.sizex() + stride - 1) / stride;
+	unsigned ny = (grid.sizey() + stride - 1) / stride;
+	double spacing = static_cast<double>(grid.spacing()) * stride;
+	std::uint64_t bytes = static_cast<std::uint64_t>(nx) * ny * components * sizeof(S);
+
+	BufferedFileWriter writer(path, options.bufferSize);
+	writer.append(std::string("<?xml version=\"1.0\"?>\n")
+		+ "<VTKFile type=\"ImageData\" version=\"1.0\" byte_order=\"" + (internal::littleEndianHost() ? "LittleEndian" : "BigEndian") + "\" header_type=\"UInt64\">\n"
+		+ "  <ImageData WholeExtent=\"0 " + std::to_string(nx-1) + " 0 " + std::to_string(ny-1) + " 0 0\""
+		+ " Origin=\"" + internal::exportText(grid.start().x()) + " " + internal::exportText(grid.start().y()) + " 0\""
+		+ " Spacing=\"" + internal::exportText(spacing) + " " + internal::exportText(spacing) + " " + internal::exportText(spacing) + "\">\n"
+		+ "    <Piece Extent=\"0 " + std::to_string(nx-1) + " 0 " + std::to_string(ny-1) + " 0 0\">\n"
+		+ "      <PointData " + ((Traits::components == 1) ? "Scalars" : "Vectors") + "=\"" + options.name + "\">\n"
+		+ "        <DataArray type=\"" + internal::vtkTypeName<S>() + "\" Name=\"" + options.name + "\" NumberOfComponents=\"" + std::to_string(components) + "\" format=\"appended\" offset=\"0\"/>\n"
+		+ "      </PointData>\n"
+		+ "    </Piece>\n"
+		+ "  </ImageData>\n"
+		+ "  <AppendedData encoding=\"raw\">\n"
+		+ "   _");
+	writer.append(&bytes, sizeof(bytes));
+
+	// Values, x fastest, as VTK expects.
+	for (unsigned j = 0; j < grid.sizey(); j += stride) {
+		for (unsigned i = 0; i < grid.sizex(); i += stride) {
+			const E& value = grid.dataEvaluation(i,j);
+			for (unsigned c = 0; c < components; ++c) {
+				S component = (c < Traits::components) ? Traits::component(value, c) : S(0);
+				writer.append(&component, sizeof(S));
+			}
+		}
+	}
+
+	writer.append(std::string("\n  </AppendedData>\n</VTKFile>\n"));
+	writer.closeFile();
+}
+
+
+// Export to CSV: one line per point with its coordinates and value components.
+template <typename Grid>
+void exportCSV(const std::string& path, const Grid& grid, const ExportOptions& options = ExportOptions()) {
+	using E = internal::GridElement<Grid>;
+	using Traits = ExportTraits<E>;
+	using S = typename Traits::scalar;
+	using T = typename std::decay<decltype(grid.spacing())>::type;
+	if (options.stride == 0) throw std::invalid_argument("The export stride must be positive.");
+
+	unsigned stride = options.stride;
+	unsigned precision = internal::exportPrecision<S>(options.precision);
+	unsigned coordinates = internal::exportPrecision<T>(options.precision);
+
+	BufferedFileWriter writer(path, options.bufferSize);
+	std::string header = "x,y";
+	if (Traits::components == 1) header += "," + options.name;
+	else for (unsigned c = 0; c < Traits::components; ++c) header += "," + options.name + std::to_string(c);
+	writer.append(header + "\n");
+
+	for (unsigned j = 0; j < grid.sizey(); j += stride) {
+		for (unsigned i = 0; i < grid.sizex(); i += stride) {
+			auto point = grid.domainfromij(i,j);
+			writer.appendNumber(point.x(), coordinates);
+			writer.append(",", 1);
+			writer.appendNumber(point.y(), coordinates);
+
+			const E& value = grid.dataEvaluation(i,j);
+			for (unsigned c = 0; c < Traits::components; ++c) {
+				writer.append(",", 1);
+				writer.appendNumber(Traits::component(value, c), precision);
+			}
+
+			writer.append("\n", 1);
+		}
+	}
+
+	writer.closeFile();
+}
+
+}	// Namespace function.
+}	// Namespace math.
@@ -0,0 +1,200 @@
+#pragma once
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <math/function/square_grid.hpp>
+
+namespace math {
+namespace function {
+
+// Lazy element-wise arithmetic on SquareGrid.
+// Operators on grids, expressions and scalars build a tree of lightweight nodes holding
+// references to the grids; nothing is computed until the expression is assigned to a
+// grid, with operator= or assign(). The whole expression is then evaluated in a single
+// loop, with no temporary grid. When every grid of the expression has the layout of the
+// target, the loop runs over the storage directly, which compilers vectorise.
+//
+// Nodes provide sizex() and sizey() when sized, (i,j) evaluation, at(k) evaluation at a
+// storage position, and linear<Layout>(), true when at(k) can be used for that layout.
+
+// Grid in an expression.
+template <typename Grid>
+class GridTerminal : public GridExpression<GridTerminal<Grid>> {
+	const Grid& _grid;
+
+public:
+	using Layout = typename std::decay<decltype(std::declval<const Grid&>().layout())>::type;
+	using const_reference = decltype(std::declval<const Grid&>().dataEvaluation(0,0));
+	using value_type = typename std::decay<const_reference>::type;
+	static const bool sized = true;
+
+	explicit GridTerminal(const Grid& grid) : _grid(grid) {}
+
+	inline unsigned sizex() const {return _grid.sizex();}
+	inline unsigned sizey() const {return _grid.sizey();}
+	inline const_reference operator()(unsigned i, unsigned j) const {return _grid.dataEvaluation(i,j);}
+	inline const_reference at(math::index_t k) const {return _grid.storage()[k];}
+
+	template <typename Target>
+	static constexpr bool linear() {return std::is_same<Target, Layout>::value;}
+};
+
+// Scalar in an expression, the same at every point.
+template <typename S>
+class GridScalar : public GridExpression<GridScalar<S>> {
+	S _value;
+
+public:
+	using value_type = S;
+	static const bool sized = false;
+
+	explicit GridScalar(const S& value) : _value(value) {}
+
+	inline unsigned sizex() const {return 0;}
+	inline unsigned sizey() const {return 0;}
+	inline const S& operator()(unsigned, unsigned) const {return _value;}
+	inline const S& at(math::index_t) const {return _value;}
+
+	template <typename Target>
+	static constexpr bool linear() {return true;}
+};
+
+// Element-wise operation on two operands.
+template <typename Op, typename L, typename R>
+class GridBinary : public GridExpression<GridBinary<Op,L,R>> {
+	static_assert(L::sized or R::sized, "Expressions need at least one grid");
+	L _left;
+	R _right;
+
+public:
+	using value_type = typename std::decay<decltype(Op::apply(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()))>::type;
+	static const bool sized = true;
+
+	GridBinary(const L& left, const R& right) : _left(left), _right(right) {
+		if (L::sized and R::sized and (left.sizex() != right.sizex() or left.sizey() != right.sizey())) {
+			throw std::invalid_argument("Grids of an expression must have the same size.");
+		}
+	}
+
+	inline unsigned sizex() const {return L::sized ? _left.sizex() : _right.sizex();}
+	inline unsigned sizey() const {return L::sized ? _left.sizey() : _right.sizey();}
+	inline value_type operator()(unsigned i, unsigned j) const {return Op::apply(_left(i,j), _right(i,j));}
+	inline value_type at(math::index_t k) const {return Op::apply(_left.at(k), _right.at(k));}
+
+	template <typename Target>
+	static constexpr bool linear() {return L::template linear<Target>() and R::template linear<Target>();}
+};
+
+// Element-wise operation on one operand.
+template <typename Op, typename A>
+class GridUnary : public GridExpression<GridUnary<Op,A>> {
+	A _argument;
+
+public:
+	using value_type = typename std::decay<decltype(Op::apply(std::declval<typename A::value_type>()))>::type;
+	static const bool sized = A::sized;
+
+	explicit GridUnary(const A& argument) : _argument(argument) {}
+
+	inline unsigned sizex() const {return _argument.sizex();}
+	inline unsigned sizey() const {return _argument.sizey();}
+	inline value_type operator()(unsigned i, unsigned j) const {return Op::apply(_argument(i,j));}
+	inline value_type at(math::index_t k) const {return Op::apply(_argument.at(k));}
+
+	template <typename Target>
+	static constexpr bool linear() {return A::template linear<Target>();}
+};
+
+
+// Operations.
+struct GridPlus {
+	template <typename A, typename B>
+	static auto apply(const A& a, const B& b) -> decltype(a + b) {return a + b;}
+};
+
+struct GridMinus {
+	template <typename A, typename B>
+	static auto apply(const A& a, const B& b) -> decltype(a - b) {return a - b;}
+};
+
+struct GridMultiplies {
+	template <typename A, typename B>
+	static auto apply(const A& a, const B& b) -> decltype(a * b) {return a * b;}
+};
+
+struct GridDivides {
+	template <typename A, typename B>
+	static auto apply(const A& a, const B& b) -> decltype(a / b) {return a / b;}
+};
+
+struct GridNegate {
+	template <typename A>
+	static auto apply(const A& a) -> decltype(-a) {return -a;}
+};
+
+
+namespace internal {
+
+// Node of an operand: grids become terminals, expressions stay, anything else is a scalar.
+template <typename X, typename Enable = void>
+struct GridOperand {
+	static const bool grid = false;
+	using type = GridScalar<X>;
+	static type make(const X& value) {return type(value);}
+};
+
+// Grids are SquareGrid or derive from it, like FixedSquareGrid and the solvers.
+template <typename T, typename E, typename Layout, typename Storage>
+std::true_type isSquareGrid(const SquareGrid<T,E,Layout,Storage>*);
+std::false_type isSquareGrid(...);
+
+template <typename X>
+struct GridOperand<X, typename std::enable_if<decltype(isSquareGrid(std::declval<const X*>()))::value>::type> {
+	static const bool grid = true;
+	using type = GridTerminal<X>;
+	static type make(const X& grid) {return type(grid);}
+};
+
+template <typename X>
+struct GridOperand<X, typename std::enable_if<std::is_base_of<GridExpression<X>, X>::value>::type> {
+	static const bool grid = true;
+	using type = X;
+	static const X& make(const X& expression) {return expression;}
+};
+
+template <typename L, typename R>
+using EnableGridOperator = typename std::enable_if<GridOperand<L>::grid or GridOperand<R>::grid>::type;
+
+template <typename Op, typename L, typename R>
+using GridBinaryOf = GridBinary<Op, typename GridOperand<L>::type, typename GridOperand<R>::type>;
+
+}	// Namespace internal.
+
+
+template <typename L, typename R, typename = internal::EnableGridOperator<L,R>>
+internal::GridBinaryOf<GridPlus,L,R> operator+(const L& left, const R& right) {
+	return internal::GridBinaryOf<GridPlus,L,R>(internal::GridOperand<L>::make(left), internal::GridOperand<R>::make(right));
+}
+
+template <typename L, typename R, typename = internal::EnableGridOperator<L,R>>
+internal::GridBinaryOf<GridMinus,L,R> operator-(const L& left, const R& right) {
+	return internal::GridBinaryOf<GridMinus,L,R>(internal::GridOperand<L>::make(left), internal::GridOperand<R>::make(right));
+}
+
+template <typename L, typename R, typename = internal::EnableGridOperator<L,R>>
+internal::GridBinaryOf<GridMultiplies,L,R> operator*(const L& left, const R& right) {
+	return internal::GridBinaryOf<GridMultiplies,L,R>(internal::GridOperand<L>::make(left), internal::GridOperand<R>::make(right));
+}
+
+template <typename L, typename R, typename = internal::EnableGridOperator<L,R>>
+internal::GridBinaryOf<GridDivides,L,R> operator/(const L& left, const R& right) {
+	return internal::GridBinaryOf<GridDivides,L,R>(internal::GridOperand<L>::make(left), internal::GridOperand<R>::make(right));
+}
+
+template <typename A, typename = typename std::enable_if<internal::GridOperand<A>::grid>::type>
+GridUnary<GridNegate, typename internal::GridOperand<A>::type> operator-(const A& argument) {
+	return GridUnary<GridNegate, typename internal::GridOperand<A>::type>(internal::GridOperand<A>::make(argument));
+}
+
+}	// Namespace function.
+}	// Namespace math.
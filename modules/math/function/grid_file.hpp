@@ -0,0 +1,217 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <math/linear/static_vector.hpp>
+#include <math/function/grid_layout.hpp>
+#include <math/function/square_grid.hpp>
+#include <math/function/mapped_storage.hpp>
+
+namespace math {
+namespace function {
+
+// Binary file format for SquareGrid.
+// A fixed size header followed by the raw storage of the grid, as laid out in memory,
+// starting at a 64 byte aligned offset. Saving is a single gathered write. Loading maps
+// the file and points the grid at the payload: nothing is parsed nor copied.
+
+// Scalar type codes of the header.
+enum class GridScalarType : std::uint32_t {
+	Unknown = 0,
+	Int8 = 1, UInt8 = 2, Int16 = 3, UInt16 = 4,
+	Int32 = 5, UInt32 = 6, Int64 = 7, UInt64 = 8,
+	Float32 = 9, Float64 = 10
+};
+
+// Scalar type and number of components of a grid element.
+template <typename E>
+struct GridElementTraits {
+	static const GridScalarType scalar = GridScalarType::Unknown;
+	static const std::uint32_t components = 1;
+};
+
+template <> struct GridElementTraits<std::int8_t> {static const GridScalarType scalar = GridScalarType::Int8; static const std::uint32_t components = 1;};
+template <> struct GridElementTraits<std::uint8_t> {static const GridScalarType scalar = GridScalarType::UInt8; static const std::uint32_t components = 1;};
+template <> struct GridElementTraits<std::int16_t> {static const GridScalarType scalar = GridScalarType::Int16; static const std::uint32_t components = 1;};
+template <> struct GridElementTraits<std::uint16_t> {static const GridScalarType scalar = GridScalarType::UInt16; static const std::uint32_t components = 1;};
+template <> struct GridElementTraits<std::int32_t> {static const GridScalarType scalar = GridScalarType::Int32; static const std::uint32_t components = 1;};
+template <> struct GridElementTraits<std::uint32_t> {static const GridScalarType scalar = GridScalarType::UInt32; static const std::uint32_t components = 1;};
+template <> struct GridElementTraits<std::int64_t> {static const GridScalarType scalar = GridScalarType::Int64; static const std::uint32_t components = 1;};
+template <> struct GridElementTraits<std::uint64_t> {static const GridScalarType scalar = GridScalarType::UInt64; static const std::uint32_t components = 1;};
+template <> struct GridElementTraits<float> {static const GridScalarType scalar = GridScalarType::Float32; static const std::uint32_t components = 1;};
+template <> struct GridElementTraits<double> {static const GridScalarType scalar = GridScalarType::Float64; static const std::uint32_t components = 1;};
+
+// Vector fields, as returned by gradient().
+template <typename S, unsigned D>
+struct GridElementTraits<math::linear::StaticVector<S,D>> {
+	static const GridScalarType scalar = GridElementTraits<S>::scalar;
+	static const std::uint32_t components = D * GridElementTraits<S>::components;
+};
+
+// Parameter of a layout that is not recorded by its id.
+template <typename Layout>
+struct GridLayoutParameter {
+	static const std::uint32_t value = 0;
+};
+
+template <unsigned Tile>
+struct GridLayoutParameter<TiledLayout<Tile>> {
+	static const std::uint32_t value = Tile;
+};
+
+template <unsigned NX, unsigned NY>
+struct GridLayoutParameter<FixedLayout<NX,NY>> {
+	static const std::uint32_t value = NX;
+};
+
+
+// File header. Every field has a fixed width; the whole header is 128 bytes.
+struct GridFileHeader {
+	static const std::uint32_t currentVersion = 1;
+	static const std::uint32_t nativeByteOrder = 0x01020304;
+	static const std::uint64_t payloadAlignment = 64;
+
+	char magic[8];				// "SQGRID\0\0".
+	std::uint32_t version;
+	std::uint32_t byteOrder;	// 0x01020304 as written by the producer.
+	std::uint32_t sizex;
+	std::uint32_t sizey;
+	std::uint32_t scalarType;	// GridScalarType.
+	std::uint32_t components;
+	std::uint32_t elementSize;	// sizeof(E), padding included.
+	std::uint32_t layoutId;
+	std::uint32_t layoutParameter;
+	std::uint32_t reserved;
+	std::uint64_t storageSize;	// Number of stored values, layout padding included.
+	std::uint64_t payloadOffset;
+	double spacing;
+	double startx;
+	double starty;
+	char padding[128 - 88];
+
+	bool littleEndian() const {
+		std::uint8_t first;
+		std::memcpy(&first, &byteOrder, 1);
+		return first == 0x04;
+	}
+};
+
+static_assert(sizeof(GridFileHeader) == 128, "The grid file header must be 128 bytes");
+
+
+// Header describing a grid.
+template <typename T, typename E, typename Layout, typename Storage>
+GridFileHeader makeGridFileHeader(const SquareGrid<T,E,Layout,Storage>& grid) {
+	GridFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "SQGRID\0\0", 8);
+	header.version = GridFileHeader::currentVersion;
+	header.byteOrder = GridFileHeader::nativeByteOrder;
+	header.sizex = grid.sizex();
+	header.sizey = grid.sizey();
+	header.scalarType = static_cast<std::uint32_t>(GridElementTraits<E>::scalar);
+	header.components = GridElementTraits<E>::components;
+	header.elementSize = sizeof(E);
+	header.layoutId = Layout::id;
+	header.layoutParameter = GridLayoutParameter<Layout>::value;
+	header.storageSize = grid.storage().size();
+	header.payloadOffset = ((sizeof(GridFileHeader) + GridFileHeader::payloadAlignment - 1) / GridFileHeader::payloadAlignment) * GridFileHeader::payloadAlignment;
+	header.spacing = static_cast<double>(grid.spacing());
+	header.startx = static_cast<double>(grid.start().x());
+	header.starty = static_cast<double>(grid.start().y());
+	return header;
+}
+
+// Read and check the header of a grid file.
+inline GridFileHeader readGridFileHeader(const std::string& path) {
+	GridFileHeader header;
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) throw std::runtime_error("Could not open the grid file.");
+	ssize_t count = read(file, &header, sizeof(header));
+	close(file);
+
+	if (count != static_cast<ssize_t>(sizeof(header))) throw std::runtime_error("Truncated grid file header.");
+	if (std::memcmp(header.magic, "SQGRID\0\0", 8) != 0) throw std::runtime_error("Not a grid file.");
+	if (header.byteOrder != GridFileHeader::nativeByteOrder) throw std::runtime_error("Grid file written with another byte order.");
+	if (header.version > GridFileHeader::currentVersion) throw std::runtime_error("Grid file version not supported.");
+	return header;
+}
+
+
+// Save a grid: header and payload in one gathered write.
+template <typename T, typename E, typename Layout, typename Storage>
+void saveGrid(const std::string& path, const SquareGrid<T,E,Layout,Storage>& grid) {
+	static_assert(std::is_standard_layout<E>::value, "Saved values must have standard layout");
+	static_assert(GridElementTraits<E>::scalar != GridScalarType::Unknown, "No scalar type code for the grid element");
+
+	GridFileHeader header = makeGridFileHeader(grid);
+	char gap[GridFileHeader::payloadAlignment] = {};
+
+	struct iovec parts[3];
+	parts[0].iov_base = &header;
+	parts[0].iov_len = sizeof(header);
+	parts[1].iov_base = gap;
+	parts[1].iov_len = header.payloadOffset - sizeof(header);
+	parts[2].iov_base = const_cast<E*>(grid.storage().data());
+	parts[2].iov_len = header.storageSize * sizeof(E);
+
+	int file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (file < 0) throw std::runtime_error("Could not create the grid file.");
+
+	// A single writev, unless the system splits very large payloads.
+	std::size_t total = parts[0].iov_len + parts[1].iov_len + parts[2].iov_len;
+	std::size_t written = 0;
+	unsigned first = 0;
+	while (written < total) {
+		ssize_t count = writev(file, parts + first, 3 - first);
+		if (count <= 0) {
+			close(file);
+			throw std::runtime_error("Could not write the grid file.");
+		}
+
+		written += count;
+		std::size_t advance = count;
+		while (first < 3  and  advance >= parts[first].iov_len) {
+			advance -= parts[first].iov_len;
+			++first;
+		}
+
+		if (first < 3) {
+			parts[first].iov_base = static_cast<char*>(parts[first].iov_base) + advance;
+			parts[first].iov_len -= advance;
+		}
+	}
+
+	close(file);
+}
+
+
+// Load a grid by mapping the file. The header must match T, E and Layout exactly.
+// CopyOnWrite keeps the file untouched; Open writes changes back to it.
+template <typename T, typename E, typename Layout = RowMajorLayout>
+SquareGrid<T,E,Layout,MappedStorage<E>> loadGrid(const std::string& path, MappingMode mode = MappingMode::CopyOnWrite) {
+	if (mode == MappingMode::Create) throw std::invalid_argument("Grid files are loaded from existing files.");
+	GridFileHeader header = readGridFileHeader(path);
+
+	if (header.scalarType != static_cast<std::uint32_t>(GridElementTraits<E>::scalar)) throw std::runtime_error("Grid file holds another element type.");
+	if (header.components != GridElementTraits<E>::components) throw std::runtime_error("Grid file holds another element type.");
+	if (header.elementSize != sizeof(E)) throw std::runtime_error("Grid file holds another element type.");
+	if (header.layoutId != Layout::id) throw std::runtime_error("Grid file holds another layout.");
+	if (header.layoutParameter != GridLayoutParameter<Layout>::value) throw std::runtime_error("Grid file holds another layout.");
+	if (header.payloadOffset % alignof(E) != 0) throw std::runtime_error("Misaligned grid file payload.");
+
+	Layout layout(header.sizex, header.sizey);
+	if (header.storageSize != layout.size()) throw std::runtime_error("Grid file payload does not match its sizes.");
+
+	MappedStorage<E> storage(path, static_cast<math::index_t>(header.storageSize), mode, header.payloadOffset);
+	math::linear::StaticVector<T,2> start({static_cast<T>(header.startx), static_cast<T>(header.starty)});
+	return SquareGrid<T,E,Layout,MappedStorage<E>>(header.sizex, header.sizey, static_cast<T>(header.spacing), start, std::move(storage));
+}
+
+}	// Namespace function.
+}	// Namespace math.
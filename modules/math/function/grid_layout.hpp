@@ -0,0 +1,120 @@
+#pragma once
+#include <stdexcept>
+#include <math/index.hpp>
+
+namespace math {
+namespace function {
+
+// Layout policies for SquareGrid.
+// A layout maps the (i,j) grid coordinates to the position of the value in memory.
+// It is constructed from the grid size, and provides:
+//   index(i, j): position of the value of (i,j), as a math::index_t.
+//   size(): number of stored values, including any padding, as a math::index_t.
+//   id: tag identifying the layout, used by file formats.
+
+// Rows stored one after the other. Best for sweeps along x.
+class RowMajorLayout {
+	unsigned _sizex;
+	unsigned _sizey;
+
+public:
+	static const unsigned id = 0;
+
+	RowMajorLayout(unsigned sizex, unsigned sizey) : _sizex(sizex), _sizey(sizey) {}
+
+	inline math::index_t index(unsigned i, unsigned j) const {return static_cast<math::index_t>(j) * _sizex + i;}
+	inline math::index_t size() const {return static_cast<math::index_t>(_sizex) * _sizey;}
+};
+
+
+// Square tiles of Tile x Tile values stored contiguously, tiles in row-major order.
+// Stencils and 2D neighbourhoods touch few cache lines. The grid is padded to whole tiles.
+template <unsigned Tile = 8>
+class TiledLayout {
+	static_assert(Tile > 0, "Tiles must have at least one value");
+	unsigned _tilesx;
+	unsigned _tilesy;
+
+public:
+	static const unsigned id = 1;
+	static const unsigned tile = Tile;
+
+	TiledLayout(unsigned sizex, unsigned sizey) : _tilesx((sizex + Tile - 1) / Tile), _tilesy((sizey + Tile - 1) / Tile) {}
+
+	inline math::index_t index(unsigned i, unsigned j) const {
+		math::index_t tileindex = static_cast<math::index_t>(j / Tile) * _tilesx + (i / Tile);
+		return tileindex * (Tile * Tile) + (j % Tile) * Tile + (i % Tile);
+	}
+
+	inline math::index_t size() const {return static_cast<math::index_t>(_tilesx) * _tilesy * (Tile * Tile);}
+	inline unsigned tilesx() const {return _tilesx;}
+	inline unsigned tilesy() const {return _tilesy;}
+};
+
+
+// Z-order (Morton) curve. Bits of i and j are interleaved, so values close in both
+// directions are close in memory at every scale. Each direction is padded to a power of
+// two; the extra bits of the longest direction are placed above the interleaved ones.
+class MortonLayout {
+	unsigned _bits;
+	unsigned _bitsx;
+	unsigned _bitsy;
+
+	static unsigned bitsFor(unsigned size) {
+		unsigned bits = 0;
+		while ((1ull << bits) < size) ++bits;
+		return bits;
+	}
+
+	// Spread the lower 32 bits of value, leaving a zero between each of them.
+	static unsigned long long spread(unsigned long long value) {
+		value &= 0x00000000ffffffffull;
+		value = (value | (value << 16)) & 0x0000ffff0000ffffull;
+		value = (value | (value << 8)) & 0x00ff00ff00ff00ffull;
+		value = (value | (value << 4)) & 0x0f0f0f0f0f0f0f0full;
+		value = (value | (value << 2)) & 0x3333333333333333ull;
+		value = (value | (value << 1)) & 0x5555555555555555ull;
+		return value;
+	}
+
+public:
+	static const unsigned id = 2;
+
+	MortonLayout(unsigned sizex, unsigned sizey) : _bitsx(bitsFor(sizex)), _bitsy(bitsFor(sizey)) {
+		_bits = (_bitsx < _bitsy) ? _bitsx : _bitsy;
+	}
+
+	inline math::index_t index(unsigned i, unsigned j) const {
+		unsigned long long mask = (1ull << _bits) - 1;
+		unsigned long long interleaved = spread(i & mask) | (spread(j & mask) << 1);
+		unsigned long long high = (static_cast<unsigned long long>(i) >> _bits) | (static_cast<unsigned long long>(j) >> _bits);
+		return static_cast<math::index_t>(interleaved | (high << (2 * _bits)));
+	}
+
+	inline math::index_t size() const {return static_cast<math::index_t>(1ull << (_bitsx + _bitsy));}
+};
+
+
+// Rows of NX values, for grids of at most NX x NY points known at compile time.
+// The index math is constant, and the size is always NX * NY, so fixed size storages fit
+// the grid and the smaller grids derived from it.
+template <unsigned NX, unsigned NY>
+class FixedLayout {
+	static_assert(NX > 0 and NY > 0, "Fixed layouts must have at least one value");
+
+public:
+	static const unsigned id = 3;
+
+	FixedLayout(unsigned sizex, unsigned sizey);
+
+	static constexpr math::index_t index(unsigned i, unsigned j) {return static_cast<math::index_t>(j) * NX + i;}
+	static constexpr math::index_t size() {return static_cast<math::index_t>(NX) * NY;}
+};
+
+template <unsigned NX, unsigned NY>
+FixedLayout<NX,NY>::FixedLayout(unsigned sizex, unsigned sizey) {
+	if (sizex > NX or sizey > NY) throw std::invalid_argument("Grid larger than its fixed layout.");
+}
+
+}	// Namespace function.
+}	// Namespace math.
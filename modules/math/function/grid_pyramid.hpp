@@ -0,0 +1,316 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <math/linear/static_vector.hpp>
+#include <math/function/square_grid.hpp>
+
+namespace math {
+namespace function {
+
+// Multi-resolution pyramid over a scalar grid.
+// Level 0 is the source grid itself, never copied. Every level above halves the
+// resolution: a grid of n points becomes n/2+1 points of twice the spacing, with the
+// same start, so it covers the whole source domain. Values are full-weighting averages
+// of the level below. Every cell of every level also keeps the minimum and maximum of
+// the source data under it, which bound the bilinear interpolant: conservative culling.
+//
+// Levels are built lazily, on the first query that needs them. After changing the
+// source, call invalidate() on the changed points: the next query only recomputes the
+// affected parts of each level. Queries update internal caches, so a pyramid must not
+// be shared between threads.
+template <typename Grid>
+class GridPyramid {
+public:
+	using T = typename std::decay<decltype(std::declval<const Grid&>().spacing())>::type;
+	using E = typename std::decay<decltype(std::declval<const Grid&>().dataEvaluation(0,0))>::type;
+
+private:
+	// Inclusive rectangle of points or cells.
+	struct Region {
+		unsigned i0, j0, i1, j1;
+		bool empty;
+
+		Region() : i0(0), j0(0), i1(0), j1(0), empty(true) {}
+		Region(unsigned a0, unsigned b0, unsigned a1, unsigned b1) : i0(a0), j0(b0), i1(a1), j1(b1), empty(false) {}
+
+		void merge(const Region& other) {
+			if (other.empty) return;
+			if (empty) {
+				*this = other;
+				return;
+			}
+
+			i0 = std::min(i0, other.i0);
+			j0 = std::min(j0, other.j0);
+			i1 = std::max(i1, other.i1);
+			j1 = std::max(j1, other.j1);
+		}
+	};
+
+	struct Level {
+		unsigned sizex, sizey;
+		std::vector<SquareGrid<T,E>> values;	// Empty at level 0, which is the source.
+		std::vector<E> minimum;
+		std::vector<E> maximum;
+		Region dirtypoints;
+		Region dirtycells;
+
+		inline unsigned cellsx() const {return sizex-1;}
+		inline unsigned cellsy() const {return sizey-1;}
+	};
+
+	const Grid& _source;
+	mutable std::vector<Level> _levels;
+
+	E value(unsigned level, unsigned i, unsigned j) const;
+	void refresh(unsigned level) const;
+	void checkLevel(unsigned level) const;
+
+public:
+	explicit GridPyramid(const Grid& source);
+
+	// Number of levels, level 0 included.
+	inline unsigned levels() const {return _levels.size();}
+	inline unsigned sizex(unsigned level) const {checkLevel(level); return _levels[level].sizex;}
+	inline unsigned sizey(unsigned level) const {checkLevel(level); return _levels[level].sizey;}
+	inline T spacing(unsigned level) const {checkLevel(level); return _source.spacing() * static_cast<T>(1u << level);}
+
+	// Grid of a level above 0.
+	const SquareGrid<T,E>& level(unsigned level) const;
+
+	// Value at a grid point, and bilinear interpolation, of a level.
+	E dataEvaluation(unsigned i, unsigned j, unsigned level) const;
+	E evaluate(const math::linear::StaticVector<T,2>& coord, unsigned level) const;
+	E evaluate(const T& x, const T& y, unsigned level) const;
+
+	// Bounds of the source data under the cell (i,j) of a level.
+	E minimum(unsigned i, unsigned j, unsigned level) const;
+	E maximum(unsigned i, unsigned j, unsigned level) const;
+
+	// Bounds of the source data under the cell of a level containing coord.
+	void bounds(const math::linear::StaticVector<T,2>& coord, unsigned level, E& minimum, E& maximum) const;
+
+	// Mark the source points [i0, i0+nx) x [j0, j0+ny) as changed.
+	void invalidate(unsigned i0, unsigned j0, unsigned nx, unsigned ny);
+	void invalidate();
+};
+
+
+template <typename Grid>
+GridPyramid<Grid>::GridPyramid(const Grid& source) : _source(source) {
+	if (source.sizex() < 2 or source.sizey() < 2) throw std::invalid_argument("Pyramids need at least 2x2 grid points.");
+
+	unsigned sx = source.sizex();
+	unsigned sy = source.sizey();
+	math::linear::StaticVector<T,2> start = source.start();
+	T spacing = source.spacing();
+
+	for (;;) {
+		Level level;
+		level.sizex = sx;
+		level.sizey = sy;
+		if (not _levels.empty()) level.values.emplace_back(sx, sy, spacing, start);
+		level.minimum.resize(static_cast<std::size_t>(sx-1) * (sy-1));
+		level.maximum.resize(static_cast<std::size_t>(sx-1) * (sy-1));
+		_levels.push_back(std::move(level));
+
+		if (sx <= 2 and sy <= 2) break;
+		sx = (sx > 2) ? sx/2 + 1 : sx;
+		sy = (sy > 2) ? sy/2 + 1 : sy;
+		spacing *= T(2.0);
+	}
+
+	invalidate();
+}
+
+template <typename Grid>
+void GridPyramid<Grid>::checkLevel(unsigned level) const {
+	if (level >= _levels.size()) throw std::invalid_argument("Pyramid level does not exist.");
+}
+
+template <typename Grid>
+void GridPyramid<Grid>::invalidate(unsigned i0, unsigned j0, unsigned nx, unsigned ny) {
+	if (nx == 0 or ny == 0) return;
+	Region points(i0, j0, std::min(i0 + nx, _levels[0].sizex) - 1, std::min(j0 + ny, _levels[0].sizey) - 1);
+
+	// Cells touching the changed points.
+	Region cells(
+		(points.i0 > 0) ? points.i0 - 1 : 0, (points.j0 > 0) ? points.j0 - 1 : 0,
+		std::min(points.i1, _levels[0].cellsx() - 1), std::min(points.j1, _levels[0].cellsy() - 1)
+	);
+
+	_levels[0].dirtycells.merge(cells);
+	for (unsigned l = 1; l < _levels.size(); ++l) {
+		const Level& coarse = _levels[l];
+
+		// Coarse point k averages the fine points 2k-1 to 2k+1.
+		points = Region(
+			points.i0 / 2, points.j0 / 2,
+			std::min((points.i1 + 1) / 2, coarse.sizex - 1), std::min((points.j1 + 1) / 2, coarse.sizey - 1)
+		);
+
+		// Coarse cell k covers the fine cells 2k and 2k+1.
+		cells = Region(
+			std::min(cells.i0 / 2, coarse.cellsx() - 1), std::min(cells.j0 / 2, coarse.cellsy() - 1),
+			std::min(cells.i1 / 2, coarse.cellsx() - 1), std::min(cells.j1 / 2, coarse.cellsy() - 1)
+		);
+
+		_levels[l].dirtypoints.merge(points);
+		_levels[l].dirtycells.merge(cells);
+	}
+}
+
+template <typename Grid>
+void GridPyramid<Grid>::invalidate() {
+	invalidate(0, 0, _levels[0].sizex, _levels[0].sizey);
+}
+
+template <typename Grid>
+typename GridPyramid<Grid>::E GridPyramid<Grid>::value(unsigned level, unsigned i, unsigned j) const {
+	if (level == 0) return _source.dataEvaluation(i,j);
+	return _levels[level].values.front().dataEvaluation(i,j);
+}
+
+template <typename Grid>
+void GridPyramid<Grid>::refresh(unsigned level) const {
+	checkLevel(level);
+
+	// Cell bounds of the source.
+	Level& base = _levels[0];
+	if (not base.dirtycells.empty) {
+		const Region& region = base.dirtycells;
+		for (unsigned j = region.j0; j <= region.j1; ++j) {
+			for (unsigned i = region.i0; i <= region.i1; ++i) {
+				E a = _source.dataEvaluation(i,j), b = _source.dataEvaluation(i+1,j);
+				E c = _source.dataEvaluation(i,j+1), d = _source.dataEvaluation(i+1,j+1);
+				std::size_t k = static_cast<std::size_t>(j) * base.cellsx() + i;
+				base.minimum[k] = std::min(std::min(a, b), std::min(c, d));
+				base.maximum[k] = std::max(std::max(a, b), std::max(c, d));
+			}
+		}
+
+		base.dirtycells = Region();
+	}
+
+	for (unsigned l = 1; l <= level; ++l) {
+		Level& fine = _levels[l-1];
+		Level& coarse = _levels[l];
+
+		// Full-weighting average of the fine points, replicated at the edges.
+		if (not coarse.dirtypoints.empty) {
+			const Region& region = coarse.dirtypoints;
+			SquareGrid<T,E>& values = coarse.values.front();
+			static const T weights[3] = {T(0.25), T(0.5), T(0.25)};
+			for (unsigned j = region.j0; j <= region.j1; ++j) {
+				for (unsigned i = region.i0; i <= region.i1; ++i) {
+					E sum = E();
+					for (unsigned b = 0; b < 3; ++b) {
+						unsigned fj = static_cast<unsigned>(std::min(std::max(static_cast<int>(2*j + b) - 1, 0), static_cast<int>(fine.sizey) - 1));
+						for (unsigned a = 0; a < 3; ++a) {
+							unsigned fi = static_cast<unsigned>(std::min(std::max(static_cast<int>(2*i + a) - 1, 0), static_cast<int>(fine.sizex) - 1));
+							sum += value(l-1, fi, fj) * (weights[a] * weights[b]);
+						}
+					}
+
+					values.dataEvaluation(i,j) = sum;
+				}
+			}
+
+			coarse.dirtypoints = Region();
+		}
+
+		// Bounds of the fine cells under each coarse cell.
+		if (not coarse.dirtycells.empty) {
+			const Region& region = coarse.dirtycells;
+			for (unsigned j = region.j0; j <= region.j1; ++j) {
+				for (unsigned i = region.i0; i <= region.i1; ++i) {
+					std::size_t k = static_cast<std::size_t>(j) * coarse.cellsx() + i;
+					unsigned fi0 = std::min(2*i, fine.cellsx() - 1), fi1 = std::min(2*i + 1, fine.cellsx() - 1);
+					unsigned fj0 = std::min(2*j, fine.cellsy() - 1), fj1 = std::min(2*j + 1, fine.cellsy() - 1);
+
+					std::size_t first = static_cast<std::size_t>(fj0) * fine.cellsx() + fi0;
+					E lower = fine.minimum[first];
+					E upper = fine.maximum[first];
+					for (unsigned fj = fj0; fj <= fj1; ++fj) {
+						for (unsigned fi = fi0; fi <= fi1; ++fi) {
+							std::size_t f = static_cast<std::size_t>(fj) * fine.cellsx() + fi;
+							lower = std::min(lower, fine.minimum[f]);
+							upper = std::max(upper, fine.maximum[f]);
+						}
+					}
+
+					coarse.minimum[k] = lower;
+					coarse.maximum[k] = upper;
+				}
+			}
+
+			coarse.dirtycells = Region();
+		}
+	}
+}
+
+template <typename Grid>
+const SquareGrid<typename GridPyramid<Grid>::T, typename GridPyramid<Grid>::E>& GridPyramid<Grid>::level(unsigned level) const {
+	if (level == 0) throw std::invalid_argument("Level 0 is the source grid.");
+	refresh(level);
+	return _levels[level].values.front();
+}
+
+template <typename Grid>
+typename GridPyramid<Grid>::E GridPyramid<Grid>::dataEvaluation(unsigned i, unsigned j, unsigned level) const {
+	refresh(level);
+	return value(level, i, j);
+}
+
+template <typename Grid>
+typename GridPyramid<Grid>::E GridPyramid<Grid>::evaluate(const math::linear::StaticVector<T,2>& coord, unsigned level) const {
+	if (level == 0) return _source.evaluate(coord);
+	refresh(level);
+	return _levels[level].values.front().evaluate(coord);
+}
+
+template <typename Grid>
+typename GridPyramid<Grid>::E GridPyramid<Grid>::evaluate(const T& x, const T& y, unsigned level) const {
+	return evaluate(math::linear::StaticVector<T,2>({x, y}), level);
+}
+
+template <typename Grid>
+typename GridPyramid<Grid>::E GridPyramid<Grid>::minimum(unsigned i, unsigned j, unsigned level) const {
+	refresh(level);
+	const Level& data = _levels[level];
+	if (i >= data.cellsx() or j >= data.cellsy()) throw std::invalid_argument("Outside of the cells of the level.");
+	return data.minimum[static_cast<std::size_t>(j) * data.cellsx() + i];
+}
+
+template <typename Grid>
+typename GridPyramid<Grid>::E GridPyramid<Grid>::maximum(unsigned i, unsigned j, unsigned level) const {
+	refresh(level);
+	const Level& data = _levels[level];
+	if (i >= data.cellsx() or j >= data.cellsy()) throw std::invalid_argument("Outside of the cells of the level.");
+	return data.maximum[static_cast<std::size_t>(j) * data.cellsx() + i];
+}
+
+template <typename Grid>
+void GridPyramid<Grid>::bounds(const math::linear::StaticVector<T,2>& coord, unsigned level, E& lower, E& upper) const {
+	checkLevel(level);
+	const Level& data = _levels[level];
+	T step = spacing(level);
+	T x = (coord.x() - _source.start().x()) / step;
+	T y = (coord.y() - _source.start().y()) / step;
+	if (x < T(0.0) or y < T(0.0)) throw std::invalid_argument("Outside of domain of the function.");
+
+	unsigned i = static_cast<unsigned>(std::floor(x));
+	unsigned j = static_cast<unsigned>(std::floor(y));
+	if (i > data.cellsx() or j > data.cellsy()) throw std::invalid_argument("Outside of domain of the function.");
+	i = std::min(i, data.cellsx() - 1);
+	j = std::min(j, data.cellsy() - 1);
+
+	lower = minimum(i, j, level);
+	upper = maximum(i, j, level);
+}
+
+}	// Namespace function.
+}	// Namespace math.
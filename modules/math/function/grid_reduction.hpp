@@ -0,0 +1,418 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <math/index.hpp>
+#include <math/function/grid_storage.hpp>
+#include <math/parallel/parallel_for.hpp>
+
+namespace math {
+namespace solver {
+template <typename T> class FiniteElement;
+}	// Namespace solver.
+}	// Namespace math.
+
+namespace math {
+namespace function {
+
+// Parallel reductions over the values of a grid, or of a sub-rectangle, optionally masked.
+// The selected points are split in chunks fixed by the region alone. Each chunk is reduced
+// with a few independent accumulators, then chunks are merged pairwise in a fixed tree.
+// Threads only share out the chunks, so results are bit for bit the same for any number
+// of threads. Any grid with sizex, sizey and dataEvaluation works; FDM values are used
+// through value(). Unmasked rows of plain values that are contiguous in memory are reduced
+// straight from memory, in fixed-size lanes that compilers vectorise.
+
+// Sub-rectangle [i0, i0+nx) x [j0, j0+ny), clipped to the grid. The whole grid by default.
+struct GridRegion {
+	unsigned i0 = 0;
+	unsigned j0 = 0;
+	unsigned nx = std::numeric_limits<unsigned>::max();
+	unsigned ny = std::numeric_limits<unsigned>::max();
+
+	GridRegion() {}
+	GridRegion(unsigned i0, unsigned j0, unsigned nx, unsigned ny) : i0(i0), j0(j0), nx(nx), ny(ny) {}
+};
+
+// Masks select points by their (i,j) coordinates.
+struct AllPoints {
+	inline bool operator()(unsigned, unsigned) const {return true;}
+};
+
+// Points of a solver grid that are frozen, or that are not.
+template <typename Grid>
+class FrozenMask {
+	const Grid& _grid;
+	bool _frozen;
+
+public:
+	FrozenMask(const Grid& grid, bool frozen) : _grid(grid), _frozen(frozen) {}
+	inline bool operator()(unsigned i, unsigned j) const {return _grid.dataEvaluation(i,j).frozen() == _frozen;}
+};
+
+template <typename Grid>
+FrozenMask<Grid> frozenMask(const Grid& grid, bool frozen = true) {
+	return FrozenMask<Grid>(grid, frozen);
+}
+
+// Count, bounds and sums of the selected values.
+template <typename S>
+struct GridStatistics {
+	std::size_t count = 0;
+	S minimum = std::numeric_limits<S>::max();
+	S maximum = std::numeric_limits<S>::lowest();
+	S sum = S();
+	S sumSquares = S();
+
+	inline S mean() const {return (count > 0) ? sum / static_cast<S>(count) : S();}
+	inline S norm() const {return std::sqrt(sumSquares);}
+
+	void add(const S& value, unsigned, unsigned) {
+		++count;
+		minimum = std::min(minimum, value);
+		maximum = std::max(maximum, value);
+		sum += value;
+		sumSquares += value * value;
+	}
+
+	// Values of the points (i,j) ... (i+size-1,j), in lanes of independent partial results.
+	void addRow(const S* values, unsigned size, unsigned, unsigned) {
+		static const unsigned lanes = 32;
+		S low[lanes], high[lanes], total[lanes], squares[lanes];
+		for (unsigned l = 0; l < lanes; ++l) {
+			low[l] = std::numeric_limits<S>::max();
+			high[l] = std::numeric_limits<S>::lowest();
+			total[l] = S();
+			squares[l] = S();
+		}
+
+		unsigned k = 0;
+		for (; k + lanes <= size; k += lanes) {
+			for (unsigned l = 0; l < lanes; ++l) {
+				S value = values[k + l];
+				low[l] = (value < low[l]) ? value : low[l];
+				high[l] = (high[l] < value) ? value : high[l];
+				total[l] += value;
+				squares[l] += value * value;
+			}
+		}
+
+		for (unsigned l = 0; l < size - k; ++l) {
+			S value = values[k + l];
+			low[l] = std::min(low[l], value);
+			high[l] = std::max(high[l], value);
+			total[l] += value;
+			squares[l] += value * value;
+		}
+
+		count += size;
+		for (unsigned l = 0; l < lanes; ++l) {
+			minimum = std::min(minimum, low[l]);
+			maximum = std::max(maximum, high[l]);
+			sum += total[l];
+			sumSquares += squares[l];
+		}
+	}
+
+	void merge(const GridStatistics& other) {
+		count += other.count;
+		minimum = std::min(minimum, other.minimum);
+		maximum = std::max(maximum, other.maximum);
+		sum += other.sum;
+		sumSquares += other.sumSquares;
+	}
+};
+
+// Extreme value and its position. Ties go to the first point, rows from the bottom.
+template <typename S>
+struct GridExtremum {
+	bool found = false;
+	S value = S();
+	unsigned i = 0;
+	unsigned j = 0;
+};
+
+
+namespace internal {
+
+template <typename S>
+inline const S& reductionValue(const S& value) {return value;}
+
+template <typename S>
+inline const S& reductionValue(const math::solver::FiniteElement<S>& value) {return value.value();}
+
+template <typename Grid>
+using ReductionScalar = typename std::decay<decltype(reductionValue(std::declval<const Grid&>().dataEvaluation(0,0)))>::type;
+
+template <typename S, bool Greater>
+struct ExtremumAccumulator {
+	GridExtremum<S> result;
+
+	// Better value, or same value earlier in the region, so merge order does not matter.
+	bool better(const S& value, unsigned i, unsigned j) const {
+		if (not result.found) return true;
+		if (Greater ? value > result.value : value < result.value) return true;
+		if (value != result.value) return false;
+		return (j < result.j) or (j == result.j and i < result.i);
+	}
+
+	void add(const S& value, unsigned i, unsigned j) {
+		if (not better(value, i, j)) return;
+		result.found = true;
+		result.value = value;
+		result.i = i;
+		result.j = j;
+	}
+
+	// Values of the points (i,j) ... (i+size-1,j). Each lane keeps its first best value and
+	// the offset of its group, selected with masks, then lanes merge with the usual ties.
+	void addRow(const S* values, unsigned size, unsigned i, unsigned j) {
+		static const unsigned lanes = 32;
+		unsigned k = 0;
+		if (size >= lanes) {
+			S best[lanes];
+			unsigned group[lanes];
+			for (unsigned l = 0; l < lanes; ++l) {
+				best[l] = values[l];
+				group[l] = 0;
+			}
+
+			for (k = lanes; k + lanes <= size; k += lanes) {
+				for (unsigned l = 0; l < lanes; ++l) {
+					S value = values[k + l];
+					S old = best[l];
+					bool take = Greater ? (old < value) : (value < old);
+					unsigned mask = 0u - static_cast<unsigned>(take);
+					best[l] = take ? value : old;
+					group[l] = (k & mask) | (group[l] & ~mask);
+				}
+			}
+
+			for (unsigned l = 0; l < lanes; ++l) add(best[l], i + group[l] + l, j);
+		}
+
+		for (; k < size; ++k) add(values[k], i + k, j);
+	}
+
+	void merge(const ExtremumAccumulator& other) {
+		if (other.result.found) add(other.result.value, other.result.i, other.result.j);
+	}
+};
+
+template <typename S>
+struct HistogramAccumulator {
+	std::vector<std::size_t> counts;
+	S lower;
+	S scale;
+
+	HistogramAccumulator(unsigned bins, S lower, S upper) : counts(bins, 0), lower(lower), scale(static_cast<S>(bins) / (upper - lower)) {}
+
+	void add(const S& value, unsigned, unsigned) {
+		S position = (value - lower) * scale;
+		if (not (position >= S(0))) return;
+		std::size_t bin = static_cast<std::size_t>(position);
+		if (bin >= counts.size()) {
+			// The upper bound itself goes in the last bin.
+			if (position > static_cast<S>(counts.size())) return;
+			bin = counts.size() - 1;
+		}
+
+		++counts[bin];
+	}
+
+	// Counts are exact, so rows need no lanes.
+	void addRow(const S* values, unsigned size, unsigned, unsigned) {
+		for (unsigned k = 0; k < size; ++k) add(values[k], 0, 0);
+	}
+
+	void merge(const HistogramAccumulator& other) {
+		for (std::size_t b = 0; b < counts.size(); ++b) counts[b] += other.counts[b];
+	}
+};
+
+// Values of the points [i0, i0+nx) of row j when they are contiguous in memory, or null.
+// Only grids over storages of plain values held in a single block qualify, such as
+// std::vector; sparse and compact storages do not. Layouts store the values of a row in
+// increasing order, so the indexes of the end points tell whether the row is contiguous.
+template <typename Grid>
+auto denseRow(const Grid& grid, unsigned i0, unsigned nx, unsigned j, int)
+-> decltype(static_cast<const ReductionScalar<Grid>*>(grid.storage().data()) + grid.datafromij(i0, j)) {
+	const auto& storage = grid.storage();
+	if (storageBlockSize(storage) < static_cast<math::index_t>(storage.size())) return nullptr;
+
+	math::index_t first = grid.datafromij(i0, j);
+	math::index_t last = grid.datafromij(i0 + nx - 1, j);
+	if (last != first + (nx - 1)) return nullptr;
+	return static_cast<const ReductionScalar<Grid>*>(storage.data()) + first;
+}
+
+template <typename Grid>
+const ReductionScalar<Grid>* denseRow(const Grid&, unsigned, unsigned, unsigned, long) {
+	return nullptr;
+}
+
+template <typename Grid, typename Mask>
+const ReductionScalar<Grid>* maskedRow(const Grid&, unsigned, unsigned, unsigned, const Mask&) {
+	return nullptr;
+}
+
+template <typename Grid>
+const ReductionScalar<Grid>* maskedRow(const Grid& grid, unsigned i0, unsigned nx, unsigned j, const AllPoints&) {
+	return denseRow(grid, i0, nx, j, 0);
+}
+
+// Reduce the selected points with copies of identity.
+template <typename Grid, typename Mask, typename Accumulator>
+Accumulator reduceGrid(const Grid& grid, const GridRegion& region, const Mask& mask, unsigned threads, const Accumulator& identity) {
+	static const unsigned lanes = 4;
+	static const unsigned chunkPoints = 4096;
+
+	if (region.i0 >= grid.sizex() or region.j0 >= grid.sizey()) throw std::invalid_argument("Region outside of the grid.");
+	unsigned i0 = region.i0, j0 = region.j0;
+	unsigned nx = std::min(region.nx, grid.sizex() - i0);
+	unsigned ny = std::min(region.ny, grid.sizey() - j0);
+
+	// Chunks of whole rows, fixed by the region.
+	unsigned rows = std::max(1u, chunkPoints / std::max(nx, 1u));
+	unsigned chunks = (ny + rows - 1) / rows;
+	std::vector<Accumulator> partials(chunks, identity);
+
+	math::parallel::parallelFor(0, chunks, threads, [&](unsigned first, unsigned last) {
+		std::vector<Accumulator> accumulators(lanes, identity);
+		for (unsigned c = first; c < last; ++c) {
+			std::fill(accumulators.begin(), accumulators.end(), identity);
+			unsigned jend = std::min(j0 + (c+1) * rows, j0 + ny);
+			for (unsigned j = j0 + c * rows; j < jend; ++j) {
+				// Only unmasked rows can be read straight from memory.
+				const ReductionScalar<Grid>* row = maskedRow(grid, i0, nx, j, mask);
+				if (row != nullptr) {
+					accumulators[0].addRow(row, nx, i0, j);
+					continue;
+				}
+
+				for (unsigned k = 0; k < nx; ++k) {
+					unsigned i = i0 + k;
+					if (mask(i,j)) accumulators[k % lanes].add(reductionValue(grid.dataEvaluation(i,j)), i, j);
+				}
+			}
+
+			partials[c] = accumulators[0];
+			for (unsigned l = 1; l < lanes; ++l) partials[c].merge(accumulators[l]);
+		}
+	});
+
+	// Pairwise tree over the chunks.
+	for (unsigned width = 1; width < chunks; width *= 2) {
+		for (unsigned c = 0; c + width < chunks; c += 2 * width) partials[c].merge(partials[c + width]);
+	}
+
+	return chunks > 0 ? partials[0] : identity;
+}
+
+template <typename T>
+using EnableMask = typename std::enable_if<not std::is_arithmetic<T>::value>::type;
+
+}	// Namespace internal.
+
+
+// Count, bounds, sum and sum of squares of the selected values, in one pass.
+template <typename Grid, typename Mask, typename = internal::EnableMask<Mask>>
+GridStatistics<internal::ReductionScalar<Grid>> statistics(const Grid& grid, const GridRegion& region, const Mask& mask, unsigned threads = 1) {
+	return internal::reduceGrid(grid, region, mask, threads, GridStatistics<internal::ReductionScalar<Grid>>());
+}
+
+template <typename Grid>
+GridStatistics<internal::ReductionScalar<Grid>> statistics(const Grid& grid, const GridRegion& region = GridRegion(), unsigned threads = 1) {
+	return statistics(grid, region, AllPoints(), threads);
+}
+
+// Bounds of the selected values. Throws if no point is selected.
+template <typename Grid, typename Mask, typename = internal::EnableMask<Mask>>
+internal::ReductionScalar<Grid> minimum(const Grid& grid, const GridRegion& region, const Mask& mask, unsigned threads = 1) {
+	auto result = statistics(grid, region, mask, threads);
+	if (result.count == 0) throw std::invalid_argument("No points selected.");
+	return result.minimum;
+}
+
+template <typename Grid>
+internal::ReductionScalar<Grid> minimum(const Grid& grid, const GridRegion& region = GridRegion(), unsigned threads = 1) {
+	return minimum(grid, region, AllPoints(), threads);
+}
+
+template <typename Grid, typename Mask, typename = internal::EnableMask<Mask>>
+internal::ReductionScalar<Grid> maximum(const Grid& grid, const GridRegion& region, const Mask& mask, unsigned threads = 1) {
+	auto result = statistics(grid, region, mask, threads);
+	if (result.count == 0) throw std::invalid_argument("No points selected.");
+	return result.maximum;
+}
+
+template <typename Grid>
+internal::ReductionScalar<Grid> maximum(const Grid& grid, const GridRegion& region = GridRegion(), unsigned threads = 1) {
+	return maximum(grid, region, AllPoints(), threads);
+}
+
+// Sum and Euclidean norm of the selected values.
+template <typename Grid, typename Mask, typename = internal::EnableMask<Mask>>
+internal::ReductionScalar<Grid> sum(const Grid& grid, const GridRegion& region, const Mask& mask, unsigned threads = 1) {
+	return statistics(grid, region, mask, threads).sum;
+}
+
+template <typename Grid>
+internal::ReductionScalar<Grid> sum(const Grid& grid, const GridRegion& region = GridRegion(), unsigned threads = 1) {
+	return sum(grid, region, AllPoints(), threads);
+}
+
+template <typename Grid, typename Mask, typename = internal::EnableMask<Mask>>
+internal::ReductionScalar<Grid> norm2(const Grid& grid, const GridRegion& region, const Mask& mask, unsigned threads = 1) {
+	return statistics(grid, region, mask, threads).norm();
+}
+
+template <typename Grid>
+internal::ReductionScalar<Grid> norm2(const Grid& grid, const GridRegion& region = GridRegion(), unsigned threads = 1) {
+	return norm2(grid, region, AllPoints(), threads);
+}
+
+// Position of the largest and smallest selected values.
+template <typename Grid, typename Mask, typename = internal::EnableMask<Mask>>
+GridExtremum<internal::ReductionScalar<Grid>> argmax(const Grid& grid, const GridRegion& region, const Mask& mask, unsigned threads = 1) {
+	return internal::reduceGrid(grid, region, mask, threads, internal::ExtremumAccumulator<internal::ReductionScalar<Grid>, true>()).result;
+}
+
+template <typename Grid>
+GridExtremum<internal::ReductionScalar<Grid>> argmax(const Grid& grid, const GridRegion& region = GridRegion(), unsigned threads = 1) {
+	return argmax(grid, region, AllPoints(), threads);
+}
+
+template <typename Grid, typename Mask, typename = internal::EnableMask<Mask>>
+GridExtremum<internal::ReductionScalar<Grid>> argmin(const Grid& grid, const GridRegion& region, const Mask& mask, unsigned threads = 1) {
+	return internal::reduceGrid(grid, region, mask, threads, internal::ExtremumAccumulator<internal::ReductionScalar<Grid>, false>()).result;
+}
+
+template <typename Grid>
+GridExtremum<internal::ReductionScalar<Grid>> argmin(const Grid& grid, const GridRegion& region = GridRegion(), unsigned threads = 1) {
+	return argmin(grid, region, AllPoints(), threads);
+}
+
+// Counts of the selected values in bins equal parts of [lower, upper].
+// Values outside the range are not counted.
+template <typename Grid, typename Mask, typename = internal::EnableMask<Mask>>
+std::vector<std::size_t> histogram(const Grid& grid, unsigned bins, internal::ReductionScalar<Grid> lower, internal::ReductionScalar<Grid> upper,
+	const GridRegion& region, const Mask& mask, unsigned threads = 1) {
+	if (bins == 0) throw std::invalid_argument("Histograms need at least one bin.");
+	if (not (upper > lower)) throw std::invalid_argument("Histogram bounds must be increasing.");
+	internal::HistogramAccumulator<internal::ReductionScalar<Grid>> identity(bins, lower, upper);
+	return internal::reduceGrid(grid, region, mask, threads, identity).counts;
+}
+
+template <typename Grid>
+std::vector<std::size_t> histogram(const Grid& grid, unsigned bins, internal::ReductionScalar<Grid> lower, internal::ReductionScalar<Grid> upper,
+	const GridRegion& region = GridRegion(), unsigned threads = 1) {
+	return histogram(grid, bins, lower, upper, region, AllPoints(), threads);
+}
+
+}	// Namespace function.
+}	// Namespace math.
@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <math/index.hpp>
+
+namespace math {
+namespace function {
+
+// Storage backends for SquareGrid.
+// A storage holds the values of the grid, in the order given by the layout.
+// It is constructed from the number of values, and provides operator[] and size(),
+// like std::vector, which is the default storage.
+
+// Same storage kind, holding values of another type. Used by operators that return
+// grids of another element type, as gradient() does.
+template <typename Storage, typename F>
+struct StorageRebind;
+
+template <template <typename...> class Storage, typename E, typename... Rest, typename F>
+struct StorageRebind<Storage<E, Rest...>, F> {
+	using type = Storage<F>;
+};
+
+template <typename Storage, typename F>
+using RebindStorage = typename StorageRebind<Storage, F>::type;
+
+
+// Block structure of storages, used by sweeps to handle uniform blocks at once.
+// Sparse storages overload these functions. Dense storages are a single block of all
+// values, which is never uniform.
+template <typename Storage>
+math::index_t storageBlockSize(const Storage& storage) {
+	return (storage.size() > 0) ? static_cast<math::index_t>(storage.size()) : 1;
+}
+
+// Whether all the values of the block are one shared value, storage[block * blockSize].
+template <typename Storage>
+bool uniformBlock(const Storage&, math::index_t) {
+	return false;
+}
+
+// Make all the values of the block copies of value.
+template <typename Storage, typename E>
+void fillBlock(Storage& storage, math::index_t block, const E& value) {
+	math::index_t size = storageBlockSize(storage);
+	math::index_t last = std::min(block * size + size, static_cast<math::index_t>(storage.size()));
+	for (math::index_t k = block * size; k < last; ++k) storage[k] = value;
+}
+
+// Collapse the blocks whose values are all equal. Nothing to do for dense storages.
+template <typename Storage, typename Equal>
+void compactStorage(Storage&, Equal) {}
+
+namespace internal {
+
+// Threads that can write distinct rows of a grid at once. Writes can materialise blocks
+// of sparse storages shared by several rows, so those grids are written by one thread.
+template <typename Grid>
+auto concurrentWriteThreads(const Grid& grid, unsigned threads, int) -> decltype(storageBlockSize(grid.storage()), 0u) {
+	return (storageBlockSize(grid.storage()) < grid.storage().size()) ? 1u : threads;
+}
+
+template <typename Grid>
+unsigned concurrentWriteThreads(const Grid&, unsigned threads, long) {return threads;}
+
+}	// Namespace internal.
+
+}	// Namespace function.
+}	// Namespace math.
@@ -0,0 +1,225 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#include <math/index.hpp>
+#include <math/linear/static_vector.hpp>
+#include <math/geometry/2D/polygonal_chain.hpp>
+#include <math/geometry/2D/simple_polygon.hpp>
+#include <math/function/grid_reduction.hpp>
+#include <math/parallel/parallel_for.hpp>
+
+namespace math {
+namespace function {
+
+// Contours of a grid at one level. Contours ending on the border of the grid are open
+// chains, the others are closed polygons.
+template <typename T>
+struct Isolines {
+	std::vector<math::geometry2::PolygonalChain<T>> open;
+	std::vector<math::geometry2::SimplePolygon<T>> closed;
+};
+
+
+namespace internal {
+
+// Contour piece inside a cell, between two crossings. Crossings are named after the
+// grid edge they lie on, so pieces of neighbouring cells meet at equal names.
+template <typename T>
+struct IsolineSegment {
+	unsigned long long first;
+	unsigned long long second;
+	math::linear::StaticVector<T,2> from;
+	math::linear::StaticVector<T,2> to;
+};
+
+// Pieces of each case, as pairs of cell edges: 0 bottom, 1 right, 2 top, 3 left.
+// Corner bits: 1 (i,j), 2 (i+1,j), 4 (i+1,j+1), 8 (i,j+1). Saddles 5 and 10 are listed
+// for a center below the level, and flipped when it is above.
+static const int isolineCases[16][4] = {
+	{-1,-1,-1,-1}, {3,0,-1,-1}, {0,1,-1,-1}, {3,1,-1,-1},
+	{1,2,-1,-1}, {3,0,1,2}, {0,2,-1,-1}, {3,2,-1,-1},
+	{2,3,-1,-1}, {0,2,-1,-1}, {0,1,2,3}, {1,2,-1,-1},
+	{1,3,-1,-1}, {0,1,-1,-1}, {0,3,-1,-1}, {-1,-1,-1,-1}
+};
+
+// Join the pieces of one level into contours. Pieces are visited in order, so the
+// result only depends on the order of the pieces.
+template <typename T>
+void stitchIsolines(const std::vector<IsolineSegment<T>>& segments, Isolines<T>& output) {
+	math::index_t size = segments.size();
+	std::unordered_map<unsigned long long, std::array<math::index_t,2>> pieces;
+	pieces.reserve(2 * size);
+	for (math::index_t s = 0; s < size; ++s) {
+		for (unsigned long long crossing : {segments[s].first, segments[s].second}) {
+			auto found = pieces.find(crossing);
+			if (found == pieces.end()) pieces.emplace(crossing, std::array<math::index_t,2>{{s, size}});
+			else found->second[1] = s;
+		}
+	}
+
+	// Piece, other than s, meeting s at the crossing. Size when there is none.
+	auto next = [&](math::index_t s, unsigned long long crossing) {
+		const std::array<math::index_t,2>& pair = pieces.find(crossing)->second;
+		return (pair[0] == s) ? pair[1] : pair[0];
+	};
+
+	std::vector<bool> used(size, false);
+	for (math::index_t s = 0; s < size; ++s) {
+		if (used[s]) continue;
+		used[s] = true;
+
+		// Walk forward from the second crossing.
+		std::vector<math::linear::StaticVector<T,2>> forward({segments[s].from, segments[s].to});
+		unsigned long long head = segments[s].second;
+		math::index_t current = s;
+		bool closed = false;
+		while (true) {
+			math::index_t other = next(current, head);
+			if (other == size) break;
+			if (used[other]) {
+				closed = (other == s);
+				break;
+			}
+
+			used[other] = true;
+			const IsolineSegment<T>& segment = segments[other];
+			bool straight = (segment.first == head);
+			forward.push_back(straight ? segment.to : segment.from);
+			head = straight ? segment.second : segment.first;
+			current = other;
+		}
+
+		if (closed) {
+			// The last vertex repeats the first one.
+			forward.pop_back();
+			output.closed.push_back(math::geometry2::SimplePolygon<T>(forward));
+			continue;
+		}
+
+		// Walk backward from the first crossing.
+		std::vector<math::linear::StaticVector<T,2>> backward;
+		unsigned long long tail = segments[s].first;
+		current = s;
+		while (true) {
+			math::index_t other = next(current, tail);
+			if (other == size or used[other]) break;
+
+			used[other] = true;
+			const IsolineSegment<T>& segment = segments[other];
+			bool straight = (segment.second == tail);
+			backward.push_back(straight ? segment.from : segment.to);
+			tail = straight ? segment.first : segment.second;
+			current = other;
+		}
+
+		std::vector<math::linear::StaticVector<T,2>> vertices(backward.rbegin(), backward.rend());
+		vertices.insert(vertices.end(), forward.begin(), forward.end());
+		output.open.push_back(math::geometry2::PolygonalChain<T>(vertices));
+	}
+}
+
+}	// Namespace internal.
+
+
+// Contours of a grid at every level, by marching squares.
+// The grid is read once: each cell is classified against all the levels while its
+// corners are at hand. Bands of cell rows run in parallel and keep their pieces in
+// row order; the bands are then stitched level by level, in parallel over the levels.
+// The result is the same for any number of threads.
+// Corners above the level are inside. Saddle cells are resolved with the cell average.
+template <typename Grid, typename S>
+std::vector<Isolines<typename std::decay<decltype(std::declval<const Grid&>().spacing())>::type>> isolines(const Grid& grid, const std::vector<S>& levels, unsigned threads = 1) {
+	using T = typename std::decay<decltype(std::declval<const Grid&>().spacing())>::type;
+	if (grid.sizex() < 2 or grid.sizey() < 2) throw std::invalid_argument("Contours need at least 2x2 grid points.");
+
+	unsigned sx = grid.sizex();
+	unsigned rows = grid.sizey() - 1;
+	math::index_t nlevels = levels.size();
+	if (threads == 0) threads = math::parallel::hardwareThreads();
+	unsigned bands = std::max(1u, std::min(threads, rows));
+
+	// Pieces of each band and level.
+	std::vector<std::vector<std::vector<internal::IsolineSegment<T>>>> pieces(bands, std::vector<std::vector<internal::IsolineSegment<T>>>(nlevels));
+	math::parallel::parallelFor(0, bands, bands, [&](unsigned firstband, unsigned lastband) {
+		for (unsigned band = firstband; band < lastband; ++band) {
+			unsigned first = static_cast<unsigned>((static_cast<unsigned long long>(rows) * band) / bands);
+			unsigned last = static_cast<unsigned>((static_cast<unsigned long long>(rows) * (band+1)) / bands);
+
+			for (unsigned j = first; j < last; ++j) {
+				for (unsigned i = 0; i < sx-1; ++i) {
+					S corner[4] = {
+						internal::reductionValue(grid.dataEvaluation(i,j)),
+						internal::reductionValue(grid.dataEvaluation(i+1,j)),
+						internal::reductionValue(grid.dataEvaluation(i+1,j+1)),
+						internal::reductionValue(grid.dataEvaluation(i,j+1))
+					};
+					math::linear::StaticVector<T,2> origin = grid.domainfromij(i,j);
+					T spacing = grid.spacing();
+
+					// Edge names: 2 (j*sx + i) for (i,j)-(i+1,j), plus one for (i,j)-(i,j+1).
+					unsigned long long base = 2ull * (static_cast<unsigned long long>(j) * sx + i);
+					unsigned long long names[4] = {base, base + 3, base + 2ull * sx, base + 1};
+
+					for (math::index_t l = 0; l < nlevels; ++l) {
+						const S& level = levels[l];
+						int index = (corner[0] > level ? 1 : 0) | (corner[1] > level ? 2 : 0) | (corner[2] > level ? 4 : 0) | (corner[3] > level ? 8 : 0);
+						if (index == 0 or index == 15) continue;
+
+						const int* edges = internal::isolineCases[index];
+						if (index == 5 or index == 10) {
+							S center = (corner[0] + corner[1] + corner[2] + corner[3]) / S(4);
+							if (center > level) edges = internal::isolineCases[15 - index];
+						}
+
+						// Crossing on each cell edge, interpolated from its lower corner so both
+						// cells of the edge find the same point.
+						auto crossing = [&](int edge) {
+							S a = corner[edge == 2 ? 3 : (edge == 1 ? 1 : 0)];
+							S b = corner[edge == 3 ? 3 : (edge == 0 ? 1 : 2)];
+							T t = static_cast<T>((level - a) / (b - a));
+							switch (edge) {
+								case 0: return math::linear::StaticVector<T,2>({origin.x() + t * spacing, origin.y()});
+								case 1: return math::linear::StaticVector<T,2>({origin.x() + spacing, origin.y() + t * spacing});
+								case 2: return math::linear::StaticVector<T,2>({origin.x() + t * spacing, origin.y() + spacing});
+								default: return math::linear::StaticVector<T,2>({origin.x(), origin.y() + t * spacing});
+							}
+						};
+
+						for (unsigned k = 0; k < 4 and edges[k] >= 0; k += 2) {
+							pieces[band][l].push_back(internal::IsolineSegment<T>{
+								names[edges[k]], names[edges[k+1]], crossing(edges[k]), crossing(edges[k+1])
+							});
+						}
+					}
+				}
+			}
+		}
+	});
+
+	// Stitch the bands of each level.
+	std::vector<Isolines<T>> output(nlevels);
+	math::parallel::parallelFor(0, nlevels, threads, [&](math::index_t first, math::index_t last) {
+		for (math::index_t l = first; l < last; ++l) {
+			std::vector<internal::IsolineSegment<T>> segments;
+			for (unsigned band = 0; band < bands; ++band) {
+				segments.insert(segments.end(), pieces[band][l].begin(), pieces[band][l].end());
+			}
+			internal::stitchIsolines(segments, output[l]);
+		}
+	});
+
+	return output;
+}
+
+// Contours of a grid at one level.
+template <typename Grid, typename S>
+auto isolines(const Grid& grid, const S& level, unsigned threads = 1) -> typename std::enable_if<std::is_arithmetic<S>::value, Isolines<typename std::decay<decltype(grid.spacing())>::type>>::type {
+	return isolines(grid, std::vector<S>({level}), threads).front();
+}
+
+}	// Namespace function.
+}	// Namespace math.
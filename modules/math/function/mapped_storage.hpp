@@ -0,0 +1,268 @@
+#pragma once
+#include <string>
+#include <cstdlib>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <math/index.hpp>
+
+namespace math {
+namespace function {
+
+// How a MappedStorage attaches to its file.
+enum class MappingMode {
+	Create,			// Create the file, or grow it to fit the values. Existing contents are kept. Writes reach the file.
+	Open,			// Open an existing file. Writes reach the file.
+	CopyOnWrite		// Open an existing file. Writes stay private to this process.
+};
+
+// Access pattern hints, forwarded to madvise.
+enum class AccessHint {
+	Normal, Sequential, Random
+};
+
+
+// Storage backend mapping a file into the address space.
+// The operating system pages values in and out on demand, so grids may be far larger
+// than the available memory. With a TiledLayout every tile is contiguous in the file,
+// so hints, prefetches and evictions act tile by tile.
+// Values of new files start zero-filled. The storage is movable, not copyable.
+template <typename E>
+class MappedStorage {
+	static_assert(std::is_standard_layout<E>::value, "Mapped values must have standard layout");
+
+	int _file;
+	void* _base;
+	std::size_t _length;
+	std::size_t _offset;
+	E* _data;
+	math::index_t _size;
+	MappingMode _mode;
+
+	void map(const char* path, int flags, MappingMode mode, bool unlink_file);
+	void unmap();
+
+	// Page aligned byte range of the values [first, first+count).
+	void pageRange(math::index_t first, math::index_t count, char*& begin, std::size_t& length) const;
+
+public:
+	using value_type = E;
+	using reference = E&;
+	using const_reference = const E&;
+
+	// Values backed by an unlinked temporary file, in TMPDIR or /tmp.
+	explicit MappedStorage(math::index_t size = 0);
+
+	// Values backed by path, starting offset bytes into the file.
+	MappedStorage(const std::string& path, math::index_t size, MappingMode mode = MappingMode::Create, std::size_t offset = 0);
+
+	MappedStorage(const MappedStorage&) = delete;
+	MappedStorage& operator=(const MappedStorage&) = delete;
+	MappedStorage(MappedStorage&& other);
+	MappedStorage& operator=(MappedStorage&& other);
+	~MappedStorage();
+
+	// Accessor functions.
+	inline math::index_t size() const {return _size;}
+	inline const E* data() const {return _data;}
+	inline E* data() {return _data;}
+	inline const E& operator[](math::index_t i) const {return _data[i];}
+	inline E& operator[](math::index_t i) {return _data[i];}
+
+	// Paging control.
+	void advise(AccessHint hint) const;
+	void advise(AccessHint hint, math::index_t first, math::index_t count) const;
+	void prefetch(math::index_t first, math::index_t count) const;
+	// Write back and drop the pages of the values. Nothing to do for CopyOnWrite mappings,
+	// whose values live only in memory.
+	void evict(math::index_t first, math::index_t count) const;
+	void flush() const;
+};
+
+
+template <typename E>
+MappedStorage<E>::MappedStorage(math::index_t size)
+: _file(-1), _base(nullptr), _length(0), _offset(0), _data(nullptr), _size(size), _mode(MappingMode::Create) {
+	const char* directory = std::getenv("TMPDIR");
+	std::string path = std::string((directory and *directory) ? directory : "/tmp") + "/square_grid_XXXXXX";
+	std::vector<char> name(path.begin(), path.end());
+	name.push_back('\0');
+
+	int file = mkstemp(name.data());
+	if (file < 0) throw std::runtime_error("Could not create the temporary mapping file.");
+	close(file);
+
+	map(name.data(), O_RDWR, MappingMode::Create, true);
+}
+
+template <typename E>
+MappedStorage<E>::MappedStorage(const std::string& path, math::index_t size, MappingMode mode, std::size_t offset)
+: _file(-1), _base(nullptr), _length(0), _offset(offset), _data(nullptr), _size(size), _mode(mode) {
+	if (offset % alignof(E) != 0) throw std::invalid_argument("Misaligned offset for the mapped values.");
+	int flags = (mode == MappingMode::Create) ? (O_RDWR | O_CREAT) : ((mode == MappingMode::Open) ? O_RDWR : O_RDONLY);
+	map(path.c_str(), flags, mode, false);
+}
+
+template <typename E>
+void MappedStorage<E>::map(const char* path, int flags, MappingMode mode, bool unlink_file) {
+	_file = open(path, flags, 0644);
+	if (unlink_file) unlink(path);
+	if (_file < 0) throw std::runtime_error("Could not open the mapping file.");
+
+	// Make sure the file holds every value.
+	_length = _offset + static_cast<std::size_t>(_size) * sizeof(E);
+	struct stat status;
+	if (fstat(_file, &status) != 0) {
+		unmap();
+		throw std::runtime_error("Could not read the mapping file size.");
+	}
+
+	if (static_cast<std::size_t>(status.st_size) < _length) {
+		if (mode != MappingMode::Create  or  ftruncate(_file, static_cast<off_t>(_length)) != 0) {
+			unmap();
+			throw std::runtime_error("Mapping file too small for the grid.");
+		}
+	}
+
+	if (_length == 0) return;
+
+	// Map the whole file: offsets given to mmap must be page aligned, ours may not.
+	int sharing = (mode == MappingMode::CopyOnWrite) ? MAP_PRIVATE : MAP_SHARED;
+	_base = mmap(nullptr, _length, PROT_READ | PROT_WRITE, sharing, _file, 0);
+	if (_base == MAP_FAILED) {
+		_base = nullptr;
+		unmap();
+		throw std::runtime_error("Could not map the file.");
+	}
+
+	_data = reinterpret_cast<E*>(static_cast<char*>(_base) + _offset);
+}
+
+template <typename E>
+void MappedStorage<E>::unmap() {
+	if (_base) munmap(_base, _length);
+	if (_file >= 0) close(_file);
+	_base = nullptr;
+	_data = nullptr;
+	_file = -1;
+}
+
+template <typename E>
+MappedStorage<E>::MappedStorage(MappedStorage&& other)
+: _file(other._file), _base(other._base), _length(other._length), _offset(other._offset), _data(other._data), _size(other._size), _mode(other._mode) {
+	other._file = -1;
+	other._base = nullptr;
+	other._data = nullptr;
+	other._size = 0;
+}
+
+template <typename E>
+MappedStorage<E>& MappedStorage<E>::operator=(MappedStorage&& other) {
+	if (this == &other) return *this;
+	unmap();
+	std::swap(_file, other._file);
+	std::swap(_base, other._base);
+	std::swap(_length, other._length);
+	std::swap(_offset, other._offset);
+	std::swap(_data, other._data);
+	std::swap(_size, other._size);
+	std::swap(_mode, other._mode);
+	return *this;
+}
+
+template <typename E>
+MappedStorage<E>::~MappedStorage() {
+	unmap();
+}
+
+template <typename E>
+void MappedStorage<E>::pageRange(math::index_t first, math::index_t count, char*& begin, std::size_t& length) const {
+	std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	std::size_t start = _offset + static_cast<std::size_t>(first) * sizeof(E);
+	std::size_t end = std::min(_length, _offset + static_cast<std::size_t>(first + count) * sizeof(E));
+	start -= start % page;
+	begin = static_cast<char*>(_base) + start;
+	length = (end > start) ? end - start : 0;
+}
+
+template <typename E>
+void MappedStorage<E>::advise(AccessHint hint) const {
+	advise(hint, 0, _size);
+}
+
+template <typename E>
+void MappedStorage<E>::advise(AccessHint hint, math::index_t first, math::index_t count) const {
+	if (not _base  or  count == 0) return;
+	char* begin;
+	std::size_t length;
+	pageRange(first, count, begin, length);
+
+	int advice = MADV_NORMAL;
+	if (hint == AccessHint::Sequential) advice = MADV_SEQUENTIAL;
+	if (hint == AccessHint::Random) advice = MADV_RANDOM;
+	madvise(begin, length, advice);
+}
+
+template <typename E>
+void MappedStorage<E>::prefetch(math::index_t first, math::index_t count) const {
+	if (not _base  or  count == 0) return;
+	char* begin;
+	std::size_t length;
+	pageRange(first, count, begin, length);
+	madvise(begin, length, MADV_WILLNEED);
+}
+
+template <typename E>
+void MappedStorage<E>::evict(math::index_t first, math::index_t count) const {
+	// Private mappings would lose their writes.
+	if (not _base  or  count == 0  or  _mode == MappingMode::CopyOnWrite) return;
+	char* begin;
+	std::size_t length;
+	pageRange(first, count, begin, length);
+
+	// Shared mappings keep their data in the file.
+	msync(begin, length, MS_SYNC);
+	madvise(begin, length, MADV_DONTNEED);
+}
+
+template <typename E>
+void MappedStorage<E>::flush() const {
+	if (_base) msync(_base, _length, MS_SYNC);
+}
+
+
+// Prefetch the values of the window [i0, i0+nx) x [j0, j0+ny) of a grid on a mapped storage.
+// Works with any layout: runs of consecutive storage indexes are merged while walking the
+// window row by row, and each run is handed to the operating system at once.
+template <typename Grid>
+void prefetchWindow(const Grid& grid, unsigned i0, unsigned j0, unsigned nx, unsigned ny) {
+	unsigned iend = std::min(i0 + nx, grid.sizex());
+	unsigned jend = std::min(j0 + ny, grid.sizey());
+	if (i0 >= iend  or  j0 >= jend) return;
+
+	math::index_t first = grid.datafromij(i0, j0);
+	math::index_t last = first;
+	for (unsigned j = j0; j < jend; ++j) {
+		for (unsigned i = i0; i < iend; ++i) {
+			math::index_t index = grid.datafromij(i, j);
+			if (index == last + 1) {
+				last = index;
+			} else if (index != last) {
+				grid.storage().prefetch(first, last - first + 1);
+				first = last = index;
+			}
+		}
+	}
+
+	grid.storage().prefetch(first, last - first + 1);
+}
+
+}	// Namespace function.
+}	// Namespace math.
@@ -0,0 +1,235 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <math/linear/static_vector.hpp>
+#include <math/linear/static_matrix.hpp>
+#include <math/function/grid_storage.hpp>
+#include <math/function/grid_reduction.hpp>
+#include <math/parallel/parallel_for.hpp>
+
+namespace math {
+namespace function {
+
+// Interpolation of the source in resampling.
+enum class ResampleMethod {
+	Bilinear,		// Exact for linear fields, never overshoots.
+	Bicubic			// Catmull-Rom, as CubicKernel::CatmullRom: exact for quadratics.
+};
+
+
+namespace internal {
+
+// Source points along one axis and their weights, for one target row or column.
+template <typename T, unsigned Taps>
+struct ResampleTap {
+	unsigned index[Taps];
+	T weight[Taps];
+};
+
+// Linear and Catmull-Rom weights at u in [0,1].
+template <typename T>
+void resampleWeights(T u, T (&weight)[2]) {weight[0] = T(1.0) - u; weight[1] = u;}
+
+template <typename T>
+void resampleWeights(T u, T (&weight)[4]) {
+	T u2 = u * u;
+	T u3 = u2 * u;
+	weight[0] = T(0.5) * (-u3 + T(2.0) * u2 - u);
+	weight[1] = T(0.5) * (T(3.0) * u3 - T(5.0) * u2 + T(2.0));
+	weight[2] = T(0.5) * (T(-3.0) * u3 + T(4.0) * u2 + u);
+	weight[3] = T(0.5) * (u3 - u2);
+}
+
+// Tap at x, in source index units. Points outside of the source are clamped to its
+// edges, and points around the edges are replicated.
+template <unsigned Taps, typename T>
+ResampleTap<T,Taps> interpolationTap(T x, unsigned size) {
+	x = std::min(std::max(x, T(0.0)), static_cast<T>(size-1));
+	unsigned i = std::min(static_cast<unsigned>(std::floor(x)), size-2);
+
+	ResampleTap<T,Taps> tap;
+	resampleWeights(x - static_cast<T>(i), tap.weight);
+	for (unsigned a = 0; a < Taps; ++a) {
+		int k = static_cast<int>(i + a) - static_cast<int>(Taps/2 - 1);
+		tap.index[a] = static_cast<unsigned>(std::min(std::max(k, 0), static_cast<int>(size) - 1));
+	}
+
+	return tap;
+}
+
+// Writes to targets. Frozen points of solver grids keep their values.
+template <typename S, typename V>
+inline void resampleStore(S& point, const V& value) {point = value;}
+
+template <typename S, typename V>
+inline void resampleStore(math::solver::FiniteElement<S>& point, const V& value) {if (not point.frozen()) point = static_cast<S>(value);}
+
+// Separable resampling: the taps of the columns and the rows are computed once, and each
+// target point is a weighted sum over Taps x Taps source points.
+template <unsigned Taps, typename Source, typename Target, typename T>
+void resampleSeparable(const Source& source, Target& target, const std::vector<ResampleTap<T,Taps>>& columns, const std::vector<ResampleTap<T,Taps>>& rows, unsigned threads) {
+	using V = ReductionScalar<Source>;
+	unsigned sizex = target.sizex();
+
+	math::parallel::parallelFor(0, target.sizey(), concurrentWriteThreads(target, threads, 0), [&](unsigned first, unsigned last) {
+		std::vector<V> line(sizex);
+		for (unsigned j = first; j < last; ++j) {
+			const ResampleTap<T,Taps>& row = rows[j];
+			std::fill(line.begin(), line.end(), V());
+
+			// Accumulate source rows one at a time, so the inner loop runs along a row.
+			for (unsigned b = 0; b < Taps; ++b) {
+				unsigned sj = row.index[b];
+				T wy = row.weight[b];
+				for (unsigned i = 0; i < sizex; ++i) {
+					const ResampleTap<T,Taps>& column = columns[i];
+					V sum = V();
+					for (unsigned a = 0; a < Taps; ++a) sum += reductionValue(source.dataEvaluation(column.index[a], sj)) * column.weight[a];
+					line[i] += sum * wy;
+				}
+			}
+
+			for (unsigned i = 0; i < sizex; ++i) resampleStore(target.dataEvaluation(i,j), line[i]);
+		}
+	});
+}
+
+// Taps of the target points along one axis of a source in the same frame.
+template <unsigned Taps, typename T>
+std::vector<ResampleTap<T,Taps>> interpolationTaps(unsigned count, T first, T step, unsigned size) {
+	std::vector<ResampleTap<T,Taps>> taps(count);
+	for (unsigned k = 0; k < count; ++k) taps[k] = interpolationTap<Taps>(first + static_cast<T>(k) * step, size);
+	return taps;
+}
+
+// Resampling through an affine map: the source position moves by a constant step along
+// each target row, and the taps are computed point by point.
+template <unsigned Taps, typename Source, typename Target, typename T>
+void resampleAffine(const Source& source, Target& target, const math::linear::StaticVector<T,2>& origin, const math::linear::StaticVector<T,2>& stepx, const math::linear::StaticVector<T,2>& stepy, unsigned threads) {
+	using V = ReductionScalar<Source>;
+	unsigned sizex = target.sizex();
+	unsigned sx = source.sizex();
+	unsigned sy = source.sizey();
+
+	math::parallel::parallelFor(0, target.sizey(), concurrentWriteThreads(target, threads, 0), [&](unsigned first, unsigned last) {
+		for (unsigned j = first; j < last; ++j) {
+			math::linear::StaticVector<T,2> start = origin + static_cast<T>(j) * stepy;
+			for (unsigned i = 0; i < sizex; ++i) {
+				ResampleTap<T,Taps> column = interpolationTap<Taps>(start.x() + static_cast<T>(i) * stepx.x(), sx);
+				ResampleTap<T,Taps> row = interpolationTap<Taps>(start.y() + static_cast<T>(i) * stepx.y(), sy);
+
+				V value = V();
+				for (unsigned b = 0; b < Taps; ++b) {
+					V sum = V();
+					for (unsigned a = 0; a < Taps; ++a) sum += reductionValue(source.dataEvaluation(column.index[a], row.index[b])) * column.weight[a];
+					value += sum * row.weight[b];
+				}
+
+				resampleStore(target.dataEvaluation(i,j), value);
+			}
+		}
+	});
+}
+
+template <typename Grid>
+using ResampleCoordinate = typename std::decay<decltype(std::declval<const Grid&>().spacing())>::type;
+
+}	// Namespace internal.
+
+
+// Resample the source on the points of the target, in the same world frame.
+// Targets outside of the source take the values at the nearest source edge. Frozen
+// points of solver grids are kept, so a fine FDM can be warm started from a coarse one.
+template <typename Source, typename Target>
+void resample(const Source& source, Target& target, ResampleMethod method = ResampleMethod::Bilinear, unsigned threads = 1) {
+	using T = internal::ResampleCoordinate<Target>;
+	if (source.sizex() < 2 or source.sizey() < 2) throw std::invalid_argument("Resampling needs at least 2x2 source points.");
+
+	T step = target.spacing() / static_cast<T>(source.spacing());
+	T firstx = (target.start().x() - static_cast<T>(source.start().x())) / static_cast<T>(source.spacing());
+	T firsty = (target.start().y() - static_cast<T>(source.start().y())) / static_cast<T>(source.spacing());
+
+	if (method == ResampleMethod::Bicubic) {
+		auto columns = internal::interpolationTaps<4>(target.sizex(), firstx, step, source.sizex());
+		auto rows = internal::interpolationTaps<4>(target.sizey(), firsty, step, source.sizey());
+		internal::resampleSeparable(source, target, columns, rows, threads);
+	} else {
+		auto columns = internal::interpolationTaps<2>(target.sizex(), firstx, step, source.sizex());
+		auto rows = internal::interpolationTaps<2>(target.sizey(), firsty, step, source.sizey());
+		internal::resampleSeparable(source, target, columns, rows, threads);
+	}
+}
+
+// Resample the source on the points of the target, seen through an affine map: target
+// point p takes the source value at matrix * p + offset, in world coordinates.
+template <typename Source, typename Target, typename T>
+void resample(const Source& source, Target& target, const math::linear::StaticMatrix<T,2,2>& matrix, const math::linear::StaticVector<T,2>& offset, ResampleMethod method = ResampleMethod::Bilinear, unsigned threads = 1) {
+	if (source.sizex() < 2 or source.sizey() < 2) throw std::invalid_argument("Resampling needs at least 2x2 source points.");
+
+	// Source index coordinates of the first target point and steps along i and j.
+	T inverse = T(1.0) / static_cast<T>(source.spacing());
+	math::linear::StaticVector<T,2> p = target.start();
+	math::linear::StaticVector<T,2> origin({
+		(matrix(0,0) * p.x() + matrix(0,1) * p.y() + offset.x() - static_cast<T>(source.start().x())) * inverse,
+		(matrix(1,0) * p.x() + matrix(1,1) * p.y() + offset.y() - static_cast<T>(source.start().y())) * inverse
+	});
+	T h = static_cast<T>(target.spacing()) * inverse;
+	math::linear::StaticVector<T,2> stepx({matrix(0,0) * h, matrix(1,0) * h});
+	math::linear::StaticVector<T,2> stepy({matrix(0,1) * h, matrix(1,1) * h});
+
+	if (method == ResampleMethod::Bicubic) internal::resampleAffine<4>(source, target, origin, stepx, stepy, threads);
+	else internal::resampleAffine<2>(source, target, origin, stepx, stepy, threads);
+}
+
+// Interpolate a coarse grid on a finer one.
+template <typename Coarse, typename Fine>
+void prolongation(const Coarse& coarse, Fine& fine, ResampleMethod method = ResampleMethod::Bilinear, unsigned threads = 1) {
+	resample(coarse, fine, method, threads);
+}
+
+// Full-weighting restriction of a fine grid on a coarse one.
+// Coarse points must be fine points, with twice the fine spacing. Each one takes the
+// 1/4, 1/2, 1/4 weighted average of the 3x3 fine points around it, as GridPyramid.
+template <typename Fine, typename Coarse>
+void restriction(const Fine& fine, Coarse& coarse, unsigned threads = 1) {
+	using T = internal::ResampleCoordinate<Coarse>;
+	T spacing = static_cast<T>(fine.spacing());
+	T tolerance = T(1e-6);
+	if (std::fabs(coarse.spacing() / spacing - T(2.0)) > tolerance) throw std::invalid_argument("Coarse spacing must be twice the fine spacing.");
+
+	T firstx = (coarse.start().x() - static_cast<T>(fine.start().x())) / spacing;
+	T firsty = (coarse.start().y() - static_cast<T>(fine.start().y())) / spacing;
+	T roundx = std::round(firstx);
+	T roundy = std::round(firsty);
+	if (std::fabs(firstx - roundx) > tolerance or std::fabs(firsty - roundy) > tolerance) throw std::invalid_argument("Coarse points must be fine points.");
+	if (roundx < T(0.0) or roundy < T(0.0)) throw std::invalid_argument("Coarse grid outside of the fine grid.");
+	if (coarse.sizex() == 0 or coarse.sizey() == 0) return;
+
+	unsigned offsetx = static_cast<unsigned>(roundx);
+	unsigned offsety = static_cast<unsigned>(roundy);
+	if (offsetx + 2 * (coarse.sizex()-1) >= fine.sizex()) throw std::invalid_argument("Coarse grid outside of the fine grid.");
+	if (offsety + 2 * (coarse.sizey()-1) >= fine.sizey()) throw std::invalid_argument("Coarse grid outside of the fine grid.");
+
+	// Fine points around each coarse point, replicated at the edges.
+	auto taps = [](unsigned count, unsigned offset, unsigned size) {
+		std::vector<internal::ResampleTap<T,3>> result(count);
+		for (unsigned k = 0; k < count; ++k) {
+			for (unsigned a = 0; a < 3; ++a) {
+				int index = static_cast<int>(offset + 2*k + a) - 1;
+				result[k].index[a] = static_cast<unsigned>(std::min(std::max(index, 0), static_cast<int>(size) - 1));
+			}
+			result[k].weight[0] = T(0.25);
+			result[k].weight[1] = T(0.5);
+			result[k].weight[2] = T(0.25);
+		}
+		return result;
+	};
+
+	internal::resampleSeparable(fine, coarse, taps(coarse.sizex(), offsetx, fine.sizex()), taps(coarse.sizey(), offsety, fine.sizey()), threads);
+}
+
+}	// Namespace function.
+}	// Namespace math.
@@ -0,0 +1,143 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <math/index.hpp>
+#include <math/function/grid_storage.hpp>
+
+namespace math {
+namespace function {
+
+// Sparse storage for mostly constant grids.
+// The values are split in blocks of Block consecutive values. A uniform block stores its
+// value once; only the other blocks hold all their values. With TiledLayout<Tile> and
+// Block = Tile*Tile, every block is a tile of the grid, which is the intended use.
+//
+// Const access never allocates. Non-const access returns a reference to the value, so it
+// materialises the block first: read through a const grid whenever possible, and call
+// compact() after large updates to collapse the blocks that became uniform again.
+template <typename E, unsigned Block = 64>
+class SparseTileStorage {
+	static_assert(Block > 0, "Blocks must have at least one value");
+
+	math::index_t _size;
+
+	// One value for uniform blocks, Block values for the others.
+	// Values are copy constructed, never assigned, so all their state is kept.
+	std::vector<std::vector<E>> _blocks;
+
+public:
+	static const unsigned block = Block;
+
+	explicit SparseTileStorage(math::index_t size = 0, const E& value = E());
+
+	// Accessor functions.
+	inline math::index_t size() const {return _size;}
+	inline math::index_t blocks() const {return _blocks.size();}
+	inline bool uniform(math::index_t b) const {return _blocks[b].size() == 1;}
+	math::index_t allocatedBlocks() const;
+
+	const E& operator[](math::index_t k) const;
+	E& operator[](math::index_t k);
+
+	// Make block b uniform with value.
+	void fill(math::index_t b, const E& value);
+
+	// Give block b its own values.
+	void materialise(math::index_t b);
+
+	// Collapse the blocks whose values are all equal. Returns the number of collapsed blocks.
+	template <typename Equal>
+	math::index_t compact(Equal equal);
+	math::index_t compact();
+};
+
+
+template <typename E, unsigned Block>
+SparseTileStorage<E,Block>::SparseTileStorage(math::index_t size, const E& value)
+: _size(size), _blocks((size + Block - 1) / Block, std::vector<E>(1, value)) {}
+
+template <typename E, unsigned Block>
+math::index_t SparseTileStorage<E,Block>::allocatedBlocks() const {
+	math::index_t count = 0;
+	for (const auto& values : _blocks) if (values.size() > 1) ++count;
+	return count;
+}
+
+template <typename E, unsigned Block>
+const E& SparseTileStorage<E,Block>::operator[](math::index_t k) const {
+	const std::vector<E>& values = _blocks[k / Block];
+	return (values.size() == 1) ? values.front() : values[k % Block];
+}
+
+template <typename E, unsigned Block>
+E& SparseTileStorage<E,Block>::operator[](math::index_t k) {
+	std::vector<E>& values = _blocks[k / Block];
+	if (values.size() == 1 and Block > 1) materialise(k / Block);
+	return values[k % Block];
+}
+
+template <typename E, unsigned Block>
+void SparseTileStorage<E,Block>::fill(math::index_t b, const E& value) {
+	std::vector<E>(1, value).swap(_blocks[b]);
+}
+
+template <typename E, unsigned Block>
+void SparseTileStorage<E,Block>::materialise(math::index_t b) {
+	std::vector<E>& values = _blocks[b];
+	if (values.size() != 1) return;
+	std::vector<E>(Block, values.front()).swap(values);
+}
+
+template <typename E, unsigned Block>
+template <typename Equal>
+math::index_t SparseTileStorage<E,Block>::compact(Equal equal) {
+	math::index_t count = 0;
+	for (std::vector<E>& values : _blocks) {
+		if (values.size() == 1) continue;
+
+		const E& first = values.front();
+		bool same = std::all_of(values.begin() + 1, values.end(), [&](const E& value) {return equal(first, value);});
+		if (not same) continue;
+
+		std::vector<E>(1, first).swap(values);
+		++count;
+	}
+
+	return count;
+}
+
+template <typename E, unsigned Block>
+math::index_t SparseTileStorage<E,Block>::compact() {
+	return compact([](const E& a, const E& b) {return a == b;});
+}
+
+
+// Same block size, other element type.
+template <typename E, unsigned Block, typename F>
+struct StorageRebind<SparseTileStorage<E,Block>, F> {
+	using type = SparseTileStorage<F,Block>;
+};
+
+// Block structure for sweeps.
+template <typename E, unsigned Block>
+math::index_t storageBlockSize(const SparseTileStorage<E,Block>&) {
+	return Block;
+}
+
+template <typename E, unsigned Block>
+bool uniformBlock(const SparseTileStorage<E,Block>& storage, math::index_t b) {
+	return storage.uniform(b);
+}
+
+template <typename E, unsigned Block, typename F>
+void fillBlock(SparseTileStorage<E,Block>& storage, math::index_t b, const F& value) {
+	storage.fill(b, E(value));
+}
+
+template <typename E, unsigned Block, typename Equal>
+void compactStorage(SparseTileStorage<E,Block>& storage, Equal equal) {
+	storage.compact(equal);
+}
+
+}	// Namespace function.
+}	// Namespace math.
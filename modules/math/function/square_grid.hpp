@@ -1,11 +1,26 @@
 #pragma once
 #include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <math/index.hpp>
 #include <math/linear/static_vector.hpp>
+#include <math/function/grid_layout.hpp>
+#include <math/function/grid_storage.hpp>
+#include <math/function/workspace_storage.hpp>
+#include <math/parallel/parallel_for.hpp>
 
 namespace math {
 namespace function {
 
-template <typename T, typename E=T>
+// Base of the lazy element-wise expressions of grid_expression.hpp.
+template <typename Derived>
+struct GridExpression {
+	inline const Derived& derived() const {return static_cast<const Derived&>(*this);}
+};
+
+template <typename T, typename E=T, typename Layout=RowMajorLayout, typename Storage=std::vector<E>>
 class SquareGrid {
 	// Domain information.
 	unsigned _sizex;
@@ -13,38 +28,69 @@ class SquareGrid {
 	T _spacing;
 	math::linear::StaticVector<T,2> _start;
 	
+	// Memory layout of the image.
+	Layout _layout;
+	
 	
 protected:
 	// Image information.
-	std::vector<E> _data;
+	Storage _data;
 
 public:
+	// Values as returned by the storage: references, or proxies for compact storages.
+	using const_reference = decltype(std::declval<const Storage&>()[0]);
+	using reference = decltype(std::declval<Storage&>()[0]);
+
 	// Transfer from ij-coordinates to the image coordinates.
-	unsigned datafromij(unsigned i, unsigned j) const;
+	math::index_t datafromij(unsigned i, unsigned j) const;
 	math::linear::StaticVector<T,2> domainfromij(unsigned i, unsigned j) const;
 	
 	// Linear interpolation.
 	T linearBasisFunction(const math::linear::StaticVector<T,2>& coord) const;
 	E linearInterpolationEvaluation(const math::linear::StaticVector<T,2>& coord) const;
+	
+	// Locate the cell containing coord, and the local coordinates inside it.
+	void locateCell(const math::linear::StaticVector<T,2>& coord, unsigned& i, unsigned& j, T& u, T& v) const;
+	
+	// Finite differences at grid points. One sided at the edges.
+	E nodePartialX(unsigned i, unsigned j) const;
+	E nodePartialY(unsigned i, unsigned j) const;
+	
+	// Central differences into grids of the sizes of partial_x(), partial_y() and gradient().
+	template <typename Grid> void fillPartialX(Grid& grid) const;
+	template <typename Grid> void fillPartialY(Grid& grid) const;
+	template <typename Grid> void fillGradient(Grid& grid) const;
 
 public:
 	// Constructor functions
 	SquareGrid(unsigned sizex, unsigned sizey, const T& spacing, math::linear::StaticVector<T,2> start = math::linear::StaticVector<T,2>())
-	: _sizex(sizex), _sizey(sizey), _spacing(spacing), _start(start), _data(sizex * sizey) {}
+	: _sizex(sizex), _sizey(sizey), _spacing(spacing), _start(start), _layout(sizex, sizey), _data(_layout.size()) {}
+	
+	// Constructor over an existing storage, which must fit the layout.
+	SquareGrid(unsigned sizex, unsigned sizey, const T& spacing, math::linear::StaticVector<T,2> start, Storage&& storage);
 	
 	// Accessor functions
 	inline unsigned sizex() const {return _sizex;}
 	inline unsigned sizey() const {return _sizey;}
 	inline const T& spacing() const {return _spacing;}
 	inline const math::linear::StaticVector<T,2>& start() const {return _start;}
+	inline const Layout& layout() const {return _layout;}
+	inline const Storage& storage() const {return _data;}
+	inline Storage& storage() {return _data;}
 	inline math::linear::StaticVector<T,2> end() const {return _start + _spacing * math::linear::StaticVector<T,2>({static_cast<T>(_sizex-1), static_cast<T>(_sizey-1)});}
 	
 	// Some other functions.
-	const SquareGrid<T,E>& setValueAllSquares(const T& value);
+	const SquareGrid<T,E,Layout,Storage>& setValueAllSquares(const T& value);
+	
+	// Evaluation of an element-wise expression into the grid, in a single loop.
+	template <typename X>
+	SquareGrid<T,E,Layout,Storage>& assign(const GridExpression<X>& expression, unsigned threads = 1);
+	template <typename X>
+	SquareGrid<T,E,Layout,Storage>& operator=(const GridExpression<X>& expression);
 	
 	// Evaluation at grid points.
-	const E& dataEvaluation(unsigned i, unsigned j) const;
-	E& dataEvaluation(unsigned i, unsigned j);
+	const_reference dataEvaluation(unsigned i, unsigned j) const;
+	reference dataEvaluation(unsigned i, unsigned j);
 
 	// Interpolated evaluation.
 	E evaluate(const math::linear::StaticVector<T,2>& coord) const;
@@ -52,51 +98,117 @@ public:
 	E evaluate(const T& x, const T& y) const;
 	E operator()(const T& x, const T& y) const;
 	
+	// Batched interpolated evaluation. The output vector is resized to fit.
+	void evaluate(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const;
+	
 	// Partial derivative operators.
 	E evaluate_partial_x(const math::linear::StaticVector<T,2>& coord) const;
 	E evaluate_partial_y(const math::linear::StaticVector<T,2>& coord) const;
-	SquareGrid<T,E> partial_x() const;
-	SquareGrid<T,E> partial_y() const;
+	void evaluate_partial_x(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const;
+	void evaluate_partial_y(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const;
+	SquareGrid<T,E,Layout,Storage> partial_x() const;
+	SquareGrid<T,E,Layout,Storage> partial_y() const;
+	
+	// Same operators on scratch grids borrowed from a workspace, for repeated use.
+	SquareGrid<T,E,Layout,WorkspaceStorage<E>> partial_x(math::memory::Workspace& workspace) const;
+	SquareGrid<T,E,Layout,WorkspaceStorage<E>> partial_y(math::memory::Workspace& workspace) const;
 	
 	// Gradient operators.
 	math::linear::StaticVector<E,2> evaluate_gradient(const math::linear::StaticVector<T,2>& coord) const;
-	SquareGrid<T,math::linear::StaticVector<E,2>> gradient() const;
+	void evaluate_gradient(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<math::linear::StaticVector<E,2>>& values) const;
+	SquareGrid<T,math::linear::StaticVector<E,2>,Layout,RebindStorage<Storage,math::linear::StaticVector<E,2>>> gradient() const;
+	SquareGrid<T,math::linear::StaticVector<E,2>,Layout,WorkspaceStorage<math::linear::StaticVector<E,2>>> gradient(math::memory::Workspace& workspace) const;
 };
 
-template <typename T, typename E>
-unsigned SquareGrid<T,E>::datafromij(unsigned i, unsigned j) const {
+template <typename T, typename E, typename Layout, typename Storage>
+SquareGrid<T,E,Layout,Storage>::SquareGrid(unsigned sizex, unsigned sizey, const T& spacing, math::linear::StaticVector<T,2> start, Storage&& storage)
+: _sizex(sizex), _sizey(sizey), _spacing(spacing), _start(start), _layout(sizex, sizey), _data(std::move(storage)) {
+	if (_data.size() < _layout.size()) throw std::invalid_argument("Storage too small for the grid.");
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+math::index_t SquareGrid<T,E,Layout,Storage>::datafromij(unsigned i, unsigned j) const {
 	// This assumes both i and j are aligned with xhat and yhat unit vectors.
-	return j * _sizex + i;
+	return _layout.index(i, j);
 }
 
-template <typename T, typename E>
-math::linear::StaticVector<T,2> SquareGrid<T,E>::domainfromij(unsigned i, unsigned j) const {
+template <typename T, typename E, typename Layout, typename Storage>
+math::linear::StaticVector<T,2> SquareGrid<T,E,Layout,Storage>::domainfromij(unsigned i, unsigned j) const {
 	return math::linear::StaticVector<T,2>({
 		_start.x() + static_cast<T>(i) * _spacing,
 		_start.y() + static_cast<T>(j) * _spacing
 	});
 }
 
-template <typename T, typename E>
-const E& SquareGrid<T,E>::dataEvaluation(unsigned i, unsigned j) const {
+template <typename T, typename E, typename Layout, typename Storage>
+typename SquareGrid<T,E,Layout,Storage>::const_reference SquareGrid<T,E,Layout,Storage>::dataEvaluation(unsigned i, unsigned j) const {
 	return _data[datafromij(i,j)];
 }
 
-template <typename T, typename E>
-E& SquareGrid<T,E>::dataEvaluation(unsigned i, unsigned j) {
+template <typename T, typename E, typename Layout, typename Storage>
+typename SquareGrid<T,E,Layout,Storage>::reference SquareGrid<T,E,Layout,Storage>::dataEvaluation(unsigned i, unsigned j) {
 	return _data[datafromij(i,j)];
 }
 
-template <typename T, typename E>
-const SquareGrid<T,E>& SquareGrid<T,E>::setValueAllSquares(const T& value) {
-	unsigned size = _data.size();
-	for (unsigned k = 0; k < size; ++k) _data[k] = value;
+template <typename T, typename E, typename Layout, typename Storage>
+const SquareGrid<T,E,Layout,Storage>& SquareGrid<T,E,Layout,Storage>::setValueAllSquares(const T& value) {
+	// Uniform blocks of sparse storages are set once, keeping them uniform.
+	math::index_t size = _data.size();
+	math::index_t blocksize = storageBlockSize(_data);
+	for (math::index_t first = 0; first < size; first += blocksize) {
+		math::index_t block = first / blocksize;
+		if (uniformBlock(_data, block)) {
+			E element = static_cast<const Storage&>(_data)[first];
+			element = value;
+			fillBlock(_data, block, element);
+			continue;
+		}
+
+		math::index_t last = std::min(first + blocksize, size);
+		for (math::index_t k = first; k < last; ++k) _data[k] = value;
+	}
+
+	return *this;
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+template <typename X>
+SquareGrid<T,E,Layout,Storage>& SquareGrid<T,E,Layout,Storage>::assign(const GridExpression<X>& expression, unsigned threads) {
+	const X& values = expression.derived();
+	if (values.sizex() != _sizex or values.sizey() != _sizey) throw std::invalid_argument("Expression and grid sizes differ.");
+	
+	// Threads must not share blocks of sparse storages, which writes can materialise.
+	math::index_t size = _layout.size();
+	math::index_t blocksize = storageBlockSize(_data);
+	math::index_t grain = (blocksize < size) ? blocksize : 1;
+	
+	// Same layout everywhere: straight over the storage, in whole blocks. Otherwise, point by point.
+	if (X::template linear<Layout>()) {
+		math::parallel::parallelFor(0, (size + grain - 1) / grain, threads, [&](math::index_t first, math::index_t last) {
+			math::index_t end = std::min(last * grain, size);
+			for (math::index_t k = first * grain; k < end; ++k) _data[k] = values.at(k);
+		});
+	} else {
+		if (grain > 1) threads = 1;
+		math::parallel::parallelFor(0, _sizey, threads, [&](unsigned first, unsigned last) {
+			for (unsigned j = first; j < last; ++j) {
+				for (unsigned i = 0; i < _sizex; ++i) _data[datafromij(i,j)] = values(i,j);
+			}
+		});
+	}
+	
 	return *this;
 }
 
+template <typename T, typename E, typename Layout, typename Storage>
+template <typename X>
+SquareGrid<T,E,Layout,Storage>& SquareGrid<T,E,Layout,Storage>::operator=(const GridExpression<X>& expression) {
+	return assign(expression);
+}
+
 
-template <typename T, typename E>
-T SquareGrid<T,E>::linearBasisFunction(const math::linear::StaticVector<T,2>& coord) const {
+template <typename T, typename E, typename Layout, typename Storage>
+T SquareGrid<T,E,Layout,Storage>::linearBasisFunction(const math::linear::StaticVector<T,2>& coord) const {
 	if (coord.x() > 1.0) return T();
 	if (coord.y() > 1.0) return T();
 	if (coord.x() < -1.0) return T();
@@ -116,8 +228,8 @@ T SquareGrid<T,E>::linearBasisFunction(const math::linear::StaticVector<T,2>& co
 	return xvalue * yvalue;
 }
 
-template <typename T, typename E>
-E SquareGrid<T,E>::linearInterpolationEvaluation(const math::linear::StaticVector<T,2>& coord) const {
+template <typename T, typename E, typename Layout, typename Storage>
+E SquareGrid<T,E,Layout,Storage>::linearInterpolationEvaluation(const math::linear::StaticVector<T,2>& coord) const {
 	// Get left down corner point of the grid.
 	unsigned i = static_cast<unsigned>(std::floor((coord.x() - _start.x()) / _spacing));
 	unsigned j = static_cast<unsigned>(std::floor((coord.y() - _start.y()) / _spacing));
@@ -150,115 +262,230 @@ E SquareGrid<T,E>::linearInterpolationEvaluation(const math::linear::StaticVecto
 	;
 }
 
-template <typename T, typename E>
-E SquareGrid<T,E>::evaluate(const math::linear::StaticVector<T,2>& coord) const {
+template <typename T, typename E, typename Layout, typename Storage>
+E SquareGrid<T,E,Layout,Storage>::evaluate(const math::linear::StaticVector<T,2>& coord) const {
 	return linearInterpolationEvaluation(coord);
 }
 
-template <typename T, typename E>
-E SquareGrid<T,E>::operator()(const math::linear::StaticVector<T,2>& coord) const {
+template <typename T, typename E, typename Layout, typename Storage>
+E SquareGrid<T,E,Layout,Storage>::operator()(const math::linear::StaticVector<T,2>& coord) const {
 	return linearInterpolationEvaluation(coord);
 }
 
-template <typename T, typename E>
-E SquareGrid<T,E>::evaluate(const T& x, const T& y) const {
+template <typename T, typename E, typename Layout, typename Storage>
+E SquareGrid<T,E,Layout,Storage>::evaluate(const T& x, const T& y) const {
 	return linearInterpolationEvaluation(math::linear::StaticVector<T,2>({x, y}));
 }
 
-template <typename T, typename E>
-E SquareGrid<T,E>::operator()(const T& x, const T& y) const {
+template <typename T, typename E, typename Layout, typename Storage>
+E SquareGrid<T,E,Layout,Storage>::operator()(const T& x, const T& y) const {
 	return linearInterpolationEvaluation(math::linear::StaticVector<T,2>({x, y}));
 }
 
-template <typename T, typename E>
-E SquareGrid<T,E>::evaluate_partial_x(const math::linear::StaticVector<T,2>& coord) const {
+template <typename T, typename E, typename Layout, typename Storage>
+void SquareGrid<T,E,Layout,Storage>::evaluate(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const {
+	math::index_t size = coords.size();
+	values.resize(size);
+	for (math::index_t k = 0; k < size; ++k) values[k] = linearInterpolationEvaluation(coords[k]);
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+void SquareGrid<T,E,Layout,Storage>::locateCell(const math::linear::StaticVector<T,2>& coord, unsigned& i, unsigned& j, T& u, T& v) const {
+	// Check limits to verify if we are inside domain.
+	if (coord.x() < start().x()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.y() < start().y()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.x() > end().x()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.y() > end().y()) throw std::invalid_argument("Outside of domain of the function.");
+	
+	// Get left down corner point of the cell. Points on the upper edges belong to the last cell.
+	T x = (coord.x() - _start.x()) / _spacing;
+	T y = (coord.y() - _start.y()) / _spacing;
+	i = std::min(static_cast<unsigned>(std::floor(x)), _sizex-2);
+	j = std::min(static_cast<unsigned>(std::floor(y)), _sizey-2);
 	
+	// Local coordinates inside the cell, in [0,1].
+	u = x - static_cast<T>(i);
+	v = y - static_cast<T>(j);
 }
 
-template <typename T, typename E>
-E SquareGrid<T,E>::evaluate_partial_y(const math::linear::StaticVector<T,2>& coord) const {
+template <typename T, typename E, typename Layout, typename Storage>
+E SquareGrid<T,E,Layout,Storage>::nodePartialX(unsigned i, unsigned j) const {
+	if (i == 0) return (dataEvaluation(1,j) - dataEvaluation(0,j)) / _spacing;
+	if (i == _sizex-1) return (dataEvaluation(i,j) - dataEvaluation(i-1,j)) / _spacing;
+	return (dataEvaluation(i+1,j) - dataEvaluation(i-1,j)) / _spacing / T(2.0);
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+E SquareGrid<T,E,Layout,Storage>::nodePartialY(unsigned i, unsigned j) const {
+	if (j == 0) return (dataEvaluation(i,1) - dataEvaluation(i,0)) / _spacing;
+	if (j == _sizey-1) return (dataEvaluation(i,j) - dataEvaluation(i,j-1)) / _spacing;
+	return (dataEvaluation(i,j+1) - dataEvaluation(i,j-1)) / _spacing / T(2.0);
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+E SquareGrid<T,E,Layout,Storage>::evaluate_partial_x(const math::linear::StaticVector<T,2>& coord) const {
+	unsigned i, j;
+	T u, v;
+	locateCell(coord, i, j, u, v);
 	
+	// Bilinear interpolation of the central differences at the cell corners.
+	// In the interior this matches partial_x().evaluate(coord), without building the grid.
+	return
+		+ nodePartialX(i,j) * ((T(1.0) - u) * (T(1.0) - v))
+		+ nodePartialX(i+1,j) * (u * (T(1.0) - v))
+		+ nodePartialX(i,j+1) * ((T(1.0) - u) * v)
+		+ nodePartialX(i+1,j+1) * (u * v)
+	;
 }
 
-template <typename T, typename E>
-math::linear::StaticVector<E,2> SquareGrid<T,E>::evaluate_gradient(const math::linear::StaticVector<T,2>& coord) const {
+template <typename T, typename E, typename Layout, typename Storage>
+E SquareGrid<T,E,Layout,Storage>::evaluate_partial_y(const math::linear::StaticVector<T,2>& coord) const {
+	unsigned i, j;
+	T u, v;
+	locateCell(coord, i, j, u, v);
 	
+	// Bilinear interpolation of the central differences at the cell corners.
+	return
+		+ nodePartialY(i,j) * ((T(1.0) - u) * (T(1.0) - v))
+		+ nodePartialY(i+1,j) * (u * (T(1.0) - v))
+		+ nodePartialY(i,j+1) * ((T(1.0) - u) * v)
+		+ nodePartialY(i+1,j+1) * (u * v)
+	;
 }
 
-template <typename T, typename E>
-SquareGrid<T,E> SquareGrid<T,E>::partial_x() const {
-	// Define the grid new parameters.
-	unsigned newsizex = _sizex - 2;
-	unsigned newsizey = _sizey;
-	T newspacing = _spacing;
-	math::linear::StaticVector<T,2> one({static_cast<T>(1.0), 0.0});
-	math::linear::StaticVector<T,2> newstart = _start + _spacing * one;
+template <typename T, typename E, typename Layout, typename Storage>
+math::linear::StaticVector<E,2> SquareGrid<T,E,Layout,Storage>::evaluate_gradient(const math::linear::StaticVector<T,2>& coord) const {
+	unsigned i, j;
+	T u, v;
+	locateCell(coord, i, j, u, v);
 	
-	// Declare and initialize the grid.
-	SquareGrid<T,E> grid(newsizex, newsizey, newspacing, newstart);
+	// Weights of the cell corners, shared by both components.
+	T w00 = (T(1.0) - u) * (T(1.0) - v);
+	T w10 = u * (T(1.0) - v);
+	T w01 = (T(1.0) - u) * v;
+	T w11 = u * v;
 	
-	// Calculate central differences.
+	E xpartial = nodePartialX(i,j) * w00 + nodePartialX(i+1,j) * w10 + nodePartialX(i,j+1) * w01 + nodePartialX(i+1,j+1) * w11;
+	E ypartial = nodePartialY(i,j) * w00 + nodePartialY(i+1,j) * w10 + nodePartialY(i,j+1) * w01 + nodePartialY(i+1,j+1) * w11;
+	return math::linear::StaticVector<E,2>({xpartial, ypartial});
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+void SquareGrid<T,E,Layout,Storage>::evaluate_partial_x(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const {
+	math::index_t size = coords.size();
+	values.resize(size);
+	for (math::index_t k = 0; k < size; ++k) values[k] = evaluate_partial_x(coords[k]);
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+void SquareGrid<T,E,Layout,Storage>::evaluate_partial_y(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const {
+	math::index_t size = coords.size();
+	values.resize(size);
+	for (math::index_t k = 0; k < size; ++k) values[k] = evaluate_partial_y(coords[k]);
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+void SquareGrid<T,E,Layout,Storage>::evaluate_gradient(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<math::linear::StaticVector<E,2>>& values) const {
+	math::index_t size = coords.size();
+	values.resize(size);
+	for (math::index_t k = 0; k < size; ++k) values[k] = evaluate_gradient(coords[k]);
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+template <typename Grid>
+void SquareGrid<T,E,Layout,Storage>::fillPartialX(Grid& grid) const {
 	for (unsigned i = 1; i < _sizex-1; ++i) {
 		for (unsigned j = 0; j < _sizey; ++j) {
 			E diff = dataEvaluation(i+1,j) - dataEvaluation(i-1,j);
-			grid.dataEvaluation(i-1,j) = diff / newspacing / 2.0;
+			grid.dataEvaluation(i-1,j) = diff / _spacing / 2.0;
 		}
 	}
-	
-	// Return the partial_x grid.
-	return grid;
 }
 
-template <typename T, typename E>
-SquareGrid<T,E> SquareGrid<T,E>::partial_y() const {
-	// Define the grid new parameters.
-	unsigned newsizex = _sizex;
-	unsigned newsizey = _sizey-2;
-	T newspacing = _spacing;
-	math::linear::StaticVector<T,2> one({0.0, static_cast<T>(1.0)});
-	math::linear::StaticVector<T,2> newstart = _start + _spacing * one;
-	
-	// Declare and initialize the grid.
-	SquareGrid<T,E> grid(newsizex, newsizey, newspacing, newstart);
-	
-	// Calculate central differences.
+template <typename T, typename E, typename Layout, typename Storage>
+template <typename Grid>
+void SquareGrid<T,E,Layout,Storage>::fillPartialY(Grid& grid) const {
 	for (unsigned i = 0; i < _sizex; ++i) {
 		for (unsigned j = 1; j < _sizey-1; ++j) {
 			E diff = dataEvaluation(i,j+1) - dataEvaluation(i,j-1);
-			grid.dataEvaluation(i,j-1) = diff / newspacing / 2.0;
+			grid.dataEvaluation(i,j-1) = diff / _spacing / 2.0;
 		}
 	}
-	
-	// Return the partial_y grid.
-	return grid;
 }
 
-template <typename T, typename E>
-SquareGrid<T,math::linear::StaticVector<E,2>> SquareGrid<T,E>::gradient() const {
-	// Define the grid new parameters.
-	unsigned newsizex = _sizex-2;
-	unsigned newsizey = _sizey-2;
-	T newspacing = _spacing;
-	math::linear::StaticVector<T,2> one({static_cast<T>(1.0), static_cast<T>(1.0)});
-	math::linear::StaticVector<T,2> newstart = _start + _spacing * one;
-	
-	// Declare and initialize the grid.
-	SquareGrid<T,math::linear::StaticVector<E,2>> grid(newsizex, newsizey, newspacing, newstart);
-	
-	// Calculate central differences.
+template <typename T, typename E, typename Layout, typename Storage>
+template <typename Grid>
+void SquareGrid<T,E,Layout,Storage>::fillGradient(Grid& grid) const {
 	for (unsigned i = 1; i < _sizex-1; ++i) {
 		for (unsigned j = 1; j < _sizey-1; ++j) {
 			E xdiff = dataEvaluation(i+1,j) - dataEvaluation(i-1,j);
 			E ydiff = dataEvaluation(i,j+1) - dataEvaluation(i,j-1);
 			
-			E xpartial = xdiff / newspacing / 2.0;
-			E ypartial = ydiff / newspacing / 2.0;
+			E xpartial = xdiff / _spacing / 2.0;
+			E ypartial = ydiff / _spacing / 2.0;
 			
 			grid.dataEvaluation(i-1,j-1) = math::linear::StaticVector<E,2>({xpartial, ypartial});
 		}
 	}
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+SquareGrid<T,E,Layout,Storage> SquareGrid<T,E,Layout,Storage>::partial_x() const {
+	// Declare and initialize the grid, one spacing inside along x.
+	math::linear::StaticVector<T,2> one({static_cast<T>(1.0), 0.0});
+	SquareGrid<T,E,Layout,Storage> grid(_sizex-2, _sizey, _spacing, _start + _spacing * one);
+	
+	// Calculate central differences.
+	fillPartialX(grid);
+	return grid;
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+SquareGrid<T,E,Layout,Storage> SquareGrid<T,E,Layout,Storage>::partial_y() const {
+	// Declare and initialize the grid, one spacing inside along y.
+	math::linear::StaticVector<T,2> one({0.0, static_cast<T>(1.0)});
+	SquareGrid<T,E,Layout,Storage> grid(_sizex, _sizey-2, _spacing, _start + _spacing * one);
+	
+	// Calculate central differences.
+	fillPartialY(grid);
+	return grid;
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+SquareGrid<T,math::linear::StaticVector<E,2>,Layout,RebindStorage<Storage,math::linear::StaticVector<E,2>>> SquareGrid<T,E,Layout,Storage>::gradient() const {
+	// Declare and initialize the grid, one spacing inside along both axes.
+	math::linear::StaticVector<T,2> one({static_cast<T>(1.0), static_cast<T>(1.0)});
+	SquareGrid<T,math::linear::StaticVector<E,2>,Layout,RebindStorage<Storage,math::linear::StaticVector<E,2>>> grid(_sizex-2, _sizey-2, _spacing, _start + _spacing * one);
 	
-	// Return the gradient.
+	// Calculate central differences.
+	fillGradient(grid);
+	return grid;
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+SquareGrid<T,E,Layout,WorkspaceStorage<E>> SquareGrid<T,E,Layout,Storage>::partial_x(math::memory::Workspace& workspace) const {
+	math::linear::StaticVector<T,2> one({static_cast<T>(1.0), 0.0});
+	WorkspaceStorage<E> storage(workspace, Layout(_sizex-2, _sizey).size());
+	SquareGrid<T,E,Layout,WorkspaceStorage<E>> grid(_sizex-2, _sizey, _spacing, _start + _spacing * one, std::move(storage));
+	fillPartialX(grid);
+	return grid;
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+SquareGrid<T,E,Layout,WorkspaceStorage<E>> SquareGrid<T,E,Layout,Storage>::partial_y(math::memory::Workspace& workspace) const {
+	math::linear::StaticVector<T,2> one({0.0, static_cast<T>(1.0)});
+	WorkspaceStorage<E> storage(workspace, Layout(_sizex, _sizey-2).size());
+	SquareGrid<T,E,Layout,WorkspaceStorage<E>> grid(_sizex, _sizey-2, _spacing, _start + _spacing * one, std::move(storage));
+	fillPartialY(grid);
+	return grid;
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+SquareGrid<T,math::linear::StaticVector<E,2>,Layout,WorkspaceStorage<math::linear::StaticVector<E,2>>> SquareGrid<T,E,Layout,Storage>::gradient(math::memory::Workspace& workspace) const {
+	math::linear::StaticVector<T,2> one({static_cast<T>(1.0), static_cast<T>(1.0)});
+	WorkspaceStorage<math::linear::StaticVector<E,2>> storage(workspace, Layout(_sizex-2, _sizey-2).size());
+	SquareGrid<T,math::linear::StaticVector<E,2>,Layout,WorkspaceStorage<math::linear::StaticVector<E,2>>> grid(_sizex-2, _sizey-2, _spacing, _start + _spacing * one, std::move(storage));
+	fillGradient(grid);
 	return grid;
 }
 
@@ -0,0 +1,228 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <math/index.hpp>
+#include <math/linear/static_vector.hpp>
+
+namespace math {
+namespace function {
+
+// Non-owning rectangular view of a grid.
+// Point (i,j) of the view is point (i0 + i*stride, j0 + j*stride) of the viewed grid, so
+// a view is a sub-grid, possibly subsampled, with its own start and spacing in world
+// coordinates. Nothing is copied: reads and writes go to the viewed grid, which must
+// outlive the view. Views of const grids are read only.
+// Views provide the accessors and interpolation of SquareGrid, so the exporters,
+// reductions, differential operators and solvers taking any grid accept them too.
+template <typename Grid>
+class SquareGridView {
+public:
+	using T = typename std::decay<decltype(std::declval<const Grid&>().spacing())>::type;
+	using E = typename std::decay<decltype(std::declval<const Grid&>().dataEvaluation(0,0))>::type;
+
+private:
+	Grid* _grid;
+	unsigned _i0;
+	unsigned _j0;
+	unsigned _sizex;
+	unsigned _sizey;
+	unsigned _stride;
+
+	void locateCell(const math::linear::StaticVector<T,2>& coord, unsigned& i, unsigned& j, T& u, T& v) const;
+
+	// Finite differences at view points. One sided at the edges of the view.
+	E nodePartialX(unsigned i, unsigned j) const;
+	E nodePartialY(unsigned i, unsigned j) const;
+
+public:
+	SquareGridView(Grid& grid, unsigned i0, unsigned j0, unsigned sizex, unsigned sizey, unsigned stride = 1);
+
+	// Accessor functions
+	inline unsigned sizex() const {return _sizex;}
+	inline unsigned sizey() const {return _sizey;}
+	inline unsigned offsetx() const {return _i0;}
+	inline unsigned offsety() const {return _j0;}
+	inline unsigned stride() const {return _stride;}
+	inline Grid& grid() const {return *_grid;}
+	inline T spacing() const {return _grid->spacing() * static_cast<T>(_stride);}
+	inline math::linear::StaticVector<T,2> start() const {return _grid->domainfromij(_i0, _j0);}
+	inline math::linear::StaticVector<T,2> end() const {return _grid->domainfromij(_i0 + (_sizex-1) * _stride, _j0 + (_sizey-1) * _stride);}
+
+	// Transfer from view ij-coordinates to the domain.
+	inline math::linear::StaticVector<T,2> domainfromij(unsigned i, unsigned j) const {return _grid->domainfromij(_i0 + i*_stride, _j0 + j*_stride);}
+
+	// Evaluation at grid points.
+	inline auto dataEvaluation(unsigned i, unsigned j) const -> decltype(std::declval<const Grid&>().dataEvaluation(0,0)) {
+		return static_cast<const Grid&>(*_grid).dataEvaluation(_i0 + i*_stride, _j0 + j*_stride);
+	}
+
+	inline auto dataEvaluation(unsigned i, unsigned j) -> decltype(std::declval<Grid&>().dataEvaluation(0,0)) {
+		return _grid->dataEvaluation(_i0 + i*_stride, _j0 + j*_stride);
+	}
+
+	// Interpolated evaluation.
+	E evaluate(const math::linear::StaticVector<T,2>& coord) const;
+	E operator()(const math::linear::StaticVector<T,2>& coord) const;
+	E evaluate(const T& x, const T& y) const;
+	E operator()(const T& x, const T& y) const;
+	void evaluate(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const;
+
+	// Partial derivative and gradient operators.
+	E evaluate_partial_x(const math::linear::StaticVector<T,2>& coord) const;
+	E evaluate_partial_y(const math::linear::StaticVector<T,2>& coord) const;
+	math::linear::StaticVector<E,2> evaluate_gradient(const math::linear::StaticVector<T,2>& coord) const;
+	void evaluate_gradient(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<math::linear::StaticVector<E,2>>& values) const;
+};
+
+// View of grid points [i0, i0 + (sizex-1)*stride] x [j0, j0 + (sizey-1)*stride].
+template <typename Grid>
+SquareGridView<Grid> gridView(Grid& grid, unsigned i0, unsigned j0, unsigned sizex, unsigned sizey, unsigned stride = 1) {
+	return SquareGridView<Grid>(grid, i0, j0, sizex, sizey, stride);
+}
+
+
+template <typename Grid>
+SquareGridView<Grid>::SquareGridView(Grid& grid, unsigned i0, unsigned j0, unsigned sizex, unsigned sizey, unsigned stride)
+: _grid(&grid), _i0(i0), _j0(j0), _sizex(sizex), _sizey(sizey), _stride(stride) {
+	if (stride == 0) throw std::invalid_argument("The view stride must be positive.");
+	if (sizex == 0 or sizey == 0) throw std::invalid_argument("Views need at least one point.");
+	if (i0 + (sizex-1) * stride >= grid.sizex()) throw std::invalid_argument("View outside of the grid.");
+	if (j0 + (sizey-1) * stride >= grid.sizey()) throw std::invalid_argument("View outside of the grid.");
+}
+
+template <typename Grid>
+void SquareGridView<Grid>::locateCell(const math::linear::StaticVector<T,2>& coord, unsigned& i, unsigned& j, T& u, T& v) const {
+	if (_sizex < 2 or _sizey < 2) throw std::invalid_argument("Interpolation needs at least 2x2 grid points.");
+
+	// Check limits to verify if we are inside domain.
+	math::linear::StaticVector<T,2> first = start();
+	math::linear::StaticVector<T,2> last = end();
+	if (coord.x() < first.x()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.y() < first.y()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.x() > last.x()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.y() > last.y()) throw std::invalid_argument("Outside of domain of the function.");
+
+	// Get left down corner point of the cell. Points on the upper edges belong to the last cell.
+	T step = spacing();
+	T x = (coord.x() - first.x()) / step;
+	T y = (coord.y() - first.y()) / step;
+	i = std::min(static_cast<unsigned>(std::floor(x)), _sizex-2);
+	j = std::min(static_cast<unsigned>(std::floor(y)), _sizey-2);
+
+	// Local coordinates inside the cell, in [0,1].
+	u = x - static_cast<T>(i);
+	v = y - static_cast<T>(j);
+}
+
+template <typename Grid>
+typename SquareGridView<Grid>::E SquareGridView<Grid>::nodePartialX(unsigned i, unsigned j) const {
+	T step = spacing();
+	if (i == 0) return (dataEvaluation(1,j) - dataEvaluation(0,j)) / step;
+	if (i == _sizex-1) return (dataEvaluation(i,j) - dataEvaluation(i-1,j)) / step;
+	return (dataEvaluation(i+1,j) - dataEvaluation(i-1,j)) / step / T(2.0);
+}
+
+template <typename Grid>
+typename SquareGridView<Grid>::E SquareGridView<Grid>::nodePartialY(unsigned i, unsigned j) const {
+	T step = spacing();
+	if (j == 0) return (dataEvaluation(i,1) - dataEvaluation(i,0)) / step;
+	if (j == _sizey-1) return (dataEvaluation(i,j) - dataEvaluation(i,j-1)) / step;
+	return (dataEvaluation(i,j+1) - dataEvaluation(i,j-1)) / step / T(2.0);
+}
+
+template <typename Grid>
+typename SquareGridView<Grid>::E SquareGridView<Grid>::evaluate(const math::linear::StaticVector<T,2>& coord) const {
+	unsigned i, j;
+	T u, v;
+	locateCell(coord, i, j, u, v);
+
+	return
+		+ dataEvaluation(i,j) * ((T(1.0) - u) * (T(1.0) - v))
+		+ dataEvaluation(i+1,j) * (u * (T(1.0) - v))
+		+ dataEvaluation(i,j+1) * ((T(1.0) - u) * v)
+		+ dataEvaluation(i+1,j+1) * (u * v)
+	;
+}
+
+template <typename Grid>
+typename SquareGridView<Grid>::E SquareGridView<Grid>::operator()(const math::linear::StaticVector<T,2>& coord) const {
+	return evaluate(coord);
+}
+
+template <typename Grid>
+typename SquareGridView<Grid>::E SquareGridView<Grid>::evaluate(const T& x, const T& y) const {
+	return evaluate(math::linear::StaticVector<T,2>({x, y}));
+}
+
+template <typename Grid>
+typename SquareGridView<Grid>::E SquareGridView<Grid>::operator()(const T& x, const T& y) const {
+	return evaluate(math::linear::StaticVector<T,2>({x, y}));
+}
+
+template <typename Grid>
+void SquareGridView<Grid>::evaluate(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<E>& values) const {
+	math::index_t size = coords.size();
+	values.resize(size);
+	for (math::index_t k = 0; k < size; ++k) values[k] = evaluate(coords[k]);
+}
+
+template <typename Grid>
+typename SquareGridView<Grid>::E SquareGridView<Grid>::evaluate_partial_x(const math::linear::StaticVector<T,2>& coord) const {
+	unsigned i, j;
+	T u, v;
+	locateCell(coord, i, j, u, v);
+
+	// Bilinear interpolation of the central differences at the cell corners.
+	return
+		+ nodePartialX(i,j) * ((T(1.0) - u) * (T(1.0) - v))
+		+ nodePartialX(i+1,j) * (u * (T(1.0) - v))
+		+ nodePartialX(i,j+1) * ((T(1.0) - u) * v)
+		+ nodePartialX(i+1,j+1) * (u * v)
+	;
+}
+
+template <typename Grid>
+typename SquareGridView<Grid>::E SquareGridView<Grid>::evaluate_partial_y(const math::linear::StaticVector<T,2>& coord) const {
+	unsigned i, j;
+	T u, v;
+	locateCell(coord, i, j, u, v);
+
+	// Bilinear interpolation of the central differences at the cell corners.
+	return
+		+ nodePartialY(i,j) * ((T(1.0) - u) * (T(1.0) - v))
+		+ nodePartialY(i+1,j) * (u * (T(1.0) - v))
+		+ nodePartialY(i,j+1) * ((T(1.0) - u) * v)
+		+ nodePartialY(i+1,j+1) * (u * v)
+	;
+}
+
+template <typename Grid>
+math::linear::StaticVector<typename SquareGridView<Grid>::E,2> SquareGridView<Grid>::evaluate_gradient(const math::linear::StaticVector<T,2>& coord) const {
+	unsigned i, j;
+	T u, v;
+	locateCell(coord, i, j, u, v);
+
+	// Weights of the cell corners, shared by both components.
+	T w00 = (T(1.0) - u) * (T(1.0) - v);
+	T w10 = u * (T(1.0) - v);
+	T w01 = (T(1.0) - u) * v;
+	T w11 = u * v;
+
+	E xpartial = nodePartialX(i,j) * w00 + nodePartialX(i+1,j) * w10 + nodePartialX(i,j+1) * w01 + nodePartialX(i+1,j+1) * w11;
+	E ypartial = nodePartialY(i,j) * w00 + nodePartialY(i+1,j) * w10 + nodePartialY(i,j+1) * w01 + nodePartialY(i+1,j+1) * w11;
+	return math::linear::StaticVector<E,2>({xpartial, ypartial});
+}
+
+template <typename Grid>
+void SquareGridView<Grid>::evaluate_gradient(const std::vector<math::linear::StaticVector<T,2>>& coords, std::vector<math::linear::StaticVector<E,2>>& values) const {
+	math::index_t size = coords.size();
+	values.resize(size);
+	for (math::index_t k = 0; k < size; ++k) values[k] = evaluate_gradient(coords[k]);
+}
+
+}	// Namespace function.
+}	// Namespace math.
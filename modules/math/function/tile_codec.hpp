@@ -0,0 +1,310 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+namespace math {
+namespace function {
+namespace codec {
+
+// Adaptive binary range coder, with 11 bit probabilities (the LZMA scheme).
+class RangeEncoder {
+	std::vector<std::uint8_t>& _output;
+	std::uint64_t _low;
+	std::uint32_t _range;
+	std::uint8_t _cache;
+	std::uint64_t _cachesize;
+
+	void shiftLow() {
+		if (static_cast<std::uint32_t>(_low) < 0xFF000000u  or  (_low >> 32) != 0) {
+			std::uint8_t carry = static_cast<std::uint8_t>(_low >> 32);
+			std::uint8_t temp = _cache;
+			do {
+				_output.push_back(static_cast<std::uint8_t>(temp + carry));
+				temp = 0xFF;
+			} while (--_cachesize != 0);
+			_cache = static_cast<std::uint8_t>(static_cast<std::uint32_t>(_low) >> 24);
+		}
+
+		++_cachesize;
+		_low = (_low & 0x00FFFFFFu) << 8;
+	}
+
+public:
+	explicit RangeEncoder(std::vector<std::uint8_t>& output) : _output(output), _low(0), _range(0xFFFFFFFFu), _cache(0), _cachesize(1) {}
+
+	void encodeBit(std::uint16_t& probability, unsigned bit) {
+		std::uint32_t bound = (_range >> 11) * probability;
+		if (bit == 0) {
+			_range = bound;
+			probability += (2048 - probability) >> 5;
+		} else {
+			_low += bound;
+			_range -= bound;
+			probability -= probability >> 5;
+		}
+
+		while (_range < (1u << 24)) {
+			_range <<= 8;
+			shiftLow();
+		}
+	}
+
+	void flush() {
+		for (unsigned k = 0; k < 5; ++k) shiftLow();
+	}
+};
+
+
+class RangeDecoder {
+	const std::uint8_t* _input;
+	const std::uint8_t* _end;
+	std::uint32_t _range;
+	std::uint32_t _code;
+
+	std::uint8_t next() {
+		if (_input == _end) throw std::runtime_error("Truncated compressed tile.");
+		return *_input++;
+	}
+
+public:
+	RangeDecoder(const std::uint8_t* input, std::size_t size) : _input(input), _end(input + size), _range(0xFFFFFFFFu), _code(0) {
+		for (unsigned k = 0; k < 5; ++k) _code = (_code << 8) | next();
+	}
+
+	unsigned decodeBit(std::uint16_t& probability) {
+		std::uint32_t bound = (_range >> 11) * probability;
+		unsigned bit;
+		if (_code < bound) {
+			_range = bound;
+			probability += (2048 - probability) >> 5;
+			bit = 0;
+		} else {
+			_code -= bound;
+			_range -= bound;
+			probability -= probability >> 5;
+			bit = 1;
+		}
+
+		while (_range < (1u << 24)) {
+			_range <<= 8;
+			_code = (_code << 8) | next();
+		}
+
+		return bit;
+	}
+};
+
+
+// Adaptive model for 64 bit residuals: the number of significant bytes, in the context
+// of the previous one, then each byte with its own bit tree.
+class ResidualModel {
+	std::uint16_t _lengths[10][16];
+	std::uint16_t _bytes[8][256];
+	unsigned _previous;
+
+public:
+	ResidualModel() : _previous(0) {
+		for (auto& context : _lengths) for (auto& p : context) p = 1024;
+		for (auto& context : _bytes) for (auto& p : context) p = 1024;
+	}
+
+	void encode(RangeEncoder& encoder, std::uint64_t value) {
+		unsigned length = 0;
+		while (length < 8  and  (value >> (8*length)) != 0) ++length;
+
+		unsigned node = 1;
+		for (int bit = 3; bit >= 0; --bit) {
+			unsigned b = (length >> bit) & 1;
+			encoder.encodeBit(_lengths[_previous][node], b);
+			node = (node << 1) | b;
+		}
+
+		for (unsigned k = 0; k < length; ++k) {
+			unsigned byte = static_cast<unsigned>(value >> (8*k)) & 0xFF;
+			node = 1;
+			for (int bit = 7; bit >= 0; --bit) {
+				unsigned b = (byte >> bit) & 1;
+				encoder.encodeBit(_bytes[k][node], b);
+				node = (node << 1) | b;
+			}
+		}
+
+		_previous = length;
+	}
+
+	std::uint64_t decode(RangeDecoder& decoder) {
+		unsigned node = 1;
+		for (unsigned bit = 0; bit < 4; ++bit) node = (node << 1) | decoder.decodeBit(_lengths[_previous][node]);
+		unsigned length = node - 16;
+		if (length > 8) throw std::runtime_error("Corrupted compressed tile.");
+
+		std::uint64_t value = 0;
+		for (unsigned k = 0; k < length; ++k) {
+			node = 1;
+			for (unsigned bit = 0; bit < 8; ++bit) node = (node << 1) | decoder.decodeBit(_bytes[k][node]);
+			value |= static_cast<std::uint64_t>(node - 256) << (8*k);
+		}
+
+		_previous = length;
+		return value;
+	}
+};
+
+
+// Unsigned integers with the same bits as a floating point type, ordered like the values.
+template <typename E> struct FloatBits;
+template <> struct FloatBits<float> {using type = std::uint32_t;};
+template <> struct FloatBits<double> {using type = std::uint64_t;};
+
+template <typename E>
+typename FloatBits<E>::type orderedBits(E value) {
+	using U = typename FloatBits<E>::type;
+	U bits;
+	std::memcpy(&bits, &value, sizeof(E));
+	U sign = U(1) << (8*sizeof(U) - 1);
+	return (bits & sign) ? static_cast<U>(~bits) : static_cast<U>(bits | sign);
+}
+
+template <typename E>
+E fromOrderedBits(typename FloatBits<E>::type bits) {
+	using U = typename FloatBits<E>::type;
+	U sign = U(1) << (8*sizeof(U) - 1);
+	bits = (bits & sign) ? static_cast<U>(bits & ~sign) : static_cast<U>(~bits);
+	E value;
+	std::memcpy(&value, &bits, sizeof(E));
+	return value;
+}
+
+// Signed residuals folded to unsigned: 0, -1, 1, -2, 2...
+template <typename U>
+std::uint64_t zigzag(U difference) {
+	using S = typename std::make_signed<U>::type;
+	S value = static_cast<S>(difference);
+	return (value < 0) ? ((static_cast<std::uint64_t>(~static_cast<U>(value)) << 1) | 1) : (static_cast<std::uint64_t>(value) << 1);
+}
+
+template <typename U>
+U unzigzag(std::uint64_t value) {
+	return (value & 1) ? static_cast<U>(~static_cast<U>(value >> 1)) : static_cast<U>(value >> 1);
+}
+
+// Lorenzo predictor on a row-major tile: west + north - northwest.
+template <typename V>
+V lorenzo(const V* values, unsigned i, unsigned j, unsigned width) {
+	if (i == 0  and  j == 0) return V(0);
+	if (j == 0) return values[i-1];
+	if (i == 0) return values[(j-1)*width];
+	return static_cast<V>(values[j*width + i-1] + values[(j-1)*width + i] - values[(j-1)*width + i-1]);
+}
+
+
+// Lossless tile compression of floating point values, row-major in a width x height tile.
+// The prediction runs on the ordered integer bits, so it is exact and platform independent.
+template <typename E>
+void compressLossless(const E* values, unsigned width, unsigned height, std::vector<std::uint8_t>& output) {
+	using U = typename FloatBits<E>::type;
+	std::vector<U> bits(static_cast<std::size_t>(width) * height);
+	for (std::size_t k = 0; k < bits.size(); ++k) bits[k] = orderedBits(values[k]);
+
+	RangeEncoder encoder(output);
+	ResidualModel model;
+	for (unsigned j = 0; j < height; ++j) {
+		for (unsigned i = 0; i < width; ++i) {
+			U prediction = lorenzo(bits.data(), i, j, width);
+			model.encode(encoder, zigzag<U>(static_cast<U>(bits[j*width + i] - prediction)));
+		}
+	}
+
+	encoder.flush();
+}
+
+template <typename E>
+void decompressLossless(const std::uint8_t* input, std::size_t size, unsigned width, unsigned height, E* values) {
+	using U = typename FloatBits<E>::type;
+	std::vector<U> bits(static_cast<std::size_t>(width) * height);
+
+	RangeDecoder decoder(input, size);
+	ResidualModel model;
+	for (unsigned j = 0; j < height; ++j) {
+		for (unsigned i = 0; i < width; ++i) {
+			U prediction = lorenzo(bits.data(), i, j, width);
+			bits[j*width + i] = static_cast<U>(prediction + unzigzag<U>(model.decode(decoder)));
+		}
+	}
+
+	for (std::size_t k = 0; k < bits.size(); ++k) values[k] = fromOrderedBits<E>(bits[k]);
+}
+
+
+// Error bounded lossy tile compression: every decompressed value is within bound of the
+// original. Residuals of the prediction from already reconstructed values are quantized
+// in steps of 2*bound. Values that can not be quantized are stored exactly.
+template <typename E>
+void compressLossy(const E* values, unsigned width, unsigned height, E bound, std::vector<std::uint8_t>& output) {
+	using U = typename FloatBits<E>::type;
+	std::vector<E> reconstructed(static_cast<std::size_t>(width) * height);
+	E step = E(2) * bound;
+
+	RangeEncoder encoder(output);
+	ResidualModel model;
+	for (unsigned j = 0; j < height; ++j) {
+		for (unsigned i = 0; i < width; ++i) {
+			std::size_t k = static_cast<std::size_t>(j)*width + i;
+			E prediction = lorenzo(reconstructed.data(), i, j, width);
+			E quotient = std::round((values[k] - prediction) / step);
+
+			// Zero codes an escape to the exact value.
+			bool quantized = std::isfinite(quotient)  and  std::abs(quotient) < E(1e15);
+			if (quantized) {
+				E value = prediction + quotient * step;
+				quantized = std::abs(value - values[k]) <= bound;
+				if (quantized) {
+					std::int64_t q = static_cast<std::int64_t>(quotient);
+					model.encode(encoder, zigzag<std::uint64_t>(static_cast<std::uint64_t>(q)) + 1);
+					reconstructed[k] = value;
+				}
+			}
+
+			if (not quantized) {
+				model.encode(encoder, 0);
+				U bits;
+				std::memcpy(&bits, &values[k], sizeof(E));
+				model.encode(encoder, bits);
+				reconstructed[k] = values[k];
+			}
+		}
+	}
+
+	encoder.flush();
+}
+
+template <typename E>
+void decompressLossy(const std::uint8_t* input, std::size_t size, unsigned width, unsigned height, E bound, E* values) {
+	using U = typename FloatBits<E>::type;
+	E step = E(2) * bound;
+
+	RangeDecoder decoder(input, size);
+	ResidualModel model;
+	for (unsigned j = 0; j < height; ++j) {
+		for (unsigned i = 0; i < width; ++i) {
+			std::size_t k = static_cast<std::size_t>(j)*width + i;
+			std::uint64_t code = model.decode(decoder);
+			if (code == 0) {
+				U bits = static_cast<U>(model.decode(decoder));
+				std::memcpy(&values[k], &bits, sizeof(E));
+			} else {
+				E prediction = lorenzo(values, i, j, width);
+				std::int64_t q = static_cast<std::int64_t>(unzigzag<std::uint64_t>(code - 1));
+				values[k] = prediction + static_cast<E>(q) * step;
+			}
+		}
+	}
+}
+
+}	// Namespace codec.
+}	// Namespace function.
+}	// Namespace math.
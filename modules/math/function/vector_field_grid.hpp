@@ -0,0 +1,228 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <stdexcept>
+#include <math/linear/static_vector.hpp>
+#include <math/memory/aligned_allocator.hpp>
+#include <math/function/grid_layout.hpp>
+#include <math/function/square_grid.hpp>
+#include <math/parallel/parallel_for.hpp>
+
+namespace math {
+namespace function {
+
+// Contiguous run of values of one component, in storage order.
+template <typename S>
+class ComponentSpan {
+	S* _data;
+	math::index_t _size;
+
+public:
+	ComponentSpan(S* data, math::index_t size) : _data(data), _size(size) {}
+
+	inline S* data() const {return _data;}
+	inline math::index_t size() const {return _size;}
+	inline S* begin() const {return _data;}
+	inline S* end() const {return _data + _size;}
+	inline S& operator[](math::index_t k) const {return _data[k];}
+};
+
+
+// Grid of D-dimensional vectors stored as structure of arrays.
+// Every component lives in its own plane, a cache-line aligned array in the order given
+// by the layout, padded to whole cache lines. Passes over a single component only read
+// that plane, and loops over the component spans vectorise.
+// Accessors taking or returning StaticVector gather or scatter the components.
+template <typename T, typename E=T, unsigned D=2, typename Layout=RowMajorLayout>
+class VectorFieldGrid {
+public:
+	using Plane = std::vector<E, math::memory::AlignedAllocator<E, 64>>;
+
+private:
+	// Domain information.
+	unsigned _sizex;
+	unsigned _sizey;
+	T _spacing;
+	math::linear::StaticVector<T,2> _start;
+
+	// Memory layout of each plane.
+	Layout _layout;
+	math::index_t _size;
+
+	// One plane per component.
+	Plane _planes[D];
+
+public:
+	// Constructor functions
+	VectorFieldGrid(unsigned sizex, unsigned sizey, const T& spacing, math::linear::StaticVector<T,2> start = math::linear::StaticVector<T,2>());
+
+	// Conversion from any grid of StaticVector<E,D>, such as SquareGrid::gradient().
+	template <typename Grid>
+	explicit VectorFieldGrid(const Grid& grid);
+
+	// Accessor functions
+	inline unsigned sizex() const {return _sizex;}
+	inline unsigned sizey() const {return _sizey;}
+	inline const T& spacing() const {return _spacing;}
+	inline const math::linear::StaticVector<T,2>& start() const {return _start;}
+	inline const Layout& layout() const {return _layout;}
+	inline math::linear::StaticVector<T,2> end() const {return _start + _spacing * math::linear::StaticVector<T,2>({static_cast<T>(_sizex-1), static_cast<T>(_sizey-1)});}
+
+	// Transfer from ij-coordinates to the plane and domain coordinates.
+	inline math::index_t datafromij(unsigned i, unsigned j) const {return _layout.index(i, j);}
+	math::linear::StaticVector<T,2> domainfromij(unsigned i, unsigned j) const;
+
+	// Component planes. Spans cover the whole plane in storage order, padding included.
+	ComponentSpan<E> component(unsigned c);
+	ComponentSpan<const E> component(unsigned c) const;
+	inline E& component(unsigned c, unsigned i, unsigned j) {return _planes[c][datafromij(i,j)];}
+	inline const E& component(unsigned c, unsigned i, unsigned j) const {return _planes[c][datafromij(i,j)];}
+
+	// Evaluation at grid points.
+	math::linear::StaticVector<E,D> dataEvaluation(unsigned i, unsigned j) const;
+	void setData(unsigned i, unsigned j, const math::linear::StaticVector<E,D>& value);
+
+	// Interpolated evaluation.
+	math::linear::StaticVector<E,D> evaluate(const math::linear::StaticVector<T,2>& coord) const;
+	math::linear::StaticVector<E,D> operator()(const math::linear::StaticVector<T,2>& coord) const;
+	math::linear::StaticVector<E,D> evaluate(const T& x, const T& y) const;
+
+	// Euclidean norm of the vectors.
+	SquareGrid<T,E,Layout> magnitude(unsigned threads = 1) const;
+};
+
+
+template <typename T, typename E, unsigned D, typename Layout>
+VectorFieldGrid<T,E,D,Layout>::VectorFieldGrid(unsigned sizex, unsigned sizey, const T& spacing, math::linear::StaticVector<T,2> start)
+: _sizex(sizex), _sizey(sizey), _spacing(spacing), _start(start), _layout(sizex, sizey), _size(_layout.size()) {
+	// Pad to whole cache lines, so vector loops need no scalar tail on aligned planes.
+	unsigned line = (64 >= sizeof(E)) ? 64 / sizeof(E) : 1;
+	math::index_t padded = (_size + line - 1) / line * line;
+	for (unsigned c = 0; c < D; ++c) _planes[c].assign(padded, E());
+}
+
+template <typename T, typename E, unsigned D, typename Layout>
+template <typename Grid>
+VectorFieldGrid<T,E,D,Layout>::VectorFieldGrid(const Grid& grid)
+: VectorFieldGrid(grid.sizex(), grid.sizey(), grid.spacing(), grid.start()) {
+	for (unsigned j = 0; j < _sizey; ++j) {
+		for (unsigned i = 0; i < _sizex; ++i) setData(i, j, grid.dataEvaluation(i,j));
+	}
+}
+
+template <typename T, typename E, unsigned D, typename Layout>
+math::linear::StaticVector<T,2> VectorFieldGrid<T,E,D,Layout>::domainfromij(unsigned i, unsigned j) const {
+	return math::linear::StaticVector<T,2>({
+		_start.x() + static_cast<T>(i) * _spacing,
+		_start.y() + static_cast<T>(j) * _spacing
+	});
+}
+
+template <typename T, typename E, unsigned D, typename Layout>
+ComponentSpan<E> VectorFieldGrid<T,E,D,Layout>::component(unsigned c) {
+	if (c >= D) throw std::invalid_argument("Component out of range.");
+	return ComponentSpan<E>(_planes[c].data(), _size);
+}
+
+template <typename T, typename E, unsigned D, typename Layout>
+ComponentSpan<const E> VectorFieldGrid<T,E,D,Layout>::component(unsigned c) const {
+	if (c >= D) throw std::invalid_argument("Component out of range.");
+	return ComponentSpan<const E>(_planes[c].data(), _size);
+}
+
+template <typename T, typename E, unsigned D, typename Layout>
+math::linear::StaticVector<E,D> VectorFieldGrid<T,E,D,Layout>::dataEvaluation(unsigned i, unsigned j) const {
+	math::index_t k = datafromij(i,j);
+	math::linear::StaticVector<E,D> value;
+	for (unsigned c = 0; c < D; ++c) value[c] = _planes[c][k];
+	return value;
+}
+
+template <typename T, typename E, unsigned D, typename Layout>
+void VectorFieldGrid<T,E,D,Layout>::setData(unsigned i, unsigned j, const math::linear::StaticVector<E,D>& value) {
+	math::index_t k = datafromij(i,j);
+	for (unsigned c = 0; c < D; ++c) _planes[c][k] = value[c];
+}
+
+template <typename T, typename E, unsigned D, typename Layout>
+math::linear::StaticVector<E,D> VectorFieldGrid<T,E,D,Layout>::evaluate(const math::linear::StaticVector<T,2>& coord) const {
+	// Check limits to verify if we are inside domain.
+	if (coord.x() < start().x()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.y() < start().y()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.x() > end().x()) throw std::invalid_argument("Outside of domain of the function.");
+	if (coord.y() > end().y()) throw std::invalid_argument("Outside of domain of the function.");
+
+	T x = (coord.x() - _start.x()) / _spacing;
+	T y = (coord.y() - _start.y()) / _spacing;
+	unsigned i = std::min(static_cast<unsigned>(std::floor(x)), _sizex-2);
+	unsigned j = std::min(static_cast<unsigned>(std::floor(y)), _sizey-2);
+	T u = x - static_cast<T>(i);
+	T v = y - static_cast<T>(j);
+
+	// Bilinear interpolation, plane by plane.
+	math::index_t k00 = datafromij(i,j), k10 = datafromij(i+1,j);
+	math::index_t k01 = datafromij(i,j+1), k11 = datafromij(i+1,j+1);
+	math::linear::StaticVector<E,D> value;
+	for (unsigned c = 0; c < D; ++c) {
+		const Plane& plane = _planes[c];
+		E bottom = plane[k00] * (T(1.0) - u) + plane[k10] * u;
+		E top = plane[k01] * (T(1.0) - u) + plane[k11] * u;
+		value[c] = bottom * (T(1.0) - v) + top * v;
+	}
+
+	return value;
+}
+
+template <typename T, typename E, unsigned D, typename Layout>
+math::linear::StaticVector<E,D> VectorFieldGrid<T,E,D,Layout>::operator()(const math::linear::StaticVector<T,2>& coord) const {
+	return evaluate(coord);
+}
+
+template <typename T, typename E, unsigned D, typename Layout>
+math::linear::StaticVector<E,D> VectorFieldGrid<T,E,D,Layout>::evaluate(const T& x, const T& y) const {
+	return evaluate(math::linear::StaticVector<T,2>({x, y}));
+}
+
+template <typename T, typename E, unsigned D, typename Layout>
+SquareGrid<T,E,Layout> VectorFieldGrid<T,E,D,Layout>::magnitude(unsigned threads) const {
+	// Same layout, so the output is filled in storage order, straight from the planes.
+	SquareGrid<T,E,Layout> grid(_sizex, _sizey, _spacing, _start);
+	E* output = &grid.storage()[0];
+	math::parallel::parallelFor(0, _size, threads, [&](math::index_t first, math::index_t last) {
+		for (math::index_t k = first; k < last; ++k) {
+			E sum = E();
+			for (unsigned c = 0; c < D; ++c) sum += _planes[c][k] * _planes[c][k];
+			output[k] = std::sqrt(sum);
+		}
+	});
+
+	return grid;
+}
+
+
+// Gradient of a scalar field into a vector field grid. Covers the interior of phi, like
+// SquareGrid::gradient(): sizes (sizex-2, sizey-2), started one spacing inside.
+template <typename Grid, typename T, typename E, typename Layout>
+void gradient(const Grid& phi, VectorFieldGrid<T,E,2,Layout>& output, unsigned threads = 1) {
+	if (phi.sizex() < 3 or phi.sizey() < 3) throw std::invalid_argument("Grid too small for central differences.");
+	if (output.sizex() != phi.sizex()-2) throw std::invalid_argument("Output grid has the wrong size.");
+	if (output.sizey() != phi.sizey()-2) throw std::invalid_argument("Output grid has the wrong size.");
+
+	unsigned sx = phi.sizex();
+	T halfinverse = T(1.0) / (T(2.0) * phi.spacing());
+	ComponentSpan<E> xplane = output.component(0);
+	ComponentSpan<E> yplane = output.component(1);
+
+	math::parallel::parallelFor(1, phi.sizey()-1, threads, [&](unsigned first, unsigned last) {
+		for (unsigned j = first; j < last; ++j) {
+			for (unsigned i = 1; i < sx-1; ++i) {
+				math::index_t k = output.datafromij(i-1,j-1);
+				xplane[k] = (phi.dataEvaluation(i+1,j) - phi.dataEvaluation(i-1,j)) * halfinverse;
+				yplane[k] = (phi.dataEvaluation(i,j+1) - phi.dataEvaluation(i,j-1)) * halfinverse;
+			}
+		}
+	});
+}
+
+}	// Namespace function.
+}	// Namespace math.
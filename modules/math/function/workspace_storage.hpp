@@ -0,0 +1,83 @@
+#pragma once
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <math/index.hpp>
+#include <math/memory/workspace.hpp>
+
+namespace math {
+namespace function {
+
+// Storage backend borrowing its values from a Workspace.
+// The buffer goes back to the workspace when the storage is destroyed, so temporary
+// grids built over and over reuse the same memory. Values of trivially constructible types
+// start with whatever the buffer held, as users overwrite them; others are value-initialised.
+// The storage is movable, not copyable, and must not outlive its workspace.
+template <typename E>
+class WorkspaceStorage {
+	math::memory::Workspace* _workspace;
+	E* _data;
+	math::index_t _size;
+
+	void destroy();
+
+public:
+	using value_type = E;
+	using reference = E&;
+	using const_reference = const E&;
+
+	WorkspaceStorage(math::memory::Workspace& workspace, math::index_t size);
+	WorkspaceStorage(const WorkspaceStorage&) = delete;
+	WorkspaceStorage& operator=(const WorkspaceStorage&) = delete;
+	WorkspaceStorage(WorkspaceStorage&& other);
+	WorkspaceStorage& operator=(WorkspaceStorage&& other);
+	~WorkspaceStorage() {destroy();}
+
+	// Accessor functions.
+	inline math::index_t size() const {return _size;}
+	inline const E* data() const {return _data;}
+	inline E* data() {return _data;}
+	inline const E& operator[](math::index_t i) const {return _data[i];}
+	inline E& operator[](math::index_t i) {return _data[i];}
+	inline math::memory::Workspace& workspace() const {return *_workspace;}
+};
+
+
+template <typename E>
+WorkspaceStorage<E>::WorkspaceStorage(math::memory::Workspace& workspace, math::index_t size)
+: _workspace(&workspace), _data(static_cast<E*>(workspace.acquire(static_cast<std::size_t>(size) * sizeof(E)))), _size(size) {
+	if (std::is_trivially_default_constructible<E>::value) return;
+	for (math::index_t k = 0; k < _size; ++k) new (_data + k) E();
+}
+
+template <typename E>
+WorkspaceStorage<E>::WorkspaceStorage(WorkspaceStorage&& other) : _workspace(other._workspace), _data(other._data), _size(other._size) {
+	other._data = nullptr;
+	other._size = 0;
+}
+
+template <typename E>
+WorkspaceStorage<E>& WorkspaceStorage<E>::operator=(WorkspaceStorage&& other) {
+	if (this != &other) {
+		destroy();
+		_workspace = other._workspace;
+		_data = other._data;
+		_size = other._size;
+		other._data = nullptr;
+		other._size = 0;
+	}
+
+	return *this;
+}
+
+template <typename E>
+void WorkspaceStorage<E>::destroy() {
+	if (_data == nullptr) return;
+	for (math::index_t k = 0; k < _size; ++k) _data[k].~E();
+	_workspace->release(_data);
+	_data = nullptr;
+	_size = 0;
+}
+
+}	// Namespace function.
+}	// Namespace math.
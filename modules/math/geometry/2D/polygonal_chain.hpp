@@ -26,7 +26,11 @@ public:
 	PolygonalChain(const std::vector<math::linear::StaticVector<T, 2>>& vec);
 	PolygonalChain(const PolygonalChain<T>& other);
 	PolygonalChain(PolygonalChain<T>& other);
+	PolygonalChain& operator=(const PolygonalChain<T>& other) = default;
 
+	// Number of vertices.
+	inline unsigned numberOfVertices() const {return _vertices.size();}
+	
 	// Return special vertices.
 	inline const math::linear::StaticVector<T, 2>& start() const {return _vertices.front();}
 	inline const math::linear::StaticVector<T, 2>& end() const {return _vertices.back();}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+namespace math {
+
+// Linear indices and sizes of grids, storages and vectors.
+// 64 bits, so grids can hold more than 2^32 values. Defining MATH_INDEX32 keeps 32 bit
+// indices, which vectorise better, for builds that only use small grids.
+#ifdef MATH_INDEX32
+using index_t = std::uint32_t;
+#else
+using index_t = std::uint64_t;
+#endif
+
+}	// Namespace math.
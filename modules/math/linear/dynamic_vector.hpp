@@ -5,6 +5,7 @@
 #include <initializer_list>
 #include <algorithm>
 #include <ostream>
+#include <math/index.hpp>
 
 namespace math {
 namespace linear {
@@ -16,7 +17,7 @@ class DynamicVector {
 
 public:
 	DynamicVector();
-	DynamicVector(unsigned size);
+	DynamicVector(math::index_t size);
 	
 	DynamicVector(std::initializer_list<T> list);
 
@@ -24,15 +25,15 @@ public:
 	DynamicVector(const DynamicVector<T>& other);
 	DynamicVector(DynamicVector<T>& other);
 	
-	unsigned size() const;
+	math::index_t size() const;
 	
-	DynamicVector& resize(unsigned size);
+	DynamicVector& resize(math::index_t size);
 
-	const T& operator[](unsigned i) const;
-	T& operator[](unsigned i);
+	const T& operator[](math::index_t i) const;
+	T& operator[](math::index_t i);
 
-	const T& operator()(unsigned i) const;
-	T& operator()(unsigned i);
+	const T& operator()(math::index_t i) const;
+	T& operator()(math::index_t i);
 
 	DynamicVector operator+() const;
 	DynamicVector operator-() const;
@@ -78,7 +79,7 @@ inline DynamicVector<T>::DynamicVector() : _data{} {
 }
 
 template <typename T>
-inline DynamicVector<T>::DynamicVector(unsigned size) : _data(size) {
+inline DynamicVector<T>::DynamicVector(math::index_t size) : _data(size) {
 	// _data.resize(size);
 }
 
@@ -105,18 +106,18 @@ inline DynamicVector<T>::DynamicVector(DynamicVector<T>& other) : _data(other._d
 }
 
 template <typename T>
-unsigned DynamicVector<T>::size() const {
+math::index_t DynamicVector<T>::size() const {
 	return _data.size();
 }
 
 template <typename T>
-DynamicVector<T>& DynamicVector<T>::resize(unsigned size) {
+DynamicVector<T>& DynamicVector<T>::resize(math::index_t size) {
 	_data.resize(size);
 	return *this;
 }
 
 template <typename T>
-inline const T& DynamicVector<T>::operator[](unsigned i) const {
+inline const T& DynamicVector<T>::operator[](math::index_t i) const {
 	#ifdef DEBUG
 		if (i >= _data.size()) throw std::logic_error("Invalid index");
 	#endif
@@ -125,7 +126,7 @@ inline const T& DynamicVector<T>::operator[](unsigned i) const {
 }
 
 template <typename T>
-inline T& DynamicVector<T>::operator[](unsigned i) {
+inline T& DynamicVector<T>::operator[](math::index_t i) {
 	#ifdef DEBUG
 		if (i >= _data.size()) throw std::logic_error("Invalid index");
 	#endif
@@ -134,7 +135,7 @@ inline T& DynamicVector<T>::operator[](unsigned i) {
 }
 
 template <typename T>
-inline const T& DynamicVector<T>::operator()(unsigned i) const {
+inline const T& DynamicVector<T>::operator()(math::index_t i) const {
 	#ifdef DEBUG
 		if (i >= _data.size()) throw std::logic_error("Invalid index");
 	#endif
@@ -142,7 +143,7 @@ inline const T& DynamicVector<T>::operator()(unsigned i) const {
 }
 
 template <typename T>
-inline T& DynamicVector<T>::operator()(unsigned i) {
+inline T& DynamicVector<T>::operator()(math::index_t i) {
 	#ifdef DEBUG
 		if (i >= _data.size()) throw std::logic_error("Invalid index");
 	#endif
@@ -156,55 +157,55 @@ inline DynamicVector<T> DynamicVector<T>::operator+() const {
 
 template <typename T>
 inline DynamicVector<T> DynamicVector<T>::operator-() const {
-	unsigned size = _data.size();
+	math::index_t size = _data.size();
 	DynamicVector vec(_data);
-	for (unsigned i = 0; i < size; ++i) vec[i] = -_data[i];
+	for (math::index_t i = 0; i < size; ++i) vec[i] = -_data[i];
 	return vec;
 }
 
 template <typename T>
 inline DynamicVector<T>& DynamicVector<T>::operator+=(const DynamicVector<T>& vec) {
-	unsigned size = _data.size();
+	math::index_t size = _data.size();
 	if (vec.size() != size) throw std::logic_error("Vectors have to be of the same shape");
-	for (unsigned i = 0; i < size; ++i) _data[i] += vec[i];
+	for (math::index_t i = 0; i < size; ++i) _data[i] += vec[i];
 	return *this;
 }
 
 template <typename T>
 inline DynamicVector<T>& DynamicVector<T>::operator-=(const DynamicVector<T>& vec) {
-	unsigned size = _data.size();
+	math::index_t size = _data.size();
 	if (vec.size() != size) throw std::logic_error("Vectors have to be of the same shape");
-	for (unsigned i = 0; i < size; ++i) _data[i] -= vec[i];
+	for (math::index_t i = 0; i < size; ++i) _data[i] -= vec[i];
 	return *this;
 }
 
 template <typename T>
 inline DynamicVector<T>& DynamicVector<T>::operator*=(const DynamicVector<T>& vec) {
-	unsigned size = _data.size();
+	math::index_t size = _data.size();
 	if (vec.size() != size) throw std::logic_error("Vectors have to be of the same shape");
-	for (unsigned i = 0; i < size; ++i) _data[i] *= vec[i];
+	for (math::index_t i = 0; i < size; ++i) _data[i] *= vec[i];
 	return *this;
 }
 
 template <typename T>
 inline DynamicVector<T>& DynamicVector<T>::operator/=(const DynamicVector<T>& vec) {
-	unsigned size = _data.size();
+	math::index_t size = _data.size();
 	if (vec.size() != size) throw std::logic_error("Vectors have to be of the same shape");
 	
 	#ifdef DEBUG
-	for (unsigned i = 0; i < size; ++i)
+	for (math::index_t i = 0; i < size; ++i)
 		if (vec._data[i] == 0)
 			throw std::logic_error("Can't divide by zero");
 	#endif
 
-	for (unsigned i = 0; i < size; ++i) _data[i] /= vec[i];
+	for (math::index_t i = 0; i < size; ++i) _data[i] /= vec[i];
 	return *this;
 }
 
 template <typename T>
 inline DynamicVector<T>& DynamicVector<T>::operator*=(const T& value) {
-	unsigned size = _data.size();
-	for (unsigned i = 0; i < size; ++i) _data[i] *= value;
+	math::index_t size = _data.size();
+	for (math::index_t i = 0; i < size; ++i) _data[i] *= value;
 	return *this;
 }
 
@@ -214,15 +215,15 @@ inline DynamicVector<T>& DynamicVector<T>::operator/=(const T& value) {
 		if (value == 0) throw std::logic_error("Can't divide by zero");
 	#endif
 
-	unsigned size = _data.size();
-	for (unsigned i = 0; i < size; ++i) _data[i] /= value;
+	math::index_t size = _data.size();
+	for (math::index_t i = 0; i < size; ++i) _data[i] /= value;
 	return *this;
 }
 
 template <typename T>
 bool DynamicVector<T>::operator==(const DynamicVector<T>& vec) {
-	unsigned size = _data.size();
-	for (unsigned i = 0; i < size; ++i) {
+	math::index_t size = _data.size();
+	for (math::index_t i = 0; i < size; ++i) {
 		if (_data[i] != vec[i]) return false;
 	}
 
@@ -242,17 +243,17 @@ inline DynamicVector<T> DynamicVector<T>::unit() const {
 template <typename T>
 inline T DynamicVector<T>::dot(const DynamicVector<T>& vec) const {
 	T result = T(0);
-	unsigned size = _data.size();
+	math::index_t size = _data.size();
 	if (vec.size() != size) throw std::logic_error("Vectors have to be of the same shape");
-	for (unsigned i = 0; i < size; ++i) result += _data[i] * vec[i];
+	for (math::index_t i = 0; i < size; ++i) result += _data[i] * vec[i];
 	return result;
 }
 
 template <typename T>
 inline T DynamicVector<T>::dot() const {
-	unsigned size = _data.size();
+	math::index_t size = _data.size();
 	T result = T(0);
-	for (unsigned i = 0; i < size; ++i) result += _data[i] * _data[i];
+	for (math::index_t i = 0; i < size; ++i) result += _data[i] * _data[i];
 	return result;
 }
 
@@ -266,31 +267,31 @@ inline E DynamicVector<T>::length() const {
 // Definition of non-memberfunctions: --------------------------------------------
 template <typename T>
 DynamicVector<T> operator+(const DynamicVector<T>& vec, const DynamicVector<T>& other) {
-	unsigned size = vec.size();
+	math::index_t size = vec.size();
 	if (other.size() != vec.size()) throw std::logic_error("Vectors have to be of the same shape");
 	
 	DynamicVector<T> result(size);
-	for (unsigned i = 0; i < size; ++i) result[i] = vec[i] + other[i];
+	for (math::index_t i = 0; i < size; ++i) result[i] = vec[i] + other[i];
 	return result;
 }
 
 template <typename T>
 DynamicVector<T> operator-(const DynamicVector<T>& vec, const DynamicVector<T>& other) {
-	unsigned size = vec.size();
+	math::index_t size = vec.size();
 	if (other.size() != vec.size()) throw std::logic_error("Vectors have to be of the same shape");
 	
 	DynamicVector<T> result(size);
-	for (unsigned i = 0; i < size; ++i) result[i] = vec[i] - other[i];
+	for (math::index_t i = 0; i < size; ++i) result[i] = vec[i] - other[i];
 	return result;
 }
 
 template <typename T>
 DynamicVector<T> operator*(const DynamicVector<T>& vec, const DynamicVector<T>& other) {
-	unsigned size = vec.size();
+	math::index_t size = vec.size();
 	if (other.size() != vec.size()) throw std::logic_error("Vectors have to be of the same shape");
 	
 	DynamicVector<T> result(size);
-	for (unsigned i = 0; i < size; ++i) result[i] = vec[i] * other[i];
+	for (math::index_t i = 0; i < size; ++i) result[i] = vec[i] * other[i];
 	return result;
 }
 
@@ -302,19 +303,19 @@ DynamicVector<T> operator/(const DynamicVector<T>& vec, const DynamicVector<T>&
 				throw std::logic_error("Can't divide by zero");
 	#endif
 
-	unsigned size = vec.size();
+	math::index_t size = vec.size();
 	if (other.size() != vec.size()) throw std::logic_error("Vectors have to be of the same shape");
 	
 	DynamicVector<T> result(size);
-	for (unsigned i = 0; i < size; ++i) result[i] = vec[i] / other[i];
+	for (math::index_t i = 0; i < size; ++i) result[i] = vec[i] / other[i];
 	return result;
 }
 
 template <typename T>
 inline DynamicVector<T> operator*(const DynamicVector<T>& vec, const T& value) {
-	unsigned size = vec.size();
+	math::index_t size = vec.size();
 	DynamicVector<T> result(size);
-	for (unsigned i = 0; i < size; ++i) result[i] = vec[i] * value;
+	for (math::index_t i = 0; i < size; ++i) result[i] = vec[i] * value;
 	return result;
 }
 
@@ -325,9 +326,9 @@ inline DynamicVector<T> operator*(const T& value, const DynamicVector<T>& vec) {
 
 template <typename T>
 inline DynamicVector<T> operator/(const DynamicVector<T>& vec, const T& value) {
-	unsigned size = vec.size();
+	math::index_t size = vec.size();
 	DynamicVector<T> result(size);
-	for (unsigned i = 0; i < size; ++i) result[i] = vec[i] / value;
+	for (math::index_t i = 0; i < size; ++i) result[i] = vec[i] / value;
 	return result;
 }
 
@@ -339,8 +340,8 @@ inline DynamicVector<T> operator/(const T& value, const DynamicVector<T>& vec) {
 template <typename T>
 std::ostream& operator<<(std::ostream& os, const math::linear::DynamicVector<T>& vec) {
 	os << "[" << vec[0];
-	unsigned size = vec.size();
-	for (unsigned i = 1; i < size; ++i) os << ", " << vec[i];
+	math::index_t size = vec.size();
+	for (math::index_t i = 1; i < size; ++i) os << ", " << vec[i];
 	os << "]";
 
 	return os;
@@ -5,6 +5,8 @@
 #include <initializer_list>
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
+#include <utility>
 
 /*
 To think off:
@@ -21,6 +23,12 @@ enum class ReductionType {
 	LowerLeft, LowerRight
 };
 
+template <typename T, unsigned N> struct InverseResult;
+
+namespace internal {
+template <typename T, unsigned N> struct SquareMatrixFormulas;
+} // internal namespace
+
 template <typename T, unsigned Rows, unsigned Cols>
 class StaticMatrix {
 	// StaticMatrix formed by column-vectors:
@@ -31,21 +39,32 @@ class StaticMatrix {
 	std::array<T, Rows*Cols> _data;
 	static_assert(Cols*Rows > 0, "Can't make matrix with no cells");
 
+	template <typename S, unsigned N> friend struct internal::SquareMatrixFormulas;
+
+	// Values of the list in row order, then T() for any missing ones.
+	template <std::size_t... I>
+	constexpr StaticMatrix(std::initializer_list<T> list, std::index_sequence<I...>);
+
+	// Gaussian elimination, for sizes without closed forms.
+	T eliminationDet() const;
+	InverseResult<T, Rows> eliminationInverse() const;
+
 
 public:
 	static const unsigned size = Rows*Cols;
 
-	StaticMatrix();
+	constexpr StaticMatrix();
 	StaticMatrix(std::initializer_list<math::linear::StaticVector<T, Cols>> list);
-	StaticMatrix(std::initializer_list<T> list);
+	constexpr StaticMatrix(std::initializer_list<T> list);
 
-	StaticMatrix(const StaticMatrix<T, Rows, Cols>& other);
-	StaticMatrix(StaticMatrix<T, Rows, Cols>& other);
+	constexpr StaticMatrix(const StaticMatrix<T, Rows, Cols>& other);
+	constexpr StaticMatrix(StaticMatrix<T, Rows, Cols>& other);
+	StaticMatrix& operator=(const StaticMatrix<T, Rows, Cols>& other) = default;
 	
-	const T& operator[](unsigned i) const;
+	constexpr const T& operator[](unsigned i) const;
 	T& operator[](unsigned i);
 
-	const T& operator()(unsigned i, unsigned j) const;
+	constexpr const T& operator()(unsigned i, unsigned j) const;
 	T& operator()(unsigned i, unsigned j);
 
 	StaticMatrix operator+() const;
@@ -76,16 +95,25 @@ public:
 	template <typename ReductionHelper>
 	StaticMatrix<T, Rows, Cols> rref(ReductionHelper&& helper, ReductionType type) const;
 
-	// TODO: Decide!
-	// 	Shall we specialize StaticMatrix class for square ones and put det and inverse?
-	//	Shall we put det/inverse here?
-	T det() const;
-	StaticMatrix<T, Rows, Rows> inverse() const;
+	// Determinant and inverse of square matrices. Closed forms for 2x2, 3x3 and 4x4, which
+	// also work in constant expressions; Gaussian elimination for other sizes.
+	// inverse() throws std::logic_error for singular matrices, tryInverse() flags them.
+	constexpr T det() const;
+	constexpr StaticMatrix<T, Rows, Rows> inverse() const;
+	constexpr InverseResult<T, Rows> tryInverse() const;
 
 	// Other Functions. Swap, etc.
 	void swapline(unsigned a, unsigned b);
 };
 
+// Inverse of a square matrix, and whether the matrix is singular. The matrix is all zeros
+// when singular.
+template <typename T, unsigned N>
+struct InverseResult {
+	StaticMatrix<T, N, N> matrix;
+	bool singular;
+};
+
 // Definition of alias -----------------------------------------------------------
 using StaticMatrix2 = StaticMatrix<double, 2, 2>;
 using StaticMatrix3 = StaticMatrix<double, 3, 3>;
@@ -111,8 +139,12 @@ StaticMatrix<T, Rows, Cols> operator/(const StaticMatrix<T, Rows, Cols>& matrix,
 template <typename T, unsigned Rows, unsigned Cols>
 StaticMatrix<T, Rows, Cols> operator/(const T& value, const StaticMatrix<T, Rows, Cols>& matrix);
 
+// Matrix product, and product of a matrix by a column vector.
+template <typename T, unsigned Rows, unsigned Inter, unsigned Cols>
+StaticMatrix<T, Rows, Cols> operator*(const StaticMatrix<T, Rows, Inter>& matrix, const StaticMatrix<T, Inter, Cols>& other);
+
 template <typename T, unsigned Rows, unsigned Cols>
-StaticMatrix<T, Rows, Cols> operator*(const StaticMatrix<T, Rows, Cols>& matrix, const StaticMatrix<T, Rows, Cols>& other);
+math::linear::StaticVector<T, Rows> operator*(const StaticMatrix<T, Rows, Cols>& matrix, const math::linear::StaticVector<T, Cols>& vec);
 
 template <typename T, unsigned Rows, unsigned Cols>
 StaticMatrix<T, Rows, Cols> operator/(const StaticMatrix<T, Rows, Cols>& matrix, const StaticMatrix<T, Rows, Cols>& other);
@@ -129,7 +161,7 @@ math::linear::StaticVector<T, Rows> matrixMultiplication(const StaticMatrix<T, R
 
 // Definition of member-functions: -----------------------------------------------
 template <typename T, unsigned Rows, unsigned Cols>
-StaticMatrix<T, Rows, Cols>::StaticMatrix() : _data{} {
+constexpr StaticMatrix<T, Rows, Cols>::StaticMatrix() : _data{} {
 	// All vectors will be constructed and initialized to T()
 }
 
@@ -146,22 +178,28 @@ StaticMatrix<T, Rows, Cols>::StaticMatrix(std::initializer_list<math::linear::St
 }
 
 template <typename T, unsigned Rows, unsigned Cols>
-StaticMatrix<T, Rows, Cols>::StaticMatrix(std::initializer_list<T> list) {
-	std::copy(list.begin(), list.end(), _data.begin());
+constexpr StaticMatrix<T, Rows, Cols>::StaticMatrix(std::initializer_list<T> list) : StaticMatrix(list, std::make_index_sequence<Rows*Cols>()) {
+
 }
 
 template <typename T, unsigned Rows, unsigned Cols>
-StaticMatrix<T, Rows, Cols>::StaticMatrix(const StaticMatrix<T, Rows, Cols>& other) : _data(other._data) {
+template <std::size_t... I>
+constexpr StaticMatrix<T, Rows, Cols>::StaticMatrix(std::initializer_list<T> list, std::index_sequence<I...>) : _data{{(I < list.size() ? list.begin()[I] : T())...}} {
 
 }
 
 template <typename T, unsigned Rows, unsigned Cols>
-StaticMatrix<T, Rows, Cols>::StaticMatrix(StaticMatrix<T, Rows, Cols>& other) : _data(other._data) {
+constexpr StaticMatrix<T, Rows, Cols>::StaticMatrix(const StaticMatrix<T, Rows, Cols>& other) : _data(other._data) {
 
 }
 
 template <typename T, unsigned Rows, unsigned Cols>
-const T& StaticMatrix<T, Rows, Cols>::operator[](unsigned i) const {
+constexpr StaticMatrix<T, Rows, Cols>::StaticMatrix(StaticMatrix<T, Rows, Cols>& other) : _data(other._data) {
+
+}
+
+template <typename T, unsigned Rows, unsigned Cols>
+constexpr const T& StaticMatrix<T, Rows, Cols>::operator[](unsigned i) const {
 	#ifdef DEBUG
 	if (i >= size) throw std::logic_error("Invalid index");
 	#endif
@@ -179,7 +217,7 @@ T& StaticMatrix<T, Rows, Cols>::operator[](unsigned i) {
 }
 
 template <typename T, unsigned Rows, unsigned Cols>
-const T& StaticMatrix<T, Rows, Cols>::operator()(unsigned i, unsigned j) const {
+constexpr const T& StaticMatrix<T, Rows, Cols>::operator()(unsigned i, unsigned j) const {
 	#ifdef DEBUG
 	if (i >= Rows  || j >= Cols) throw std::logic_error("Invalid index");
 	#endif
@@ -222,8 +260,8 @@ StaticMatrix<T, Rows, Cols>& StaticMatrix<T, Rows, Cols>::operator-=(const Stati
 
 template <typename T, unsigned Rows, unsigned Cols>
 StaticMatrix<T, Rows, Cols>& StaticMatrix<T, Rows, Cols>::operator*=(const StaticMatrix& mat) {
-	for (unsigned i = 0; i < size; ++i) _data[i] *= mat[i];
-	return *this;
+	static_assert(Rows == Cols, "StaticMatrix must be squared for operator*= to work");
+	return *this = *this * mat;
 }
 
 template <typename T, unsigned Rows, unsigned Cols>
@@ -260,8 +298,8 @@ const StaticMatrix<T, Rows, Cols> StaticMatrix<T, Rows, Cols>::eye() {
 	StaticMatrix<T, Rows, Cols> result;
 	for (unsigned i = 0; i < Rows; ++i) {
 		for (unsigned j = 0; j < Cols; ++j) {
-			if (i == j) result(i, j) = T(0);
-			else result(i, j) = T(1);
+			if (i == j) result(i, j) = T(1);
+			else result(i, j) = T(0);
 		}
 	}
 
@@ -341,14 +379,6 @@ StaticMatrix<T, Rows, Cols> operator/(const T& value, const StaticMatrix<T, Rows
 	return matrix / value;
 }
 
-template <typename T, unsigned Rows, unsigned Cols>
-StaticMatrix<T, Rows, Cols> operator*(const StaticMatrix<T, Rows, Cols>& matrix, const StaticMatrix<T, Rows, Cols>& other) {
-	unsigned size = Rows * Cols;
-	StaticMatrix<T, Rows, Cols> result;
-	for (unsigned i = 0; i < size; ++i) result[i] = matrix[i] * other[i];
-	return result;
-}
-
 template <typename T, unsigned Rows, unsigned Cols>
 StaticMatrix<T, Rows, Cols> operator/(const StaticMatrix<T, Rows, Cols>& matrix, const StaticMatrix<T, Rows, Cols>& other) {
 	unsigned size = Rows * Cols;
@@ -358,31 +388,104 @@ StaticMatrix<T, Rows, Cols> operator/(const StaticMatrix<T, Rows, Cols>& matrix,
 }
 
 
+// Internal namespace for product kernels
+namespace internal {
+
+// Product kernels. Each row of the result is a combination of the rows of other, so the
+// inner loops run along contiguous rows, with bounds known at compile time: compilers
+// unroll them and vectorise the rows. Every value of the result is written once.
 template <typename T, unsigned Rows, unsigned Inter, unsigned Cols>
-StaticMatrix<T, Rows, Cols> matrixMultiplication(const StaticMatrix<T, Rows, Inter>& matrix, const StaticMatrix<T, Inter, Cols>& other) {
-	StaticMatrix<T, Rows, Cols> result;
-	for (unsigned i = 0; i < Rows; ++i) {
-		for (unsigned j = 0; j < Cols; ++j) {
-			for (unsigned k = 0; k < Inter; ++k) {
-				result(i, j) += matrix(i, k) * other(k, j);
+struct MatrixProduct {
+	static inline void apply(const StaticMatrix<T, Rows, Inter>& a, const StaticMatrix<T, Inter, Cols>& b, StaticMatrix<T, Rows, Cols>& c) {
+		for (unsigned i = 0; i < Rows; ++i) {
+			T row[Cols];
+			for (unsigned j = 0; j < Cols; ++j) row[j] = a[i*Inter] * b[j];
+			for (unsigned k = 1; k < Inter; ++k) {
+				T factor = a[i*Inter + k];
+				for (unsigned j = 0; j < Cols; ++j) row[j] += factor * b[k*Cols + j];
 			}
+
+			for (unsigned j = 0; j < Cols; ++j) c[i*Cols + j] = row[j];
+		}
+	}
+};
+
+template <typename T>
+struct MatrixProduct<T, 2, 2, 2> {
+	static inline void apply(const StaticMatrix<T, 2, 2>& a, const StaticMatrix<T, 2, 2>& b, StaticMatrix<T, 2, 2>& c) {
+		T a00 = a[0], a01 = a[1], a10 = a[2], a11 = a[3];
+		T b00 = b[0], b01 = b[1], b10 = b[2], b11 = b[3];
+		c[0] = a00 * b00 + a01 * b10;
+		c[1] = a00 * b01 + a01 * b11;
+		c[2] = a10 * b00 + a11 * b10;
+		c[3] = a10 * b01 + a11 * b11;
+	}
+};
+
+// Register blocked: the rows of b are loaded once and kept for every row of the result.
+template <typename T>
+struct MatrixProduct<T, 3, 3, 3> {
+	static inline void apply(const StaticMatrix<T, 3, 3>& a, const StaticMatrix<T, 3, 3>& b, StaticMatrix<T, 3, 3>& c) {
+		const T b0[3] = {b[0], b[1], b[2]};
+		const T b1[3] = {b[3], b[4], b[5]};
+		const T b2[3] = {b[6], b[7], b[8]};
+		for (unsigned i = 0; i < 3; ++i) {
+			T a0 = a[3*i], a1 = a[3*i + 1], a2 = a[3*i + 2];
+			for (unsigned j = 0; j < 3; ++j) c[3*i + j] = a0 * b0[j] + a1 * b1[j] + a2 * b2[j];
 		}
 	}
+};
 
+template <typename T>
+struct MatrixProduct<T, 4, 4, 4> {
+	static inline void apply(const StaticMatrix<T, 4, 4>& a, const StaticMatrix<T, 4, 4>& b, StaticMatrix<T, 4, 4>& c) {
+		const T b0[4] = {b[0], b[1], b[2], b[3]};
+		const T b1[4] = {b[4], b[5], b[6], b[7]};
+		const T b2[4] = {b[8], b[9], b[10], b[11]};
+		const T b3[4] = {b[12], b[13], b[14], b[15]};
+		for (unsigned i = 0; i < 4; ++i) {
+			T a0 = a[4*i], a1 = a[4*i + 1], a2 = a[4*i + 2], a3 = a[4*i + 3];
+			for (unsigned j = 0; j < 4; ++j) c[4*i + j] = (a0 * b0[j] + a1 * b1[j]) + (a2 * b2[j] + a3 * b3[j]);
+		}
+	}
+};
+
+// Product by a column vector: one dot product per row, over a contiguous row.
+template <typename T, unsigned Rows, unsigned Cols>
+inline void matrixVectorProduct(const StaticMatrix<T, Rows, Cols>& a, const math::linear::StaticVector<T, Cols>& v, math::linear::StaticVector<T, Rows>& result) {
+	T x[Cols];
+	for (unsigned j = 0; j < Cols; ++j) x[j] = v[j];
+	for (unsigned i = 0; i < Rows; ++i) {
+		T sum = a[i*Cols] * x[0];
+		for (unsigned j = 1; j < Cols; ++j) sum += a[i*Cols + j] * x[j];
+		result[i] = sum;
+	}
+}
+
+} // internal namespace
+
+template <typename T, unsigned Rows, unsigned Inter, unsigned Cols>
+StaticMatrix<T, Rows, Cols> operator*(const StaticMatrix<T, Rows, Inter>& matrix, const StaticMatrix<T, Inter, Cols>& other) {
+	StaticMatrix<T, Rows, Cols> result;
+	internal::MatrixProduct<T, Rows, Inter, Cols>::apply(matrix, other, result);
 	return result;
 }
 
 template <typename T, unsigned Rows, unsigned Cols>
-math::linear::StaticVector<T, Rows> matrixMultiplication(const StaticMatrix<T, Rows, Cols>& matrix, const math::linear::StaticVector<T, Cols>& vec) {
+math::linear::StaticVector<T, Rows> operator*(const StaticMatrix<T, Rows, Cols>& matrix, const math::linear::StaticVector<T, Cols>& vec) {
 	math::linear::StaticVector<T, Rows> result;
+	internal::matrixVectorProduct(matrix, vec, result);
+	return result;
+}
 
-	for (unsigned i = 0; i < Rows; ++i) {
-		for (unsigned j = 0; j < Cols; ++j) {
-			result(i) += matrix(i, j) * vec(j);
-		}
-	}
+template <typename T, unsigned Rows, unsigned Inter, unsigned Cols>
+StaticMatrix<T, Rows, Cols> matrixMultiplication(const StaticMatrix<T, Rows, Inter>& matrix, const StaticMatrix<T, Inter, Cols>& other) {
+	return matrix * other;
+}
 
-	return result;
+template <typename T, unsigned Rows, unsigned Cols>
+math::linear::StaticVector<T, Rows> matrixMultiplication(const StaticMatrix<T, Rows, Cols>& matrix, const math::linear::StaticVector<T, Cols>& vec) {
+	return matrix * vec;
 }
 
 template <typename T, unsigned Rows, unsigned Cols>
@@ -578,9 +681,7 @@ StaticMatrix<T, Rows, Cols> StaticMatrix<T, Rows, Cols>::rref(ReductionHelper&&
 }
 
 template <typename T, unsigned Rows, unsigned Cols>
-T StaticMatrix<T, Rows, Cols>::det() const {
-	static_assert(Rows == Cols, "StaticMatrix must be squared for det() to work");
-
+T StaticMatrix<T, Rows, Cols>::eliminationDet() const {
 	T result = 1;
 	StaticMatrix reduced = this->rref(result, ReductionType::LowerLeft);
 
@@ -590,22 +691,153 @@ T StaticMatrix<T, Rows, Cols>::det() const {
 }
 
 template <typename T, unsigned Rows, unsigned Cols>
-StaticMatrix<T, Rows, Rows> StaticMatrix<T, Rows, Cols>::inverse() const {
-	static_assert(Rows == Cols, "StaticMatrix must be squared for det() to work");
+InverseResult<T, Rows> StaticMatrix<T, Rows, Cols>::eliminationInverse() const {
+	if (eliminationDet() == T(0)) return InverseResult<T, Rows>{StaticMatrix(), true};
 
 	StaticMatrix identity = StaticMatrix<T, Rows, Cols>::eye();
 	StaticMatrix firstReduced = this->rref(identity, ReductionType::LowerLeft);
 	StaticMatrix secondReduced = firstReduced.rref(identity, ReductionType::UpperRight);
 
-	double d = det();
-	if (d == 0) throw std::logic_error("This matrix is non-invertible");
-
 	for (unsigned i = 0; i < Rows; ++i) {
 		for (unsigned j = 0; j < Cols; ++j) identity(i, j) /= secondReduced(i, i);
 	}
 
-	return identity;
+	return InverseResult<T, Rows>{identity, false};
+}
+
+template <typename T, unsigned Rows, unsigned Cols>
+constexpr T StaticMatrix<T, Rows, Cols>::det() const {
+	static_assert(Rows == Cols, "StaticMatrix must be squared for det() to work");
+	return internal::SquareMatrixFormulas<T, Rows>::det(*this);
+}
+
+template <typename T, unsigned Rows, unsigned Cols>
+constexpr InverseResult<T, Rows> StaticMatrix<T, Rows, Cols>::tryInverse() const {
+	static_assert(Rows == Cols, "StaticMatrix must be squared for inverse() to work");
+	return internal::SquareMatrixFormulas<T, Rows>::inverse(*this);
+}
+
+template <typename T, unsigned Rows, unsigned Cols>
+constexpr StaticMatrix<T, Rows, Rows> StaticMatrix<T, Rows, Cols>::inverse() const {
+	InverseResult<T, Rows> result = tryInverse();
+	if (result.singular) throw std::logic_error("This matrix is non-invertible");
+	return result.matrix;
 }
 
+
+namespace internal {
+
+// Determinant and inverse by Gaussian elimination, for any size.
+template <typename T, unsigned N>
+struct SquareMatrixFormulas {
+	static T det(const StaticMatrix<T, N, N>& m) {return m.eliminationDet();}
+	static InverseResult<T, N> inverse(const StaticMatrix<T, N, N>& m) {return m.eliminationInverse();}
+};
+
+// Closed forms: cofactor expansions, and the adjugate divided by the determinant.
+template <typename T>
+struct SquareMatrixFormulas<T, 2> {
+	static constexpr T det(const StaticMatrix<T, 2, 2>& m) {
+		return m[0] * m[3] - m[1] * m[2];
+	}
+
+	static constexpr InverseResult<T, 2> inverse(const StaticMatrix<T, 2, 2>& m) {
+		T d = det(m);
+		if (d == T(0)) return InverseResult<T, 2>{StaticMatrix<T, 2, 2>(), true};
+
+		T r = T(1) / d;
+		return InverseResult<T, 2>{StaticMatrix<T, 2, 2>({m[3] * r, -m[1] * r, -m[2] * r, m[0] * r}), false};
+	}
+};
+
+template <typename T>
+struct SquareMatrixFormulas<T, 3> {
+	static constexpr T det(const StaticMatrix<T, 3, 3>& m) {
+		return m[0] * (m[4] * m[8] - m[5] * m[7]) - m[1] * (m[3] * m[8] - m[5] * m[6]) + m[2] * (m[3] * m[7] - m[4] * m[6]);
+	}
+
+	static constexpr InverseResult<T, 3> inverse(const StaticMatrix<T, 3, 3>& m) {
+		// Cofactors of the first row, shared with the determinant.
+		T c00 = m[4] * m[8] - m[5] * m[7];
+		T c01 = m[5] * m[6] - m[3] * m[8];
+		T c02 = m[3] * m[7] - m[4] * m[6];
+		T d = m[0] * c00 + m[1] * c01 + m[2] * c02;
+		if (d == T(0)) return InverseResult<T, 3>{StaticMatrix<T, 3, 3>(), true};
+
+		T r = T(1) / d;
+		return InverseResult<T, 3>{StaticMatrix<T, 3, 3>({
+			c00 * r, (m[2] * m[7] - m[1] * m[8]) * r, (m[1] * m[5] - m[2] * m[4]) * r,
+			c01 * r, (m[0] * m[8] - m[2] * m[6]) * r, (m[2] * m[3] - m[0] * m[5]) * r,
+			c02 * r, (m[1] * m[6] - m[0] * m[7]) * r, (m[0] * m[4] - m[1] * m[3]) * r
+		}), false};
+	}
+};
+
+// 4x4 through the 2x2 minors of the two upper rows (s) and the two lower rows (c).
+template <typename T>
+struct SquareMatrixFormulas<T, 4> {
+	static constexpr T det(const StaticMatrix<T, 4, 4>& m) {
+		T s0 = m[0] * m[5] - m[4] * m[1];
+		T s1 = m[0] * m[6] - m[4] * m[2];
+		T s2 = m[0] * m[7] - m[4] * m[3];
+		T s3 = m[1] * m[6] - m[5] * m[2];
+		T s4 = m[1] * m[7] - m[5] * m[3];
+		T s5 = m[2] * m[7] - m[6] * m[3];
+
+		T c5 = m[10] * m[15] - m[14] * m[11];
+		T c4 = m[9] * m[15] - m[13] * m[11];
+		T c3 = m[9] * m[14] - m[13] * m[10];
+		T c2 = m[8] * m[15] - m[12] * m[11];
+		T c1 = m[8] * m[14] - m[12] * m[10];
+		T c0 = m[8] * m[13] - m[12] * m[9];
+
+		return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	}
+
+	static constexpr InverseResult<T, 4> inverse(const StaticMatrix<T, 4, 4>& m) {
+		T s0 = m[0] * m[5] - m[4] * m[1];
+		T s1 = m[0] * m[6] - m[4] * m[2];
+		T s2 = m[0] * m[7] - m[4] * m[3];
+		T s3 = m[1] * m[6] - m[5] * m[2];
+		T s4 = m[1] * m[7] - m[5] * m[3];
+		T s5 = m[2] * m[7] - m[6] * m[3];
+
+		T c5 = m[10] * m[15] - m[14] * m[11];
+		T c4 = m[9] * m[15] - m[13] * m[11];
+		T c3 = m[9] * m[14] - m[13] * m[10];
+		T c2 = m[8] * m[15] - m[12] * m[11];
+		T c1 = m[8] * m[14] - m[12] * m[10];
+		T c0 = m[8] * m[13] - m[12] * m[9];
+
+		T d = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		if (d == T(0)) return InverseResult<T, 4>{StaticMatrix<T, 4, 4>(), true};
+
+		T r = T(1) / d;
+		return InverseResult<T, 4>{StaticMatrix<T, 4, 4>({
+			( m[5] * c5 - m[6] * c4 + m[7] * c3) * r,
+			(-m[1] * c5 + m[2] * c4 - m[3] * c3) * r,
+			( m[13] * s5 - m[14] * s4 + m[15] * s3) * r,
+			(-m[9] * s5 + m[10] * s4 - m[11] * s3) * r,
+
+			(-m[4] * c5 + m[6] * c2 - m[7] * c1) * r,
+			( m[0] * c5 - m[2] * c2 + m[3] * c1) * r,
+			(-m[12] * s5 + m[14] * s2 - m[15] * s1) * r,
+			( m[8] * s5 - m[10] * s2 + m[11] * s1) * r,
+
+			( m[4] * c4 - m[5] * c2 + m[7] * c0) * r,
+			(-m[0] * c4 + m[1] * c2 - m[3] * c0) * r,
+			( m[12] * s4 - m[13] * s2 + m[15] * s0) * r,
+			(-m[8] * s4 + m[9] * s2 - m[11] * s0) * r,
+
+			(-m[4] * c3 + m[5] * c1 - m[6] * c0) * r,
+			( m[0] * c3 - m[1] * c1 + m[2] * c0) * r,
+			(-m[12] * s3 + m[13] * s1 - m[14] * s0) * r,
+			( m[8] * s3 - m[9] * s1 + m[10] * s0) * r
+		}), false};
+	}
+};
+
+} // internal namespace
+
 } // linear namespace
 } // math namespace
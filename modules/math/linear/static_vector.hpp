@@ -20,6 +20,7 @@ public:
 	StaticVector(const std::array<T, D>& array);
 	StaticVector(const StaticVector<T, D>& other);
 	StaticVector(StaticVector<T, D>& other);
+	StaticVector& operator=(const StaticVector<T, D>& other) = default;
 
 	const T& operator[](unsigned i) const;
 	T& operator[](unsigned i);
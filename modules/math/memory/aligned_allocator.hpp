@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+
+namespace math {
+namespace memory {
+
+// Allocator returning memory aligned to Alignment bytes (a cache line by default).
+// C++14 containers do not honour over-aligned types, so this is needed for SIMD-friendly
+// and cache-aligned buffers.
+template <typename E, std::size_t Alignment = 64>
+class AlignedAllocator {
+	static_assert((Alignment & (Alignment - 1)) == 0, "The alignment must be a power of two");
+	static_assert(Alignment >= sizeof(void*), "The alignment must be at least the size of a pointer");
+
+public:
+	using value_type = E;
+	static const std::size_t alignment = (Alignment < alignof(E)) ? alignof(E) : Alignment;
+
+	template <typename F>
+	struct rebind {
+		using other = AlignedAllocator<F, Alignment>;
+	};
+
+	AlignedAllocator() noexcept {}
+	template <typename F> AlignedAllocator(const AlignedAllocator<F, Alignment>&) noexcept {}
+
+	E* allocate(std::size_t size) {
+		if (size == 0) return nullptr;
+		void* pointer = nullptr;
+		if (posix_memalign(&pointer, alignment, size * sizeof(E)) != 0) throw std::bad_alloc();
+		return static_cast<E*>(pointer);
+	}
+
+	void deallocate(E* pointer, std::size_t) noexcept {
+		std::free(pointer);
+	}
+};
+
+template <typename E, typename F, std::size_t Alignment>
+bool operator==(const AlignedAllocator<E, Alignment>&, const AlignedAllocator<F, Alignment>&) {return true;}
+
+template <typename E, typename F, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<E, Alignment>&, const AlignedAllocator<F, Alignment>&) {return false;}
+
+}	// Namespace memory.
+}	// Namespace math.
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstdlib>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace math {
+namespace memory {
+
+// Pool of cache-line aligned scratch buffers, reused across operations.
+// Buffers handed back are kept and given to the next request they fit, the smallest
+// first, so repeating an operation reuses the memory, already paged in, of the last run.
+// Counters tell how many bytes were obtained from the system and how many were recycled.
+// Acquiring and releasing are thread safe. Buffers must be released before the workspace
+// is destroyed.
+class Workspace {
+	struct Block {
+		void* pointer;
+		std::size_t bytes;
+		bool used;
+	};
+
+	std::vector<Block> _blocks;
+	mutable std::mutex _mutex;
+
+	// Counters.
+	std::size_t _allocated;
+	std::size_t _recycled;
+	unsigned _allocations;
+	unsigned _recycles;
+
+public:
+	static const std::size_t alignment = 64;
+
+	Workspace() : _allocated(0), _recycled(0), _allocations(0), _recycles(0) {}
+	Workspace(const Workspace&) = delete;
+	Workspace& operator=(const Workspace&) = delete;
+	~Workspace();
+
+	// Buffer of at least bytes bytes, aligned to the workspace alignment.
+	void* acquire(std::size_t bytes);
+
+	// Hand a buffer back to the workspace, for later requests.
+	void release(void* pointer);
+
+	// Free the buffers not in use.
+	void trim();
+
+	// Counters.
+	std::size_t allocatedBytes() const;
+	std::size_t recycledBytes() const;
+	unsigned allocations() const;
+	unsigned recycles() const;
+	std::size_t heldBytes() const;
+};
+
+
+inline Workspace::~Workspace() {
+	for (Block& block : _blocks) std::free(block.pointer);
+}
+
+inline void* Workspace::acquire(std::size_t bytes) {
+	bytes = (bytes + alignment - 1) / alignment * alignment;
+	if (bytes == 0) bytes = alignment;
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	// Smallest free buffer that fits.
+	Block* best = nullptr;
+	for (Block& block : _blocks) {
+		if (block.used or block.bytes < bytes) continue;
+		if (best == nullptr or block.bytes < best->bytes) best = &block;
+	}
+
+	if (best != nullptr) {
+		best->used = true;
+		_recycled += bytes;
+		++_recycles;
+		return best->pointer;
+	}
+
+	void* pointer = nullptr;
+	if (posix_memalign(&pointer, alignment, bytes) != 0) throw std::bad_alloc();
+	_blocks.push_back(Block{pointer, bytes, true});
+	_allocated += bytes;
+	++_allocations;
+	return pointer;
+}
+
+inline void Workspace::release(void* pointer) {
+	if (pointer == nullptr) return;
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (Block& block : _blocks) {
+		if (block.pointer == pointer) {
+			block.used = false;
+			return;
+		}
+	}
+}
+
+inline void Workspace::trim() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::vector<Block> kept;
+	for (Block& block : _blocks) {
+		if (block.used) kept.push_back(block);
+		else std::free(block.pointer);
+	}
+
+	_blocks.swap(kept);
+}
+
+inline std::size_t Workspace::allocatedBytes() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _allocated;
+}
+
+inline std::size_t Workspace::recycledBytes() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _recycled;
+}
+
+inline unsigned Workspace::allocations() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _allocations;
+}
+
+inline unsigned Workspace::recycles() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _recycles;
+}
+
+inline std::size_t Workspace::heldBytes() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::size_t bytes = 0;
+	for (const Block& block : _blocks) bytes += block.bytes;
+	return bytes;
+}
+
+}	// Namespace memory.
+}	// Namespace math.
@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <math/index.hpp>
+
+namespace math {
+namespace parallel {
+
+// Number of threads the hardware can run concurrently. Never zero.
+inline unsigned hardwareThreads() {
+	unsigned threads = std::thread::hardware_concurrency();
+	return (threads == 0) ? 1 : threads;
+}
+
+// Split [begin, end) into contiguous chunks and call function(first, last) on each chunk.
+// The chunks are fixed by the range and the number of threads, so the work each
+// thread does is deterministic. With a single thread the function runs inline.
+template <typename Function>
+void parallelFor(math::index_t begin, math::index_t end, unsigned threads, Function&& function) {
+	if (end <= begin) return;
+	math::index_t size = end - begin;
+	if (threads == 0) threads = hardwareThreads();
+	if (size < threads) threads = static_cast<unsigned>(size);
+	
+	if (threads <= 1) {
+		function(begin, end);
+		return;
+	}
+	
+	// Run the first chunk on the calling thread.
+	std::vector<std::thread> workers;
+	workers.reserve(threads-1);
+	for (unsigned t = 1; t < threads; ++t) {
+		math::index_t first = begin + static_cast<math::index_t>((static_cast<unsigned long long>(size) * t) / threads);
+		math::index_t last = begin + static_cast<math::index_t>((static_cast<unsigned long long>(size) * (t+1)) / threads);
+		workers.emplace_back([&function, first, last]() {function(first, last);});
+	}
+	
+	function(begin, begin + size / threads);
+	for (auto& worker : workers) worker.join();
+}
+
+}	// Namespace parallel.
+}	// Namespace math.
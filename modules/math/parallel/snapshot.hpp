@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+namespace math {
+namespace parallel {
+
+template <typename V> class SnapshotPublisher;
+
+// Pinned version of the value of a SnapshotPublisher. Keeps its slot from being
+// overwritten until it is destroyed or released.
+template <typename V>
+class Snapshot {
+	friend class SnapshotPublisher<V>;
+
+	const V* _value;
+	std::atomic<unsigned>* _readers;
+	unsigned long long _version;
+
+	Snapshot(const V* value, std::atomic<unsigned>* readers, unsigned long long version) : _value(value), _readers(readers), _version(version) {}
+
+public:
+	Snapshot() : _value(nullptr), _readers(nullptr), _version(0) {}
+	Snapshot(const Snapshot&) = delete;
+	Snapshot(Snapshot&& other);
+	~Snapshot() {release();}
+
+	Snapshot& operator=(const Snapshot&) = delete;
+	Snapshot& operator=(Snapshot&& other);
+
+	// Accessor functions.
+	inline explicit operator bool() const {return _value != nullptr;}
+	inline unsigned long long version() const {return _version;}
+	inline const V& operator*() const {return *_value;}
+	inline const V* operator->() const {return _value;}
+
+	// Unpin the slot. The snapshot is empty afterwards.
+	void release();
+};
+
+
+// Triple buffer publishing consistent versions of a value, such as the grid of a
+// running solver, to concurrent readers.
+// One writer copies the value into a free slot and publishes it as the new version.
+// Readers pin the latest version without locks: they count themselves on its slot, then
+// check that the slot still holds the published version, and retry otherwise. The writer
+// never waits for readers and never writes pinned or published slots, so readers only
+// see whole versions. Slots are reused, so grids are copied without allocating.
+template <typename V>
+class SnapshotPublisher {
+	struct Slot {
+		V value;
+		std::atomic<unsigned> readers;
+
+		Slot(const V& initial) : value(initial), readers(0) {}
+	};
+
+	Slot _slots[3];
+
+	// Published version and its slot, as version * 4 + slot.
+	std::atomic<unsigned long long> _published;
+
+public:
+	// Publishes initial as version 0.
+	explicit SnapshotPublisher(const V& initial);
+	SnapshotPublisher(const SnapshotPublisher&) = delete;
+	SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+	// Latest published version.
+	inline unsigned long long version() const {return _published.load() / 4;}
+
+	// Copy source into a free slot and publish it. Only one thread may publish. Returns
+	// false, publishing nothing, when readers pin every other slot.
+	template <typename Source>
+	bool publish(const Source& source);
+
+	// Pin the latest version. Any number of threads may pin at once.
+	Snapshot<V> pin();
+};
+
+
+template <typename V>
+Snapshot<V>::Snapshot(Snapshot&& other) : _value(other._value), _readers(other._readers), _version(other._version) {
+	other._value = nullptr;
+	other._readers = nullptr;
+}
+
+template <typename V>
+Snapshot<V>& Snapshot<V>::operator=(Snapshot&& other) {
+	if (this != &other) {
+		release();
+		std::swap(_value, other._value);
+		std::swap(_readers, other._readers);
+		_version = other._version;
+	}
+
+	return *this;
+}
+
+template <typename V>
+void Snapshot<V>::release() {
+	if (_readers != nullptr) _readers->fetch_sub(1);
+	_value = nullptr;
+	_readers = nullptr;
+}
+
+
+template <typename V>
+SnapshotPublisher<V>::SnapshotPublisher(const V& initial) : _slots{{initial}, {initial}, {initial}}, _published(0) {}
+
+template <typename V>
+template <typename Source>
+bool SnapshotPublisher<V>::publish(const Source& source) {
+	unsigned long long published = _published.load();
+	unsigned current = static_cast<unsigned>(published % 4);
+
+	// A reader pinning the chosen slot after this check finds it unpublished and retries.
+	for (unsigned s = 0; s < 3; ++s) {
+		if (s == current or _slots[s].readers.load() != 0) continue;
+
+		_slots[s].value = source;
+		_published.store((published / 4 + 1) * 4 + s);
+		return true;
+	}
+
+	return false;
+}
+
+template <typename V>
+Snapshot<V> SnapshotPublisher<V>::pin() {
+	while (true) {
+		unsigned long long published = _published.load();
+		Slot& slot = _slots[published % 4];
+		slot.readers.fetch_add(1);
+
+		// Still the published version: the writer will not touch the slot until released.
+		if (_published.load() == published) return Snapshot<V>(&slot.value, &slot.readers, published / 4);
+		slot.readers.fetch_sub(1);
+	}
+}
+
+}	// Namespace parallel.
+}	// Namespace math.
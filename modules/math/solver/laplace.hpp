@@ -1,5 +1,6 @@
 #pragma once
 #include <math/function/square_grid.hpp>
+#include <math/function/fixed_storage.hpp>
 #include <math/solver/finite_element.hpp>
 #include <math/geometry/2D/simple_polygon.hpp>
 
@@ -12,15 +13,27 @@ enum class GridEdge {
 };
 
 
-template <typename T, typename E>
-class FDM : public math::function::SquareGrid<T, math::solver::FiniteElement<E>> {
-	// Copy auxiliary.
-	math::function::SquareGrid<T,E> _copy;
+template <typename T, typename E, typename Layout=math::function::RowMajorLayout, typename Storage=std::vector<math::solver::FiniteElement<E>>>
+class FDM : public math::function::SquareGrid<T, math::solver::FiniteElement<E>, Layout, Storage> {
+	// Copy auxiliary. Empty when the copy is borrowed from a workspace at every sweep.
+	math::function::SquareGrid<T,E,Layout,math::function::RebindStorage<Storage,E>> _copy;
+	math::memory::Workspace* _workspace;
+	
+	// Jacobi sweep reading from copy. Uniform frozen blocks of the storage are copied as a
+	// single value; when the blocks are tiles of the layout, they are skipped whole, and so
+	// are uniform tiles surrounded by the same value.
+	template <typename Copy>
+	void sweep(Copy& copy);
 	
 public:
 	// Set up constructor alinged with SquareGrid.
 	FDM(unsigned sizex, unsigned sizey, const T& spacing, math::linear::StaticVector<T,2> start = math::linear::StaticVector<T,2>())
-	: math::function::SquareGrid<T, math::solver::FiniteElement<E>>(sizex, sizey, spacing, start), _copy(sizex, sizey, spacing, start) {}
+	: math::function::SquareGrid<T, math::solver::FiniteElement<E>, Layout, Storage>(sizex, sizey, spacing, start), _copy(sizex, sizey, spacing, start), _workspace(nullptr) {}
+	
+	// Solver keeping no copy of its own: sweeps borrow it from the workspace, so many
+	// solvers, or solvers built over and over, share the same scratch memory.
+	FDM(unsigned sizex, unsigned sizey, const T& spacing, math::linear::StaticVector<T,2> start, math::memory::Workspace& workspace)
+	: math::function::SquareGrid<T, math::solver::FiniteElement<E>, Layout, Storage>(sizex, sizey, spacing, start), _copy(0, 0, spacing, start), _workspace(&workspace) {}
 
 	// Set up boundary terms.
 	FDM& setBoundary(GridEdge edge, const E& value = E());
@@ -32,8 +45,64 @@ public:
 };
 
 
-template <typename T, typename E>
-FDM<T,E>& FDM<T,E>::setBoundary(GridEdge edge, const E& value) {
+// FDM of at most NX x NY points, holding its values and its copy in place. Constructed
+// with the sizes, like FDM; sweeps see constant strides.
+template <typename T, typename E, unsigned NX, unsigned NY>
+using FixedFDM = FDM<T, E, math::function::FixedLayout<NX,NY>, math::function::FixedStorage<FiniteElement<E>, static_cast<math::index_t>(NX) * NY>>;
+
+
+namespace internal {
+
+// Side of the square tiles that storage blocks of blocksize values cover in the layout,
+// or zero when blocks are not tiles. Only TiledLayout with blocks of one tile maps them.
+template <typename Layout>
+unsigned blockTile(const Layout&, math::index_t) {
+	return 0;
+}
+
+template <unsigned Tile>
+unsigned blockTile(const math::function::TiledLayout<Tile>&, math::index_t blocksize) {
+	return (blocksize == static_cast<math::index_t>(Tile) * Tile) ? Tile : 0;
+}
+
+// Jacobi update of the rows of values, stored one after the other with a constant stride,
+// reading from copy in the same layout. Frozen points keep their value.
+template <unsigned Stride, typename Element, typename E>
+inline void sweepRows(Element* values, const E* copy, unsigned sx, unsigned sy) {
+	for (unsigned j = 1; j < sy-1; ++j) {
+		Element* row = values + static_cast<math::index_t>(j) * Stride;
+		const E* copied = copy + static_cast<math::index_t>(j) * Stride;
+		const E* above = copied + Stride;
+		const E* below = copied - Stride;
+		for (unsigned i = 1; i < sx-1; ++i) {
+			if (row[i].frozen()) continue;
+			E sum = copied[i+1] + copied[i-1] + above[i] + below[i];
+			row[i] = sum / 4.0;
+		}
+	}
+}
+
+// Sweep of grids with fixed layouts, row by row with constant strides, and constant bounds
+// when the grid fills its layout. False for other layouts, which sweep point by point.
+template <typename Layout, typename Grid, typename Copy>
+bool sweepRows(const Layout&, Grid&, Copy&) {
+	return false;
+}
+
+template <unsigned NX, unsigned NY, typename Grid, typename Copy>
+bool sweepRows(const math::function::FixedLayout<NX,NY>&, Grid& grid, Copy& copy) {
+	auto* values = grid.storage().data();
+	const auto* copied = copy.storage().data();
+	if (grid.sizex() == NX and grid.sizey() == NY) sweepRows<NX>(values, copied, NX, NY);
+	else sweepRows<NX>(values, copied, grid.sizex(), grid.sizey());
+	return true;
+}
+
+}	// Namespace internal.
+
+
+template <typename T, typename E, typename Layout, typename Storage>
+FDM<T,E,Layout,Storage>& FDM<T,E,Layout,Storage>::setBoundary(GridEdge edge, const E& value) {
 	if (edge == GridEdge::RightEdge) {
 		unsigned i = this->sizex() - 1;
 		unsigned sy = this->sizey();
@@ -65,15 +134,15 @@ FDM<T,E>& FDM<T,E>::setBoundary(GridEdge edge, const E& value) {
 	return *this;
 }
 
-template <typename T, typename E>
-FDM<T,E>& FDM<T,E>::setBoundary(unsigned i, unsigned j, const E& value) {
+template <typename T, typename E, typename Layout, typename Storage>
+FDM<T,E,Layout,Storage>& FDM<T,E,Layout,Storage>::setBoundary(unsigned i, unsigned j, const E& value) {
 	this->dataEvaluation(i, j) = value;
 	this->dataEvaluation(i, j).setFrozen(true);
 	return *this;
 }
 
-template <typename T, typename E>
-FDM<T,E>& FDM<T,E>::setBoundary(const math::geometry2::SimplePolygon<T>& polygon, const E& value) {
+template <typename T, typename E, typename Layout, typename Storage>
+FDM<T,E,Layout,Storage>& FDM<T,E,Layout,Storage>::setBoundary(const math::geometry2::SimplePolygon<T>& polygon, const E& value) {
 	// Get the grid size.
 	unsigned sx = this->sizex();
 	unsigned sy = this->sizey();
@@ -90,40 +159,174 @@ FDM<T,E>& FDM<T,E>::setBoundary(const math::geometry2::SimplePolygon<T>& polygon
 		}
 	}
 	
+	// Blocks now inside the polygon are uniform again.
+	using math::function::compactStorage;
+	compactStorage(this->storage(), [](const FiniteElement<E>& a, const FiniteElement<E>& b) {
+		return a.value() == b.value() and a.frozen() == b.frozen();
+	});
+	
 	return *this;
 }
 
-template <typename T, typename E>
-void FDM<T,E>::naiveIteration() {
+template <typename T, typename E, typename Layout, typename Storage>
+void FDM<T,E,Layout,Storage>::naiveIteration() {
+	if (_workspace == nullptr) {
+		sweep(_copy);
+		return;
+	}
+	
+	math::function::WorkspaceStorage<E> storage(*_workspace, this->layout().size());
+	math::function::SquareGrid<T,E,Layout,math::function::WorkspaceStorage<E>> copy(this->sizex(), this->sizey(), this->spacing(), this->start(), std::move(storage));
+	sweep(copy);
+}
+
+template <typename T, typename E, typename Layout, typename Storage>
+template <typename Copy>
+void FDM<T,E,Layout,Storage>::sweep(Copy& copy) {
 	// Set up sizes.
 	unsigned sx = this->sizex();
 	unsigned sy = this->sizey();
 	
-	// Copy data.
-	for (unsigned i = 0; i < sx; ++i) {
-		for (unsigned j = 0; j < sy; ++j) {
-			_copy.dataEvaluation(i,j) = this->dataEvaluation(i,j).value();
+	// Block structure of the storage. Unqualified calls, so storages can overload them.
+	using math::function::storageBlockSize;
+	using math::function::uniformBlock;
+	using math::function::fillBlock;
+	
+	// Read only through const access, so sparse storages are not materialised.
+	const Storage& data = this->storage();
+	const auto& copied = copy;
+	auto& values = copy.storage();
+	
+	// Copy data, in storage order. Uniform blocks are copied as a single value when the
+	// copy has the same blocks, as the own copy has; otherwise over their index range.
+	math::index_t size = data.size();
+	math::index_t blocksize = storageBlockSize(data);
+	bool sameBlocks = (storageBlockSize(values) == blocksize);
+	for (math::index_t first = 0; first < size; first += blocksize) {
+		math::index_t block = first / blocksize;
+		math::index_t last = std::min(first + blocksize, size);
+		if (uniformBlock(data, block)) {
+			const E& value = data[first].value();
+			if (sameBlocks) fillBlock(values, block, value);
+			else for (math::index_t k = first; k < last; ++k) values[k] = value;
+			continue;
 		}
+		
+		for (math::index_t k = first; k < last; ++k) values[k] = data[k].value();
 	}
 	
 	
-	for (unsigned i = 1; i < sx-1; ++i) {
+	// Frozen points, and so uniform frozen blocks, are never written. In storages of many
+	// blocks, neither are values left unchanged, which would materialise uniform blocks.
+	bool blocked = (blocksize < size);
+	auto update = [&](unsigned i, unsigned j) {
+		const FiniteElement<E>& point = data[this->datafromij(i, j)];
+		if (point.frozen()) return;
+		
+		E sum = 
+			+ copied.dataEvaluation(i+1, j)
+			+ copied.dataEvaluation(i-1, j)
+			+ copied.dataEvaluation(i, j+1)
+			+ copied.dataEvaluation(i, j-1)
+		;
+		
+		E value = sum / 4.0;
+		if (blocked and value == point.value()) return;
+		this->dataEvaluation(i, j) = value;
+	};
+	
+	// Whether the points around [ibegin,iend) x [jbegin,jend) all hold value in the copy.
+	auto surrounded = [&](unsigned ibegin, unsigned iend, unsigned jbegin, unsigned jend, const E& value) {
+		for (unsigned i = ibegin; i < iend; ++i) {
+			if (copied.dataEvaluation(i, jbegin-1) != value or copied.dataEvaluation(i, jend) != value) return false;
+		}
+		for (unsigned j = jbegin; j < jend; ++j) {
+			if (copied.dataEvaluation(ibegin-1, j) != value or copied.dataEvaluation(iend, j) != value) return false;
+		}
+		return true;
+	};
+	
+	// Fixed layouts: over contiguous rows.
+	if (internal::sweepRows(this->layout(), *this, copy)) return;
+	
+	// Blocks that are not tiles of the grid: point by point, row by row.
+	unsigned tile = internal::blockTile(this->layout(), blocksize);
+	if (tile == 0) {
 		for (unsigned j = 1; j < sy-1; ++j) {
-			if (this->dataEvaluation(i, j).frozen()) continue;
+			for (unsigned i = 1; i < sx-1; ++i) update(i, j);
+		}
+		return;
+	}
+	
+	// Tile by tile, in storage order, skipping the uniform frozen ones, and the uniform ones
+	// surrounded by their own value, which a sweep leaves as they are.
+	unsigned tilesx = (sx + tile - 1) / tile;
+	unsigned tilesy = (sy + tile - 1) / tile;
+	for (unsigned ty = 0; ty < tilesy; ++ty) {
+		for (unsigned tx = 0; tx < tilesx; ++tx) {
+			math::index_t block = static_cast<math::index_t>(ty) * tilesx + tx;
+			unsigned ibegin = std::max(tx * tile, 1u), iend = std::min((tx + 1) * tile, sx - 1);
+			unsigned jbegin = std::max(ty * tile, 1u), jend = std::min((ty + 1) * tile, sy - 1);
+			if (uniformBlock(data, block)) {
+				const FiniteElement<E>& point = data[block * blocksize];
+				if (point.frozen() or surrounded(ibegin, iend, jbegin, jend, point.value())) continue;
+			}
 			
-			E sum = 
-				+ _copy.dataEvaluation(i+1, j)
-				+ _copy.dataEvaluation(i-1, j)
-				+ _copy.dataEvaluation(i, j+1)
-				+ _copy.dataEvaluation(i, j-1)
-			;
-		
-			this->dataEvaluation(i, j) = sum / 4.0;
+			for (unsigned j = jbegin; j < jend; ++j) {
+				for (unsigned i = ibegin; i < iend; ++i) update(i, j);
+			}
 		}
 	}
 }
 
 
+namespace internal {
+
+template <typename Grid>
+using SweepValue = typename std::decay<decltype(std::declval<Grid&>().dataEvaluation(0,0).value())>::type;
+
+// Jacobi sweep of grid reading from copy, with room for sizex*sizey values.
+template <typename Grid, typename E>
+void naiveIteration(Grid& grid, E* copy) {
+	unsigned sx = grid.sizex();
+	unsigned sy = grid.sizey();
+	
+	// Copy data.
+	const Grid& reader = grid;
+	for (unsigned j = 0; j < sy; ++j) {
+		for (unsigned i = 0; i < sx; ++i) copy[static_cast<std::size_t>(j) * sx + i] = reader.dataEvaluation(i,j).value();
+	}
+	
+	for (unsigned j = 1; j < sy-1; ++j) {
+		for (unsigned i = 1; i < sx-1; ++i) {
+			if (reader.dataEvaluation(i, j).frozen()) continue;
+			
+			std::size_t k = static_cast<std::size_t>(j) * sx + i;
+			E sum = copy[k+1] + copy[k-1] + copy[k+sx] + copy[k-sx];
+			grid.dataEvaluation(i, j) = sum / 4.0;
+		}
+	}
+}
+
+}	// Namespace internal.
+
+// Jacobi sweep over any grid of finite elements, such as a view of a sub-domain of an FDM.
+// Points on the edges of the grid are kept as they are, like frozen points.
+template <typename Grid>
+void naiveIteration(Grid& grid) {
+	if (grid.sizex() < 3 or grid.sizey() < 3) return;
+	std::vector<internal::SweepValue<Grid>> copy(static_cast<std::size_t>(grid.sizex()) * grid.sizey());
+	internal::naiveIteration(grid, copy.data());
+}
+
+// Same sweep, with the copy borrowed from the workspace.
+template <typename Grid>
+void naiveIteration(Grid& grid, math::memory::Workspace& workspace) {
+	if (grid.sizex() < 3 or grid.sizey() < 3) return;
+	math::function::WorkspaceStorage<internal::SweepValue<Grid>> copy(workspace, static_cast<math::index_t>(grid.sizex()) * grid.sizey());
+	internal::naiveIteration(grid, copy.data());
+}
+
 }
 }
 }
\ No newline at end of file
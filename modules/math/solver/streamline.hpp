@@ -0,0 +1,339 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <math/linear/static_vector.hpp>
+#include <math/geometry/2D/polygonal_chain.hpp>
+#include <math/parallel/parallel_for.hpp>
+
+namespace math {
+namespace solver {
+
+enum class StreamlineMethod {
+	RK4,		// Classic Runge-Kutta, fixed step.
+	RK45		// Dormand-Prince 5(4), adaptive step.
+};
+
+// Why a streamline ended.
+enum class StreamlineStop {
+	Domain,		// Left the domain of the field. The last vertex is on its edge.
+	Frozen,		// Reached a frozen region. The last vertex is inside it.
+	Stagnation,	// Reached a point where the field vanishes.
+	Steps		// Took the maximum number of steps.
+};
+
+template <typename T>
+struct StreamlineOptions {
+	StreamlineMethod method = StreamlineMethod::RK4;
+	T step = T(0.01);				// Step of RK4, first step of RK45.
+	T tolerance = T(1e-6);			// Local error allowed per RK45 step.
+	T minimumStep = T(1e-6);		// Bounds of the RK45 step.
+	T maximumStep = T(0.1);
+	T stagnation = T(1e-12);		// Field magnitude below which a streamline stops.
+	unsigned maximumSteps = 1000;	// Accepted steps per streamline.
+	bool normalize = true;			// Follow the direction of the field, stepping in arc length.
+	bool backward = false;			// Trace against the field.
+	unsigned batchSize = 256;		// Seeds advanced in lockstep.
+	unsigned threads = 1;			// Threads over batches. Zero uses all of them.
+};
+
+
+namespace internal {
+
+// Butcher tableaus. Weights b give the solution, weights e its error estimate.
+template <typename T>
+struct StreamlineTableau {
+	unsigned stages;
+	bool adaptive;
+	T a[7][7];
+	T b[7];
+	T e[7];
+};
+
+template <typename T>
+const StreamlineTableau<T>& streamlineTableau(StreamlineMethod method) {
+	static const StreamlineTableau<T> rk4 = {
+		4, false,
+		{
+			{T(0.0)},
+			{T(0.5)},
+			{T(0.0), T(0.5)},
+			{T(0.0), T(0.0), T(1.0)}
+		},
+		{T(1.0/6.0), T(1.0/3.0), T(1.0/3.0), T(1.0/6.0)},
+		{T(0.0)}
+	};
+
+	static const StreamlineTableau<T> rk45 = {
+		7, true,
+		{
+			{T(0.0)},
+			{T(1.0/5.0)},
+			{T(3.0/40.0), T(9.0/40.0)},
+			{T(44.0/45.0), T(-56.0/15.0), T(32.0/9.0)},
+			{T(19372.0/6561.0), T(-25360.0/2187.0), T(64448.0/6561.0), T(-212.0/729.0)},
+			{T(9017.0/3168.0), T(-355.0/33.0), T(46732.0/5247.0), T(49.0/176.0), T(-5103.0/18656.0)},
+			{T(35.0/384.0), T(0.0), T(500.0/1113.0), T(125.0/192.0), T(-2187.0/6784.0), T(11.0/84.0)}
+		},
+		{T(35.0/384.0), T(0.0), T(500.0/1113.0), T(125.0/192.0), T(-2187.0/6784.0), T(11.0/84.0), T(0.0)},
+		{
+			T(35.0/384.0 - 5179.0/57600.0), T(0.0), T(500.0/1113.0 - 7571.0/16695.0), T(125.0/192.0 - 393.0/640.0),
+			T(-2187.0/6784.0 + 92097.0/339200.0), T(11.0/84.0 - 187.0/2100.0), T(-1.0/40.0)
+		}
+	};
+
+	return (method == StreamlineMethod::RK4) ? rk4 : rk45;
+}
+
+// Frozen regions of fields without any.
+struct NoFrozenRegion {
+	template <typename V>
+	bool operator()(const V&) const {return false;}
+};
+
+template <typename T, typename Field>
+bool insideField(const Field& field, const math::linear::StaticVector<T,2>& point) {
+	return point.x() >= field.start().x() and point.y() >= field.start().y()
+		and point.x() <= field.end().x() and point.y() <= field.end().y();
+}
+
+// Point of the segment from inside to outside on the edge of the domain.
+template <typename T, typename Field>
+math::linear::StaticVector<T,2> clipToField(const Field& field, const math::linear::StaticVector<T,2>& inside, const math::linear::StaticVector<T,2>& outside) {
+	T fraction = T(1.0);
+	for (unsigned c = 0; c < 2; ++c) {
+		T delta = outside[c] - inside[c];
+		if (outside[c] < field.start()[c]) fraction = std::min(fraction, (field.start()[c] - inside[c]) / delta);
+		if (outside[c] > field.end()[c]) fraction = std::min(fraction, (field.end()[c] - inside[c]) / delta);
+	}
+
+	math::linear::StaticVector<T,2> point = inside + std::max(fraction, T(0.0)) * (outside - inside);
+	for (unsigned c = 0; c < 2; ++c) point[c] = std::min(std::max(point[c], field.start()[c]), field.end()[c]);
+	return point;
+}
+
+// Trace the seeds [first, last) in lockstep: every stage of the integrator evaluates the
+// field at the stage points of all the running streamlines in a single batched call.
+template <typename T, typename Field, typename Frozen>
+void traceBatch(const Field& field, const std::vector<math::linear::StaticVector<T,2>>& seeds, unsigned first, unsigned last,
+	const StreamlineOptions<T>& options, const Frozen& frozen,
+	std::vector<std::vector<math::linear::StaticVector<T,2>>>& vertices, std::vector<StreamlineStop>& stops) {
+	using Point = math::linear::StaticVector<T,2>;
+	using Value = typename std::decay<decltype(field.evaluate(std::declval<const Point&>()))>::type;
+	const StreamlineTableau<T>& tableau = streamlineTableau<T>(options.method);
+	T sign = options.backward ? T(-1.0) : T(1.0);
+
+	unsigned count = last - first;
+	std::vector<Point> position(count);
+	std::vector<T> step(count, options.step);
+	std::vector<unsigned> steps(count, 0);
+	std::vector<unsigned> running;
+	running.reserve(count);
+
+	for (unsigned s = 0; s < count; ++s) {
+		const Point& seed = seeds[first + s];
+		position[s] = seed;
+		vertices[first + s].assign(1, seed);
+		if (not insideField<T>(field, seed)) stops[first + s] = StreamlineStop::Domain;
+		else if (frozen(seed)) stops[first + s] = StreamlineStop::Frozen;
+		else if (options.maximumSteps == 0) stops[first + s] = StreamlineStop::Steps;
+		else running.push_back(s);
+	}
+
+	// Stage slopes of the running streamlines, and the points evaluated in one call.
+	std::vector<Point> slopes(static_cast<std::size_t>(count) * tableau.stages);
+	std::vector<unsigned> evaluated;
+	std::vector<Point> coords;
+	std::vector<Value> values;
+	std::vector<char> outside(count);
+
+	while (not running.empty()) {
+		for (unsigned s : running) outside[s] = 0;
+
+		for (unsigned stage = 0; stage < tableau.stages; ++stage) {
+			// Stage points still inside the domain.
+			evaluated.clear();
+			coords.clear();
+			for (unsigned s : running) {
+				if (outside[s]) continue;
+
+				Point point = position[s];
+				for (unsigned m = 0; m < stage; ++m) {
+					if (tableau.a[stage][m] != T(0.0)) point += (step[s] * tableau.a[stage][m]) * slopes[s * tableau.stages + m];
+				}
+
+				if (not insideField<T>(field, point)) {
+					outside[s] = 1;
+					continue;
+				}
+
+				evaluated.push_back(s);
+				coords.push_back(point);
+			}
+
+			field.evaluate(coords, values);
+			for (unsigned k = 0; k < evaluated.size(); ++k) {
+				Point slope({sign * static_cast<T>(values[k][0]), sign * static_cast<T>(values[k][1])});
+				T magnitude = std::sqrt(slope.dot());
+				if (options.normalize) slope = (magnitude > T(0.0)) ? slope / magnitude : Point();
+				slopes[evaluated[k] * tableau.stages + stage] = slope;
+
+				// A vanishing field at the current point ends the streamline.
+				if (stage == 0 and magnitude <= options.stagnation) outside[evaluated[k]] = 2;
+			}
+		}
+
+		unsigned kept = 0;
+		for (unsigned r = 0; r < running.size(); ++r) {
+			unsigned s = running[r];
+			std::vector<Point>& line = vertices[first + s];
+			const Point* slope = &slopes[s * tableau.stages];
+
+			if (outside[s] == 2) {
+				stops[first + s] = StreamlineStop::Stagnation;
+				continue;
+			}
+
+			// Some stage left the domain. Retry with a shorter step when possible,
+			// otherwise end on the edge, in the direction of the field.
+			if (outside[s] == 1) {
+				if (tableau.adaptive and step[s] > options.minimumStep) {
+					step[s] = std::max(step[s] * T(0.5), options.minimumStep);
+					running[kept++] = s;
+					continue;
+				}
+
+				line.push_back(clipToField<T>(field, position[s], position[s] + step[s] * slope[0]));
+				stops[first + s] = StreamlineStop::Domain;
+				continue;
+			}
+
+			Point next = position[s];
+			for (unsigned m = 0; m < tableau.stages; ++m) {
+				if (tableau.b[m] != T(0.0)) next += (step[s] * tableau.b[m]) * slope[m];
+			}
+
+			if (tableau.adaptive) {
+				Point error;
+				for (unsigned m = 0; m < tableau.stages; ++m) {
+					if (tableau.e[m] != T(0.0)) error += (step[s] * tableau.e[m]) * slope[m];
+				}
+
+				T norm = std::sqrt(error.dot());
+				T factor = (norm > T(0.0)) ? T(0.9) * std::pow(options.tolerance / norm, T(0.2)) : T(5.0);
+				factor = std::min(std::max(factor, T(0.2)), T(5.0));
+				bool accepted = (norm <= options.tolerance) or (step[s] <= options.minimumStep);
+				T current = step[s];
+				step[s] = std::min(std::max(step[s] * factor, options.minimumStep), options.maximumStep);
+
+				if (not accepted) {
+					running[kept++] = s;
+					continue;
+				}
+
+				if (not insideField<T>(field, next)) {
+					// Retry with a shorter step, to end the streamline close to the edge.
+					if (current > options.minimumStep) {
+						step[s] = std::max(current * T(0.5), options.minimumStep);
+						running[kept++] = s;
+						continue;
+					}
+
+					line.push_back(clipToField<T>(field, position[s], next));
+					stops[first + s] = StreamlineStop::Domain;
+					continue;
+				}
+			} else if (not insideField<T>(field, next)) {
+				line.push_back(clipToField<T>(field, position[s], next));
+				stops[first + s] = StreamlineStop::Domain;
+				continue;
+			}
+
+			position[s] = next;
+			line.push_back(next);
+			++steps[s];
+
+			if (frozen(next)) stops[first + s] = StreamlineStop::Frozen;
+			else if (steps[s] >= options.maximumSteps) stops[first + s] = StreamlineStop::Steps;
+			else running[kept++] = s;
+		}
+
+		running.resize(kept);
+	}
+}
+
+}	// Namespace internal.
+
+
+// Trace streamlines of a vector field from seeds, one polyline per seed, in order.
+// The field needs start(), end(), and the batched evaluate(coords, values) of SquareGrid:
+// the gradient() of a solution, or any grid of StaticVector. frozen(point) tells whether
+// a point is in a frozen region, where streamlines stop. Seeds are split in batches,
+// which threads trace independently, so results do not depend on the number of threads.
+template <typename T, typename Field, typename Frozen>
+std::vector<math::geometry2::PolygonalChain<T>> traceStreamlines(
+	const Field& field, const std::vector<math::linear::StaticVector<T,2>>& seeds,
+	const StreamlineOptions<T>& options, const Frozen& frozen, std::vector<StreamlineStop>* stops = nullptr) {
+	if (not (options.step > T(0.0))) throw std::invalid_argument("The streamline step must be positive.");
+	if (options.method == StreamlineMethod::RK45) {
+		if (not (options.tolerance > T(0.0))) throw std::invalid_argument("The streamline tolerance must be positive.");
+		if (not (options.minimumStep > T(0.0)) or options.maximumStep < options.minimumStep) throw std::invalid_argument("Invalid streamline step bounds.");
+	}
+
+	unsigned count = seeds.size();
+	unsigned batch = std::max(options.batchSize, 1u);
+	unsigned batches = (count + batch - 1) / batch;
+	std::vector<std::vector<math::linear::StaticVector<T,2>>> vertices(count);
+	std::vector<StreamlineStop> reasons(count, StreamlineStop::Steps);
+
+	math::parallel::parallelFor(0, batches, options.threads, [&](unsigned firstbatch, unsigned lastbatch) {
+		for (unsigned b = firstbatch; b < lastbatch; ++b) {
+			internal::traceBatch<T>(field, seeds, b * batch, std::min(b * batch + batch, count), options, frozen, vertices, reasons);
+		}
+	});
+
+	std::vector<math::geometry2::PolygonalChain<T>> lines(count);
+	for (unsigned s = 0; s < count; ++s) lines[s] = math::geometry2::PolygonalChain<T>(vertices[s]);
+	if (stops) *stops = std::move(reasons);
+	return lines;
+}
+
+template <typename T, typename Field>
+std::vector<math::geometry2::PolygonalChain<T>> traceStreamlines(
+	const Field& field, const std::vector<math::linear::StaticVector<T,2>>& seeds,
+	const StreamlineOptions<T>& options = StreamlineOptions<T>(), std::vector<StreamlineStop>* stops = nullptr) {
+	return traceStreamlines(field, seeds, options, internal::NoFrozenRegion(), stops);
+}
+
+
+// Frozen region of a solver grid: points whose nearest grid point is frozen.
+template <typename Grid>
+class FrozenRegion {
+	const Grid& _grid;
+
+public:
+	explicit FrozenRegion(const Grid& grid) : _grid(grid) {}
+
+	template <typename Point>
+	bool operator()(const Point& point) const {
+		auto x = (point.x() - _grid.start().x()) / _grid.spacing();
+		auto y = (point.y() - _grid.start().y()) / _grid.spacing();
+		if (x < 0 or y < 0) return false;
+
+		unsigned i = static_cast<unsigned>(std::lround(x));
+		unsigned j = static_cast<unsigned>(std::lround(y));
+		if (i >= _grid.sizex() or j >= _grid.sizey()) return false;
+		return _grid.dataEvaluation(i,j).frozen();
+	}
+};
+
+template <typename Grid>
+FrozenRegion<Grid> frozenRegion(const Grid& grid) {
+	return FrozenRegion<Grid>(grid);
+}
+
+}	// Namespace solver.
+}	// Namespace math.
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <math/function/square_grid.hpp>
+#include <math/function/compact_storage.hpp>
+#include <math/function/grid_expression.hpp>
+#include <math/function/grid_reduction.hpp>
+
+
+TEST(CompactStorage, HalfConversion) {
+	using Codec = math::function::HalfCodec;
+	EXPECT_EQ(Codec::encode(1.0f), 0x3c00);
+	EXPECT_EQ(Codec::encode(-2.0f), 0xc000);
+	EXPECT_EQ(Codec::encode(65504.0f), 0x7bff);
+	EXPECT_EQ(Codec::encode(1e6f), 0x7c00);
+	EXPECT_EQ(Codec::encode(std::ldexp(1.0f, -24)), 0x0001);
+	EXPECT_EQ(Codec::encode(std::ldexp(1.0f, -14)), 0x0400);
+
+	// Ties round to even.
+	EXPECT_EQ(Codec::encode(1.0f + std::ldexp(1.0f, -11)), 0x3c00);
+	EXPECT_EQ(Codec::encode(1.0f + 3.0f * std::ldexp(1.0f, -11)), 0x3c02);
+
+	// Every finite half round trips.
+	for (unsigned code = 0; code < 0x10000; ++code) {
+		if ((code & 0x7c00) == 0x7c00) continue;
+		auto half = static_cast<Codec::code_type>(code);
+		EXPECT_EQ(Codec::encode(Codec::decode(half)), half);
+	}
+
+	EXPECT_FLOAT_EQ(Codec::decode(0x3555), 0.333251953125f);
+	EXPECT_TRUE(std::isinf(Codec::decode(0xfc00)));
+	EXPECT_TRUE(std::isnan(Codec::decode(Codec::encode(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(CompactStorage, BFloat16Conversion) {
+	using Codec = math::function::BFloat16Codec;
+	EXPECT_EQ(Codec::encode(1.0f), 0x3f80);
+	EXPECT_EQ(Codec::encode(-3.0e38f), 0xff62);
+	EXPECT_FLOAT_EQ(Codec::decode(Codec::encode(0.15625f)), 0.15625f);
+	EXPECT_NEAR(Codec::decode(Codec::encode(3.14159f)), 3.14159f, 0.01f);
+	EXPECT_TRUE(std::isnan(Codec::decode(Codec::encode(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(CompactStorage, ScaledInt16Conversion) {
+	auto codec = math::function::ScaledInt16Codec::range(-10.0f, 30.0f);
+	EXPECT_FLOAT_EQ(codec.offset(), 10.0f);
+	EXPECT_FLOAT_EQ(codec.decode(codec.encode(-10.0f)), -10.0f);
+	EXPECT_FLOAT_EQ(codec.decode(codec.encode(30.0f)), 30.0f);
+	for (float value = -10.0f; value <= 30.0f; value += 0.173f) EXPECT_LE(std::fabs(codec.decode(codec.encode(value)) - value), 0.5f * codec.scale() * 1.001f);
+
+	// Saturates outside of the range.
+	EXPECT_FLOAT_EQ(codec.decode(codec.encode(100.0f)), 30.0f);
+	EXPECT_FLOAT_EQ(codec.decode(codec.encode(-100.0f)), -10.0f);
+
+	EXPECT_THROW(math::function::ScaledInt16Codec::range(1.0f, 1.0f), std::invalid_argument);
+	EXPECT_THROW(math::function::ScaledInt16Codec(0.0f, -1.0f), std::invalid_argument);
+}
+
+TEST(CompactStorage, BulkConversion) {
+	math::function::HalfStorage storage(100);
+	std::vector<float> values(100);
+	for (unsigned k = 0; k < 100; ++k) values[k] = 0.25f * static_cast<float>(k) - 3.0f;
+	storage.encode(0, 100, values.data());
+
+	std::vector<float> decoded(50);
+	storage.decode(25, 50, decoded.data());
+	for (unsigned k = 0; k < 50; ++k) EXPECT_FLOAT_EQ(decoded[k], values[k + 25]);
+
+	// Element access converts one value.
+	storage[10] = 7.5f;
+	storage[11] += 1.0f;
+	const auto& constant = storage;
+	EXPECT_FLOAT_EQ(constant[10], 7.5f);
+	EXPECT_FLOAT_EQ(constant[11], values[11] + 1.0f);
+}
+
+template <typename Codec>
+void check_compact_grid(const Codec& codec, float tolerance) {
+	using Storage = math::function::CompactStorage<Codec>;
+	math::function::SquareGrid<float> exact(41, 31, 0.05f);
+	math::function::SquareGrid<float, float, math::function::RowMajorLayout, Storage> compact(41, 31, 0.05f, math::linear::StaticVector<float,2>(), Storage(exact.storage().size(), codec));
+	EXPECT_EQ(sizeof(*compact.storage().data()), 2u);
+
+	for (unsigned i = 0; i < exact.sizex(); ++i) {
+		for (unsigned j = 0; j < exact.sizey(); ++j) {
+			auto point = exact.domainfromij(i,j);
+			exact.dataEvaluation(i,j) = std::sin(point.x()) * std::cos(point.y()) + 2.0f;
+		}
+	}
+
+	// Filled from a float grid in a single loop over the storage.
+	compact = math::function::GridTerminal<decltype(exact)>(exact);
+
+	std::vector<math::linear::StaticVector<float,2>> coords;
+	for (float x = 0.0f; x <= 2.0f; x += 0.13f) coords.push_back(math::linear::StaticVector<float,2>({x, 0.6f * x}));
+	std::vector<float> values;
+	compact.evaluate(coords, values);
+	for (unsigned k = 0; k < coords.size(); ++k) {
+		EXPECT_NEAR(values[k], exact.evaluate(coords[k]), tolerance);
+		EXPECT_NEAR(compact.evaluate_partial_x(coords[k]), exact.evaluate_partial_x(coords[k]), 40.0f * tolerance);
+	}
+
+	// Reductions widen to float.
+	auto compactStatistics = math::function::statistics(compact);
+	auto exactStatistics = math::function::statistics(exact);
+	EXPECT_EQ(compactStatistics.count, exactStatistics.count);
+	EXPECT_NEAR(compactStatistics.mean(), exactStatistics.mean(), tolerance);
+	EXPECT_NEAR(compactStatistics.maximum, exactStatistics.maximum, tolerance);
+
+	// Gradients are full precision grids.
+	auto gradient = compact.gradient();
+	EXPECT_NEAR(gradient.dataEvaluation(10,10).x(), exact.gradient().dataEvaluation(10,10).x(), 40.0f * tolerance);
+}
+
+TEST(CompactStorage, Grids) {
+	check_compact_grid(math::function::HalfCodec(), 2e-3f);
+	check_compact_grid(math::function::BFloat16Codec(), 2e-2f);
+	check_compact_grid(math::function::ScaledInt16Codec::range(0.0f, 4.0f), 1e-4f);
+}
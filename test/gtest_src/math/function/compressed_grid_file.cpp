@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <math/function/square_grid.hpp>
+#include <math/function/compressed_grid_file.hpp>
+
+
+template <typename E>
+math::function::SquareGrid<E, E> make_smooth_grid(unsigned sizex, unsigned sizey) {
+	math::function::SquareGrid<E, E> grid(sizex, sizey, 0.01);
+	for (unsigned i = 0; i < sizex; ++i) {
+		for (unsigned j = 0; j < sizey; ++j) {
+			auto point = grid.domainfromij(i,j);
+			grid.dataEvaluation(i,j) = std::sin(3.0*point.x()) * std::cos(2.0*point.y()) + point.x()*point.y();
+		}
+	}
+	
+	grid.dataEvaluation(3,4) = -0.0;
+	grid.dataEvaluation(5,1) = 1e30;
+	return grid;
+}
+
+TEST(CompressedGridFile, Lossless) {
+	std::string path = testing::TempDir() + "compressed_grid_lossless_test.bin";
+	auto grid = make_smooth_grid<double>(150, 70);
+	
+	math::function::CompressionOptions options;
+	options.tileSize = 32;
+	options.threads = 3;
+	math::function::saveCompressedGrid(path, grid, options);
+	
+	math::function::CompressedGridReader<double, double> reader(path);
+	EXPECT_EQ(reader.sizex(), 150u);
+	EXPECT_EQ(reader.sizey(), 70u);
+	EXPECT_EQ(reader.tilesx(), 5u);
+	EXPECT_EQ(reader.tilesy(), 3u);
+	EXPECT_LT(reader.compressedSize(), 150u * 70u * sizeof(double));
+	
+	auto whole = reader.read(2);
+	for (unsigned i = 0; i < grid.sizex(); ++i) {
+		for (unsigned j = 0; j < grid.sizey(); ++j) {
+			EXPECT_EQ(whole.dataEvaluation(i,j), grid.dataEvaluation(i,j));
+		}
+	}
+	EXPECT_TRUE(std::signbit(whole.dataEvaluation(3,4)));
+	
+	// Random access.
+	EXPECT_EQ(reader.dataEvaluation(149, 69), grid.dataEvaluation(149, 69));
+	EXPECT_EQ(reader.dataEvaluation(40, 33), grid.dataEvaluation(40, 33));
+	EXPECT_NEAR(reader.evaluate(0.724, 0.318), grid.evaluate(0.724, 0.318), 1e-12);
+	
+	auto region = reader.read(30, 20, 40, 15);
+	EXPECT_EQ(region.start(), grid.domainfromij(30, 20));
+	for (unsigned i = 0; i < region.sizex(); ++i) {
+		for (unsigned j = 0; j < region.sizey(); ++j) {
+			EXPECT_EQ(region.dataEvaluation(i,j), grid.dataEvaluation(30+i, 20+j));
+		}
+	}
+	
+	EXPECT_THROW(reader.read(140, 0, 20, 5), std::invalid_argument);
+	std::remove(path.c_str());
+}
+
+TEST(CompressedGridFile, ErrorBounded) {
+	std::string path = testing::TempDir() + "compressed_grid_lossy_test.bin";
+	auto grid = make_smooth_grid<float>(100, 90);
+	
+	math::function::CompressionOptions options;
+	options.tileSize = 16;
+	options.errorBound = 1e-3;
+	math::function::saveCompressedGrid(path, grid, options);
+	
+	math::function::CompressedGridReader<float, float> reader(path, 4);
+	EXPECT_DOUBLE_EQ(reader.errorBound(), 1e-3);
+	EXPECT_LT(reader.compressedSize(), 100u * 90u * sizeof(float) / 3);
+	
+	auto whole = reader.read();
+	for (unsigned i = 0; i < grid.sizex(); ++i) {
+		for (unsigned j = 0; j < grid.sizey(); ++j) {
+			EXPECT_LE(std::abs(whole.dataEvaluation(i,j) - grid.dataEvaluation(i,j)), 1e-3);
+			EXPECT_EQ(reader.dataEvaluation(i,j), whole.dataEvaluation(i,j));
+		}
+	}
+	
+	EXPECT_THROW((math::function::CompressedGridReader<double, double>(path)), std::runtime_error);
+	std::remove(path.c_str());
+}
+
+TEST(CompressedGridFile, CacheAndHeaderChecks) {
+	std::string path = testing::TempDir() + "compressed_grid_checks_test.bin";
+	auto grid = make_smooth_grid<double>(40, 30);
+	
+	math::function::CompressionOptions options;
+	options.tileSize = 16;
+	math::function::saveCompressedGrid(path, grid, options);
+	
+	// Tiles stay valid after the cache evicts them.
+	{
+		math::function::CompressedGridReader<double, double> reader(path, 1);
+		auto first = reader.tile(0, 0);
+		auto last = reader.tile(2, 1);
+		EXPECT_EQ(reader.dataEvaluation(20, 20), grid.dataEvaluation(20, 20));
+		ASSERT_EQ(first->size(), 16u * 16u);
+		ASSERT_EQ(last->size(), 8u * 14u);
+		EXPECT_EQ((*first)[5*16 + 3], grid.dataEvaluation(3, 5));
+		EXPECT_EQ((*last)[13*8 + 7], grid.dataEvaluation(39, 29));
+	}
+	
+	// Headers with empty tiles, or tiles not covering the grid, are rejected.
+	auto patch = [&](std::size_t offset, std::uint32_t value) {
+		std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+		file.seekp(offset);
+		file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	};
+	patch(offsetof(math::function::CompressedGridFileHeader, tilesx), 2);
+	EXPECT_THROW((math::function::CompressedGridReader<double, double>(path)), std::runtime_error);
+	patch(offsetof(math::function::CompressedGridFileHeader, tilesx), 3);
+	patch(offsetof(math::function::CompressedGridFileHeader, tileSize), 0);
+	EXPECT_THROW((math::function::CompressedGridReader<double, double>(path)), std::runtime_error);
+	patch(offsetof(math::function::CompressedGridFileHeader, tileSize), 16);
+	EXPECT_NO_THROW((math::function::CompressedGridReader<double, double>(path)));
+	std::remove(path.c_str());
+}
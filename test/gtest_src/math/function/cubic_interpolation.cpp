@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <math/function/square_grid.hpp>
+#include <math/function/cubic_interpolation.hpp>
+
+
+TEST(CubicInterpolation, CatmullRom) {
+	unsigned size = 11;
+	math::function::SquareGrid<double, double> grid(size, size, 0.1);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			auto point = grid.domainfromij(i,j);
+			grid.dataEvaluation(i,j) = point.x()*point.x() - 2.0*point.x()*point.y() + 0.5*point.y();
+		}
+	}
+	
+	math::function::CubicInterpolator<double> cubic(grid);
+	
+	// Goes through the grid values.
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			EXPECT_NEAR(cubic.evaluate(grid.domainfromij(i,j)), grid.dataEvaluation(i,j), 1e-12);
+		}
+	}
+	
+	// Exact for quadratics away from the edges, where bilinear interpolation is not.
+	math::linear::StaticVector<double, 2> coord({0.437, 0.561});
+	double exact = 0.437*0.437 - 2.0*0.437*0.561 + 0.5*0.561;
+	EXPECT_NEAR(cubic.evaluate(coord), exact, 1e-12);
+	EXPECT_GT(std::abs(grid.evaluate(coord) - exact), 1e-4);
+	
+	auto gradient = cubic.evaluate_gradient(coord);
+	EXPECT_NEAR(gradient.x(), 2.0*0.437 - 2.0*0.561, 1e-10);
+	EXPECT_NEAR(gradient.y(), -2.0*0.437 + 0.5, 1e-10);
+	
+	// Batched evaluation.
+	std::vector<math::linear::StaticVector<double, 2>> coords({coord, math::linear::StaticVector<double, 2>({1.0, 1.0})});
+	std::vector<double> values;
+	cubic.evaluate(coords, values);
+	EXPECT_NEAR(values[0], exact, 1e-12);
+	EXPECT_NEAR(values[1], grid.dataEvaluation(size-1, size-1), 1e-12);
+	EXPECT_THROW(cubic.evaluate(1.01, 0.5), std::invalid_argument);
+}
+
+TEST(CubicInterpolation, BSpline) {
+	unsigned size = 8;
+	math::function::SquareGrid<float, float> grid(size, size, 0.5);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			auto point = grid.domainfromij(i,j);
+			grid.dataEvaluation(i,j) = 3.0*point.x() - point.y() + 1.0;
+		}
+	}
+	
+	// Approximating, but exact for linear functions away from the edges.
+	math::function::CubicInterpolator<float> spline(grid, math::function::CubicKernel::BSpline);
+	EXPECT_NEAR(spline.evaluate(1.3, 2.2), 3.0*1.3 - 2.2 + 1.0, 1e-4);
+	EXPECT_NEAR(spline.evaluate_gradient(math::linear::StaticVector<float, 2>({1.7, 1.1})).x(), 3.0, 1e-4);
+	EXPECT_NEAR(spline.evaluate_gradient(math::linear::StaticVector<float, 2>({1.7, 1.1})).y(), -1.0, 1e-4);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <math/function/differential.hpp>
+
+
+TEST(DifferentialOperators, FusedOperators) {
+	unsigned size = 9;
+	float step = 1 / (static_cast<float>(size-1));
+	
+	// Quadratic function: central differences are exact.
+	math::function::SquareGrid<float, float> phi(size, size, step);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			auto point = phi.domainfromij(i,j);
+			phi.dataEvaluation(i, j) = point.x()*point.x() + 2.0*point.y()*point.y();
+		}
+	}
+	
+	// Preallocated outputs.
+	auto gradient = math::function::interiorGrid<math::linear::StaticVector<float,2>>(phi);
+	auto magnitude = math::function::interiorGrid<float>(phi);
+	auto laplacian = math::function::interiorGrid<float>(phi);
+	
+	math::function::DifferentialOutputs<float, float> outputs;
+	outputs.gradient = &gradient;
+	outputs.gradientMagnitude = &magnitude;
+	outputs.laplacian = &laplacian;
+	math::function::fusedDifferential(phi, outputs, 3);
+	
+	auto reference = phi.gradient();
+	for (unsigned i = 0; i < gradient.sizex(); ++i) {
+		for (unsigned j = 0; j < gradient.sizey(); ++j) {
+			auto point = gradient.domainfromij(i,j);
+			EXPECT_EQ(gradient.domainfromij(i,j), reference.domainfromij(i,j));
+			EXPECT_NEAR(gradient.dataEvaluation(i,j).x(), 2.0*point.x(), 1e-4);
+			EXPECT_NEAR(gradient.dataEvaluation(i,j).y(), 4.0*point.y(), 1e-4);
+			EXPECT_NEAR(magnitude.dataEvaluation(i,j), std::sqrt(4.0*point.x()*point.x() + 16.0*point.y()*point.y()), 1e-4);
+			EXPECT_NEAR(laplacian.dataEvaluation(i,j), 6.0, 1e-2);
+		}
+	}
+	
+	// Divergence and curl of a rotation plus a dilation field.
+	math::function::SquareGrid<float, math::linear::StaticVector<float,2>> field(size, size, step);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			auto point = field.domainfromij(i,j);
+			field.dataEvaluation(i, j) = math::linear::StaticVector<float,2>({point.x() - point.y(), point.x() + point.y()});
+		}
+	}
+	
+	auto divergence = math::function::interiorGrid<float>(field);
+	auto curl = math::function::interiorGrid<float>(field);
+	math::function::divergence(field, divergence, 2);
+	math::function::curl(field, curl);
+	for (unsigned i = 0; i < divergence.sizex(); ++i) {
+		for (unsigned j = 0; j < divergence.sizey(); ++j) {
+			EXPECT_NEAR(divergence.dataEvaluation(i,j), 2.0, 1e-4);
+			EXPECT_NEAR(curl.dataEvaluation(i,j), 2.0, 1e-4);
+		}
+	}
+	
+	// Wrong output sizes are rejected.
+	math::function::SquareGrid<float, float> wrong(size, size, step);
+	EXPECT_THROW(math::function::laplacian(phi, wrong), std::invalid_argument);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <math/function/fixed_square_grid.hpp>
+#include <math/function/differential.hpp>
+#include <math/solver/laplace.hpp>
+
+
+TEST(FixedSquareGrid, ConstantSizes) {
+	using Grid = math::function::FixedSquareGrid<float, float, 16, 8>;
+	static_assert(Grid::sizex() == 16 and Grid::sizey() == 8, "Sizes are constants");
+	static_assert(Grid::datafromij(3, 2) == 35, "Index math is constant");
+	EXPECT_GE(sizeof(Grid), 16 * 8 * sizeof(float));
+
+	Grid grid(0.5);
+	for (unsigned i = 0; i < 16; ++i) {
+		for (unsigned j = 0; j < 8; ++j) EXPECT_FLOAT_EQ(grid.dataEvaluation(i,j), 0.0);
+	}
+
+	// Larger grids do not fit the layout.
+	EXPECT_THROW((math::function::FixedLayout<16, 8>(17, 8)), std::invalid_argument);
+	EXPECT_THROW((math::function::FixedStorage<float, 10>(11)), std::invalid_argument);
+}
+
+TEST(FixedSquareGrid, SameResultsAsSquareGrid) {
+	math::linear::StaticVector<double,2> start({-1.0, 0.5});
+	math::function::FixedSquareGrid<double, double, 12, 9> fixed(0.25, start);
+	math::function::SquareGrid<double> grid(12, 9, 0.25, start);
+	for (unsigned i = 0; i < 12; ++i) {
+		for (unsigned j = 0; j < 9; ++j) {
+			auto point = grid.domainfromij(i,j);
+			double value = point.x()*point.x() - 2.0*point.x()*point.y() + point.y();
+			grid.dataEvaluation(i,j) = value;
+			fixed.dataEvaluation(i,j) = value;
+		}
+	}
+
+	std::vector<math::linear::StaticVector<double,2>> coords({
+		math::linear::StaticVector<double,2>({-1.0, 0.5}),
+		math::linear::StaticVector<double,2>({0.13, 1.21}),
+		math::linear::StaticVector<double,2>({1.75, 2.5}),
+		math::linear::StaticVector<double,2>({-0.4, 2.45}),
+	});
+
+	std::vector<double> values;
+	fixed.evaluate(coords, values);
+	for (unsigned k = 0; k < coords.size(); ++k) {
+		EXPECT_DOUBLE_EQ(values[k], grid.evaluate(coords[k]));
+		EXPECT_DOUBLE_EQ(fixed.evaluate_partial_y(coords[k]), grid.evaluate_partial_y(coords[k]));
+	}
+
+	// Interpolated along the upper edges too.
+	EXPECT_DOUBLE_EQ(fixed.evaluate(-0.4, 2.5), 0.6 * 5.25 + 0.4 * 3.8125);
+	EXPECT_THROW(fixed.evaluate(1.8, 1.0), std::invalid_argument);
+	EXPECT_THROW(fixed.evaluate(-1.1, 1.0), std::invalid_argument);
+
+	// Differential operators taking any grid, and the inherited ones.
+	math::function::SquareGrid<double, math::linear::StaticVector<double,2>> output(10, 7, 0.25);
+	math::function::gradient(fixed, output);
+	auto expected = grid.gradient();
+	auto inherited = fixed.gradient();
+	for (unsigned i = 0; i < 10; ++i) {
+		for (unsigned j = 0; j < 7; ++j) {
+			EXPECT_DOUBLE_EQ(output.dataEvaluation(i,j).x(), expected.dataEvaluation(i,j).x());
+			EXPECT_DOUBLE_EQ(inherited.dataEvaluation(i,j).y(), expected.dataEvaluation(i,j).y());
+		}
+	}
+}
+
+TEST(FixedSquareGrid, Solver) {
+	math::solver::laplace2::FixedFDM<float, float, 16, 16> fixed(16, 16, 0.1);
+	math::solver::laplace2::FDM<float, float> fdm(16, 16, 0.1);
+	fixed.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+	fdm.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+	fixed.setBoundary(math::solver::laplace2::GridEdge::RightEdge, 0.0);
+	fdm.setBoundary(math::solver::laplace2::GridEdge::RightEdge, 0.0);
+
+	for (unsigned n = 0; n < 50; ++n) {
+		fixed.naiveIteration();
+		fdm.naiveIteration();
+	}
+
+	for (unsigned i = 0; i < 16; ++i) {
+		for (unsigned j = 0; j < 16; ++j) EXPECT_FLOAT_EQ(fixed.dataEvaluation(i,j).value(), fdm.dataEvaluation(i,j).value());
+	}
+
+	// Grids smaller than their layout, with the copy borrowed from a workspace.
+	math::memory::Workspace workspace;
+	math::solver::laplace2::FixedFDM<float, float, 16, 16> smaller(12, 9, 0.1, math::linear::StaticVector<float,2>(), workspace);
+	math::solver::laplace2::FDM<float, float> reference(12, 9, 0.1);
+	smaller.setBoundary(math::solver::laplace2::GridEdge::UpperEdge, 2.0).setBoundary(5, 4, -1.0);
+	reference.setBoundary(math::solver::laplace2::GridEdge::UpperEdge, 2.0).setBoundary(5, 4, -1.0);
+	for (unsigned n = 0; n < 20; ++n) {
+		smaller.naiveIteration();
+		reference.naiveIteration();
+	}
+	for (unsigned i = 0; i < 12; ++i) {
+		for (unsigned j = 0; j < 9; ++j) EXPECT_FLOAT_EQ(smaller.dataEvaluation(i,j).value(), reference.dataEvaluation(i,j).value());
+	}
+	EXPECT_FLOAT_EQ(smaller.dataEvaluation(5,4).value(), -1.0);
+
+	// Free sweeps over fixed grids of finite elements.
+	math::function::FixedSquareGrid<float, math::solver::FiniteElement<float>, 8, 8> grid(0.1);
+	for (unsigned j = 0; j < 8; ++j) grid.dataEvaluation(0,j) = 1.0;
+	math::solver::laplace2::naiveIteration(grid);
+	EXPECT_FLOAT_EQ(grid.dataEvaluation(1,3).value(), 0.25);
+	EXPECT_FLOAT_EQ(grid.dataEvaluation(2,3).value(), 0.0);
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <math/function/square_grid.hpp>
+#include <math/function/sparse_storage.hpp>
+#include <math/function/grid_deposit.hpp>
+
+
+namespace {
+
+std::vector<math::linear::StaticVector<double, 2>> particles(unsigned count, double low, double high) {
+	std::mt19937 generator(7);
+	std::uniform_real_distribution<double> distribution(low, high);
+	std::vector<math::linear::StaticVector<double, 2>> positions(count);
+	for (auto& position : positions) position = math::linear::StaticVector<double, 2>({distribution(generator), distribution(generator)});
+	return positions;
+}
+
+}
+
+
+TEST(GridDeposit, TransposeOfInterpolation) {
+	math::function::SquareGrid<double, double> field(30, 30, 0.1, math::linear::StaticVector<double, 2>({-1.0, -1.0}));
+	for (unsigned i = 0; i < 30; ++i) {
+		for (unsigned j = 0; j < 30; ++j) field.dataEvaluation(i,j) = std::sin(0.4 * i) + 0.1 * j * j;
+	}
+	
+	// Depositing a unit quantity and pairing it with a field gives the interpolated field.
+	auto positions = particles(50, -1.0, 1.9);
+	positions.push_back(math::linear::StaticVector<double, 2>({1.9, 1.9}));
+	for (const auto& position : positions) {
+		math::function::SquareGrid<double, double> density(30, 30, 0.1, math::linear::StaticVector<double, 2>({-1.0, -1.0}));
+		math::function::deposit(density, std::vector<math::linear::StaticVector<double, 2>>({position}), 1.0);
+		
+		double pairing = 0.0;
+		for (unsigned i = 0; i < 30; ++i) {
+			for (unsigned j = 0; j < 30; ++j) pairing += density.dataEvaluation(i,j) * field.dataEvaluation(i,j);
+		}
+		EXPECT_NEAR(pairing, field.evaluate(position), 1e-12);
+	}
+	
+	math::function::SquareGrid<double, double> density(30, 30, 0.1);
+	EXPECT_THROW(math::function::deposit(density, std::vector<math::linear::StaticVector<double, 2>>({{3.0, 0.5}}), 1.0), std::invalid_argument);
+	EXPECT_THROW(math::function::deposit(density, positions, std::vector<double>(3, 1.0)), std::invalid_argument);
+}
+
+
+TEST(GridDeposit, Deterministic) {
+	unsigned size = 101;
+	auto positions = particles(20000, 0.0, 10.0);
+	std::vector<double> charges(positions.size());
+	for (unsigned p = 0; p < positions.size(); ++p) charges[p] = 1.0 + 0.001 * (p % 17);
+	
+	// Serial reference, particle by particle.
+	math::function::SquareGrid<double, double> reference(size, size, 0.1);
+	double total = 0.0;
+	for (unsigned p = 0; p < positions.size(); ++p) {
+		double x = positions[p].x() / 0.1, y = positions[p].y() / 0.1;
+		unsigned i = std::min(static_cast<unsigned>(x), size-2), j = std::min(static_cast<unsigned>(y), size-2);
+		double u = x - i, v = y - j;
+		reference.dataEvaluation(i,j) += charges[p] * (1.0 - u) * (1.0 - v);
+		reference.dataEvaluation(i+1,j) += charges[p] * u * (1.0 - v);
+		reference.dataEvaluation(i,j+1) += charges[p] * (1.0 - u) * v;
+		reference.dataEvaluation(i+1,j+1) += charges[p] * u * v;
+		total += charges[p];
+	}
+	
+	math::function::SquareGrid<double, double> serial(size, size, 0.1);
+	math::function::deposit(serial, positions, charges, 1);
+	double sum = 0.0;
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			EXPECT_NEAR(serial.dataEvaluation(i,j), reference.dataEvaluation(i,j), 1e-9);
+			sum += serial.dataEvaluation(i,j);
+		}
+	}
+	EXPECT_NEAR(sum, total, 1e-8);
+	
+	// Bit identical for any number of threads and storage.
+	for (unsigned threads : {2u, 3u, 8u}) {
+		math::function::SquareGrid<double, double> parallel(size, size, 0.1);
+		math::function::deposit(parallel, positions, charges, threads);
+		for (unsigned i = 0; i < size; ++i) {
+			for (unsigned j = 0; j < size; ++j) ASSERT_EQ(parallel.dataEvaluation(i,j), serial.dataEvaluation(i,j));
+		}
+	}
+	
+	math::function::SquareGrid<double, double, math::function::RowMajorLayout, math::function::SparseTileStorage<double>> sparse(size, size, 0.1);
+	math::function::deposit<8>(sparse, positions, charges, 4);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) EXPECT_NEAR(sparse.dataEvaluation(i,j), serial.dataEvaluation(i,j), 1e-9);
+	}
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <math/function/square_grid.hpp>
+#include <math/function/grid_export.hpp>
+#include <math/solver/laplace.hpp>
+
+
+std::string read_export_file(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	std::stringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+TEST(GridExport, CSV) {
+	std::string path = testing::TempDir() + "grid_export_test.csv";
+	math::function::SquareGrid<float, float> grid(5, 3, 0.5);
+	for (unsigned i = 0; i < grid.sizex(); ++i) {
+		for (unsigned j = 0; j < grid.sizey(); ++j) grid.dataEvaluation(i,j) = i + 10.0*j;
+	}
+	
+	math::function::ExportOptions options;
+	options.stride = 2;
+	options.bufferSize = 16;
+	math::function::exportCSV(path, grid, options);
+	EXPECT_EQ(read_export_file(path), "x,y,value\n0,0,0\n1,0,2\n2,0,4\n0,1,20\n1,1,22\n2,1,24\n");
+	
+	// Vector fields export one column per component.
+	auto gradient = grid.gradient();
+	options.stride = 1;
+	options.name = "E";
+	math::function::exportCSV(path, gradient, options);
+	std::string content = read_export_file(path);
+	EXPECT_EQ(content.substr(0, content.find('\n')), "x,y,E0,E1");
+	EXPECT_NE(content.find("\n0.5,0.5,2,20\n"), std::string::npos);
+	std::remove(path.c_str());
+}
+
+TEST(GridExport, LargePrecision) {
+	std::string path = testing::TempDir() + "grid_export_precision.csv";
+	math::function::SquareGrid<double, double> grid(40, 30, 1.0 / 3.0);
+	for (unsigned i = 0; i < grid.sizex(); ++i) {
+		for (unsigned j = 0; j < grid.sizey(); ++j) grid.dataEvaluation(i,j) = -1.0 / (i + 3.0*j + 7.0);
+	}
+
+	// Precisions beyond max_digits10 write exact round trip texts, and nothing else.
+	math::function::ExportOptions options;
+	options.precision = 60;
+	options.bufferSize = 100;
+	math::function::exportCSV(path, grid, options);
+	std::string content = read_export_file(path);
+	EXPECT_EQ(content.find('\0'), std::string::npos);
+	EXPECT_EQ(content.substr(0, content.find('\n', 10) + 1), "x,y,value\n0,0,-0.14285714285714285\n");
+
+	std::istringstream lines(content);
+	std::string line;
+	std::getline(lines, line);
+	unsigned count = 0;
+	for (unsigned j = 0; j < grid.sizey(); ++j) {
+		for (unsigned i = 0; i < grid.sizex(); ++i, ++count) {
+			std::getline(lines, line);
+			double x, y, value;
+			ASSERT_EQ(std::sscanf(line.c_str(), "%lf,%lf,%lf", &x, &y, &value), 3);
+			EXPECT_EQ(x, grid.domainfromij(i,j).x());
+			EXPECT_EQ(value, grid.dataEvaluation(i,j));
+		}
+	}
+
+	EXPECT_EQ(count, 40u * 30u);
+	std::remove(path.c_str());
+}
+
+TEST(GridExport, VTK) {
+	std::string path = testing::TempDir() + "grid_export_test.vti";
+	math::solver::laplace2::FDM<double, double> fdm(4, 4, 0.25);
+	fdm.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+	fdm.naiveIteration();
+	
+	math::function::exportVTK(path, fdm);
+	std::string content = read_export_file(path);
+	EXPECT_NE(content.find("WholeExtent=\"0 3 0 3 0 0\""), std::string::npos);
+	EXPECT_NE(content.find("type=\"Float64\""), std::string::npos);
+	EXPECT_NE(content.find("</VTKFile>"), std::string::npos);
+	
+	// Appended payload: byte count then the values, x fastest.
+	std::size_t start = content.find("   _") + 4;
+	std::uint64_t bytes;
+	std::memcpy(&bytes, content.data() + start, sizeof(bytes));
+	EXPECT_EQ(bytes, 16 * sizeof(double));
+	
+	double values[16];
+	std::memcpy(values, content.data() + start + sizeof(bytes), sizeof(values));
+	for (unsigned j = 0; j < 4; ++j) {
+		for (unsigned i = 0; i < 4; ++i) EXPECT_DOUBLE_EQ(values[j*4 + i], fdm.dataEvaluation(i,j).value());
+	}
+	
+	// 2-D vectors get a zero z component.
+	math::function::SquareGrid<double, double> grid(4, 3, 0.5);
+	for (unsigned i = 0; i < grid.sizex(); ++i) {
+		for (unsigned j = 0; j < grid.sizey(); ++j) grid.dataEvaluation(i,j) = i*i + 3.0*j;
+	}
+
+	auto gradient = grid.gradient();
+	math::function::exportVTK(path, gradient);
+	content = read_export_file(path);
+	EXPECT_NE(content.find("Vectors=\"value\""), std::string::npos);
+	EXPECT_NE(content.find("NumberOfComponents=\"3\""), std::string::npos);
+
+	start = content.find("   _") + 4;
+	std::memcpy(&bytes, content.data() + start, sizeof(bytes));
+	EXPECT_EQ(bytes, 3 * gradient.sizex() * gradient.sizey() * sizeof(double));
+
+	double vector[3];
+	std::memcpy(vector, content.data() + start + sizeof(bytes) + 3 * sizeof(double), sizeof(vector));
+	EXPECT_DOUBLE_EQ(vector[0], gradient.dataEvaluation(1,0).x());
+	EXPECT_DOUBLE_EQ(vector[1], gradient.dataEvaluation(1,0).y());
+	EXPECT_DOUBLE_EQ(vector[2], 0.0);
+
+	std::remove(path.c_str());
+}
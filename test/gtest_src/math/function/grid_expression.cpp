@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <math/function/square_grid.hpp>
+#include <math/function/grid_layout.hpp>
+#include <math/function/fixed_square_grid.hpp>
+#include <math/function/grid_expression.hpp>
+
+
+TEST(GridExpression, ElementWiseArithmetic) {
+	unsigned size = 17;
+	math::function::SquareGrid<double, double> phi1(size, size, 0.1);
+	math::function::SquareGrid<double, double> phi2(size, size, 0.1);
+	math::function::SquareGrid<double, double> phi3(size, size, 0.1);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			phi1.dataEvaluation(i,j) = 1.0 * i;
+			phi2.dataEvaluation(i,j) = 2.0 * j;
+			phi3.dataEvaluation(i,j) = 0.5 * i * j + 1.0;
+		}
+	}
+	
+	double a = 3.0, b = -0.5;
+	math::function::SquareGrid<double, double> result(size, size, 0.1);
+	result = a*phi1 + b*phi2 - phi3;
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			EXPECT_DOUBLE_EQ(result.dataEvaluation(i,j), a*i + b*2.0*j - (0.5*i*j + 1.0));
+		}
+	}
+	
+	// Division, negation, scalars on either side, and the target inside the expression.
+	result.assign(-(phi3 / 2.0) + 1.0 - result * 0.0 + phi1 / phi3, 4);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			double value = 0.5*i*j + 1.0;
+			EXPECT_DOUBLE_EQ(result.dataEvaluation(i,j), -(value / 2.0) + 1.0 + i / value);
+		}
+	}
+	
+	// Expressions are lazy values: built once, evaluated later.
+	auto expression = phi1 * phi1;
+	phi1.dataEvaluation(2,3) = 10.0;
+	result = expression;
+	EXPECT_DOUBLE_EQ(result.dataEvaluation(2,3), 100.0);
+	
+	math::function::SquareGrid<double, double> smaller(size-1, size, 0.1);
+	EXPECT_THROW(phi1 + smaller, std::invalid_argument);
+	EXPECT_THROW(smaller = phi1 * 2.0, std::invalid_argument);
+}
+
+
+TEST(GridExpression, MixedLayouts) {
+	unsigned size = 13;
+	math::function::SquareGrid<double, double> rows(size, size, 0.1);
+	math::function::SquareGrid<double, double, math::function::TiledLayout<4>> tiles(size, size, 0.1);
+	math::function::SquareGrid<double, double, math::function::MortonLayout> morton(size, size, 0.1);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			rows.dataEvaluation(i,j) = i + 100.0 * j;
+			tiles.dataEvaluation(i,j) = 2.0 * i;
+		}
+	}
+	
+	// Point by point when layouts differ, over the storage when they match.
+	morton.assign(rows + tiles, 3);
+	tiles = tiles * tiles;
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			EXPECT_DOUBLE_EQ(morton.dataEvaluation(i,j), 3.0 * i + 100.0 * j);
+			EXPECT_DOUBLE_EQ(tiles.dataEvaluation(i,j), 4.0 * i * i);
+		}
+	}
+}
+
+
+TEST(GridExpression, FixedGrids) {
+	math::function::FixedSquareGrid<double, double, 8, 6> fixed(0.1);
+	math::function::FixedSquareGrid<double, double, 8, 6> result(0.1);
+	math::function::SquareGrid<double, double> rows(8, 6, 0.1);
+	for (unsigned i = 0; i < 8; ++i) {
+		for (unsigned j = 0; j < 6; ++j) {
+			fixed.dataEvaluation(i,j) = i + 10.0 * j;
+			rows.dataEvaluation(i,j) = 1.0 * j;
+		}
+	}
+	
+	// Fixed grids are terminals, not scalars, alone and mixed with other grids.
+	result = fixed + fixed;
+	rows.assign(-fixed + rows * 2.0, 2);
+	for (unsigned i = 0; i < 8; ++i) {
+		for (unsigned j = 0; j < 6; ++j) {
+			EXPECT_DOUBLE_EQ(result.dataEvaluation(i,j), 2.0 * (i + 10.0 * j));
+			EXPECT_DOUBLE_EQ(rows.dataEvaluation(i,j), -(i + 10.0 * j) + 2.0 * j);
+		}
+	}
+	
+	math::function::FixedSquareGrid<double, double, 6, 8> transposed(0.1);
+	EXPECT_THROW(transposed = fixed * 2.0, std::invalid_argument);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <math/function/square_grid.hpp>
+#include <math/function/grid_file.hpp>
+
+
+TEST(GridFile, SaveAndLoad) {
+	std::string path = testing::TempDir() + "grid_file_test.bin";
+	math::linear::StaticVector<float, 2> start({-1.0, 2.0});
+	math::function::SquareGrid<float, float, math::function::TiledLayout<4>> grid(7, 5, 0.5, start);
+	for (unsigned i = 0; i < grid.sizex(); ++i) {
+		for (unsigned j = 0; j < grid.sizey(); ++j) grid.dataEvaluation(i,j) = 3.0*i - j;
+	}
+	
+	math::function::saveGrid(path, grid);
+	
+	auto header = math::function::readGridFileHeader(path);
+	EXPECT_EQ(header.version, 1u);
+	EXPECT_EQ(header.sizex, 7u);
+	EXPECT_EQ(header.sizey, 5u);
+	EXPECT_EQ(header.layoutId, 1u);
+	EXPECT_EQ(header.layoutParameter, 4u);
+	EXPECT_EQ(header.storageSize, 64u);
+	EXPECT_EQ(header.payloadOffset % 64, 0u);
+	EXPECT_DOUBLE_EQ(header.spacing, 0.5);
+	
+	auto loaded = math::function::loadGrid<float, float, math::function::TiledLayout<4>>(path);
+	EXPECT_EQ(loaded.sizex(), grid.sizex());
+	EXPECT_EQ(loaded.sizey(), grid.sizey());
+	EXPECT_FLOAT_EQ(loaded.spacing(), grid.spacing());
+	EXPECT_EQ(loaded.start(), grid.start());
+	for (unsigned i = 0; i < grid.sizex(); ++i) {
+		for (unsigned j = 0; j < grid.sizey(); ++j) EXPECT_FLOAT_EQ(loaded.dataEvaluation(i,j), grid.dataEvaluation(i,j));
+	}
+	
+	EXPECT_FLOAT_EQ(loaded.evaluate(0.25, 2.75), grid.evaluate(0.25, 2.75));
+	
+	// Mismatching element type or layout is rejected.
+	EXPECT_THROW((math::function::loadGrid<float, double, math::function::TiledLayout<4>>(path)), std::runtime_error);
+	EXPECT_THROW((math::function::loadGrid<float, float, math::function::RowMajorLayout>(path)), std::runtime_error);
+	EXPECT_THROW((math::function::loadGrid<float, float, math::function::TiledLayout<8>>(path)), std::runtime_error);
+	std::remove(path.c_str());
+}
+
+TEST(GridFile, DerivedVectorField) {
+	std::string path = testing::TempDir() + "grid_file_gradient_test.bin";
+	math::function::SquareGrid<double, double> grid(6, 6, 1.0);
+	for (unsigned i = 0; i < grid.sizex(); ++i) {
+		for (unsigned j = 0; j < grid.sizey(); ++j) grid.dataEvaluation(i,j) = 2.0*i + 5.0*j;
+	}
+	
+	auto gradient = grid.gradient();
+	math::function::saveGrid(path, gradient);
+	EXPECT_EQ(math::function::readGridFileHeader(path).components, 2u);
+	
+	auto loaded = math::function::loadGrid<double, math::linear::StaticVector<double,2>>(path);
+	EXPECT_EQ(loaded.sizex(), 4u);
+	EXPECT_EQ(loaded.start(), gradient.start());
+	EXPECT_DOUBLE_EQ(loaded.dataEvaluation(2,1).x(), 2.0);
+	EXPECT_DOUBLE_EQ(loaded.dataEvaluation(2,1).y(), 5.0);
+	std::remove(path.c_str());
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <math/function/grid_layout.hpp>
+#include <math/function/square_grid.hpp>
+
+
+template <typename Layout>
+void check_bijective_layout(unsigned sizex, unsigned sizey) {
+	Layout layout(sizex, sizey);
+	std::vector<bool> used(layout.size(), false);
+	for (unsigned i = 0; i < sizex; ++i) {
+		for (unsigned j = 0; j < sizey; ++j) {
+			unsigned index = layout.index(i, j);
+			ASSERT_LT(index, layout.size());
+			EXPECT_FALSE(used[index]);
+			used[index] = true;
+		}
+	}
+}
+
+TEST(GridLayout, Bijective) {
+	check_bijective_layout<math::function::RowMajorLayout>(7, 5);
+	check_bijective_layout<math::function::TiledLayout<4>>(7, 5);
+	check_bijective_layout<math::function::TiledLayout<8>>(33, 17);
+	check_bijective_layout<math::function::MortonLayout>(7, 5);
+	check_bijective_layout<math::function::MortonLayout>(40, 3);
+	check_bijective_layout<math::function::MortonLayout>(2, 33);
+	
+	math::function::RowMajorLayout rows(7, 5);
+	EXPECT_EQ(rows.size(), 35);
+	EXPECT_EQ(rows.index(3, 2), 17);
+	
+	math::function::TiledLayout<4> tiles(7, 5);
+	EXPECT_EQ(tiles.size(), 64);
+	EXPECT_EQ(tiles.index(5, 1), 16 + 4 + 1);
+	
+	math::function::MortonLayout morton(4, 4);
+	EXPECT_EQ(morton.size(), 16);
+	EXPECT_EQ(morton.index(1, 0), 1);
+	EXPECT_EQ(morton.index(0, 1), 2);
+	EXPECT_EQ(morton.index(1, 1), 3);
+	EXPECT_EQ(morton.index(2, 0), 4);
+}
+
+
+template <typename Layout>
+math::function::SquareGrid<float, float, Layout> make_layout_grid(unsigned sizex, unsigned sizey) {
+	math::function::SquareGrid<float, float, Layout> grid(sizex, sizey, 0.25);
+	for (unsigned i = 0; i < sizex; ++i) {
+		for (unsigned j = 0; j < sizey; ++j) {
+			auto point = grid.domainfromij(i,j);
+			grid.dataEvaluation(i,j) = point.x()*point.x() - point.x()*point.y() + 3.0*point.y();
+		}
+	}
+	
+	return grid;
+}
+
+TEST(GridLayout, LayoutIndependentResults) {
+	auto rows = make_layout_grid<math::function::RowMajorLayout>(11, 6);
+	auto tiles = make_layout_grid<math::function::TiledLayout<4>>(11, 6);
+	auto morton = make_layout_grid<math::function::MortonLayout>(11, 6);
+	
+	auto rows_gradient = rows.gradient();
+	auto tiles_gradient = tiles.gradient();
+	auto morton_gradient = morton.gradient();
+	for (unsigned i = 0; i < rows_gradient.sizex(); ++i) {
+		for (unsigned j = 0; j < rows_gradient.sizey(); ++j) {
+			EXPECT_EQ(tiles_gradient.dataEvaluation(i,j), rows_gradient.dataEvaluation(i,j));
+			EXPECT_EQ(morton_gradient.dataEvaluation(i,j), rows_gradient.dataEvaluation(i,j));
+		}
+	}
+	
+	std::vector<math::linear::StaticVector<float, 2>> coords({
+		math::linear::StaticVector<float, 2>({0.1, 0.2}),
+		math::linear::StaticVector<float, 2>({1.3, 0.9}),
+		math::linear::StaticVector<float, 2>({2.5, 1.25}),
+	});
+	
+	for (const auto& coord : coords) {
+		EXPECT_FLOAT_EQ(tiles.evaluate(coord), rows.evaluate(coord));
+		EXPECT_FLOAT_EQ(morton.evaluate(coord), rows.evaluate(coord));
+		EXPECT_FLOAT_EQ(morton.evaluate_partial_y(coord), rows.evaluate_partial_y(coord));
+	}
+}
+
+#ifndef MATH_INDEX32
+TEST(GridLayout, LargeIndices) {
+	// 10^10 values, past the range of 32 bit indices. Nothing is allocated.
+	math::function::RowMajorLayout rows(100000, 100000);
+	EXPECT_EQ(rows.size(), 10000000000ull);
+	EXPECT_EQ(rows.index(99999, 99999), 9999999999ull);
+	EXPECT_EQ(rows.index(0, 50000), 5000000000ull);
+	
+	math::function::TiledLayout<8> tiles(100000, 100000);
+	EXPECT_EQ(tiles.size(), 10000000000ull);
+	EXPECT_EQ(tiles.index(99999, 99999), 9999999999ull);
+	
+	math::function::MortonLayout morton(100000, 100000);
+	EXPECT_EQ(morton.size(), 1ull << 34);
+	EXPECT_EQ(morton.index(0, 1u << 16), 1ull << 33);
+	EXPECT_EQ(morton.index(131071, 131071), (1ull << 34) - 1);
+}
+#endif
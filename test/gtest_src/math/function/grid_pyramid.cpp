@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <algorithm>
+#include <math/function/square_grid.hpp>
+#include <math/function/grid_pyramid.hpp>
+
+
+TEST(GridPyramid, Levels) {
+	unsigned size = 33;
+	math::function::SquareGrid<double, double> grid(size, 20, 0.1);
+	for (unsigned i = 0; i < grid.sizex(); ++i) {
+		for (unsigned j = 0; j < grid.sizey(); ++j) {
+			auto point = grid.domainfromij(i,j);
+			grid.dataEvaluation(i,j) = 2.0*point.x() - point.y() + 1.0;
+		}
+	}
+	
+	math::function::GridPyramid<math::function::SquareGrid<double, double>> pyramid(grid);
+	
+	// 33x20, 17x11, 9x6, 5x4, 3x3, 2x2.
+	ASSERT_EQ(pyramid.levels(), 6u);
+	EXPECT_EQ(pyramid.sizex(1), 17u);
+	EXPECT_EQ(pyramid.sizey(1), 11u);
+	EXPECT_EQ(pyramid.sizex(5), 2u);
+	EXPECT_EQ(pyramid.sizey(5), 2u);
+	EXPECT_DOUBLE_EQ(pyramid.spacing(2), 0.4);
+	
+	// Full weighting keeps linear functions away from the edges.
+	EXPECT_NEAR(pyramid.dataEvaluation(3, 2, 1), 2.0*0.6 - 0.4 + 1.0, 1e-12);
+	EXPECT_NEAR(pyramid.evaluate(1.3, 0.9, 1), 2.0*1.3 - 0.9 + 1.0, 1e-12);
+	EXPECT_NEAR(pyramid.evaluate(1.3, 0.9, 0), grid.evaluate(1.3, 0.9), 1e-15);
+	EXPECT_NO_THROW(pyramid.evaluate(3.2, 1.9, 5));
+	EXPECT_THROW(pyramid.level(6), std::invalid_argument);
+}
+
+
+TEST(GridPyramid, Bounds) {
+	unsigned size = 40;
+	math::function::SquareGrid<double, double> grid(size, size, 0.05);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			auto point = grid.domainfromij(i,j);
+			grid.dataEvaluation(i,j) = std::sin(3.0*point.x()) * std::cos(2.0*point.y());
+		}
+	}
+	
+	math::function::GridPyramid<math::function::SquareGrid<double, double>> pyramid(grid);
+	
+	// Bounds of the coarsest cell are the bounds of the whole grid.
+	unsigned top = pyramid.levels() - 1;
+	double lower = grid.dataEvaluation(0,0), upper = lower;
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			lower = std::min(lower, grid.dataEvaluation(i,j));
+			upper = std::max(upper, grid.dataEvaluation(i,j));
+		}
+	}
+	
+	EXPECT_DOUBLE_EQ(pyramid.minimum(0, 0, top), lower);
+	EXPECT_DOUBLE_EQ(pyramid.maximum(0, 0, top), upper);
+	
+	// Bounds of every level contain the source values under them.
+	for (unsigned level = 0; level < pyramid.levels(); ++level) {
+		for (unsigned k = 0; k < 200; ++k) {
+			double x = 1.95 * ((k * 37) % 200) / 200.0;
+			double y = 1.95 * ((k * 53) % 200) / 200.0;
+			double minimum, maximum;
+			pyramid.bounds(math::linear::StaticVector<double, 2>({x, y}), level, minimum, maximum);
+			double value = grid.evaluate(x, y);
+			EXPECT_LE(minimum, value);
+			EXPECT_GE(maximum, value);
+		}
+	}
+}
+
+
+TEST(GridPyramid, Invalidate) {
+	unsigned size = 30;
+	math::function::SquareGrid<double, double> grid(size, size, 0.1);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			grid.dataEvaluation(i,j) = 0.01 * i * j;
+		}
+	}
+	
+	math::function::GridPyramid<math::function::SquareGrid<double, double>> pyramid(grid);
+	unsigned top = pyramid.levels() - 1;
+	EXPECT_DOUBLE_EQ(pyramid.maximum(0, 0, top), 0.01 * 29 * 29);
+	
+	// Change a small region and update only that region.
+	for (unsigned i = 10; i < 13; ++i) {
+		for (unsigned j = 4; j < 6; ++j) {
+			grid.dataEvaluation(i,j) = 100.0;
+		}
+	}
+	
+	pyramid.invalidate(10, 4, 3, 2);
+	
+	// Same as a pyramid built from scratch.
+	math::function::GridPyramid<math::function::SquareGrid<double, double>> fresh(grid);
+	for (unsigned level = 1; level < pyramid.levels(); ++level) {
+		for (unsigned i = 0; i < pyramid.sizex(level); ++i) {
+			for (unsigned j = 0; j < pyramid.sizey(level); ++j) {
+				EXPECT_DOUBLE_EQ(pyramid.dataEvaluation(i, j, level), fresh.dataEvaluation(i, j, level));
+			}
+		}
+	}
+	
+	for (unsigned level = 0; level < pyramid.levels(); ++level) {
+		for (unsigned i = 0; i < pyramid.sizex(level) - 1; ++i) {
+			for (unsigned j = 0; j < pyramid.sizey(level) - 1; ++j) {
+				EXPECT_DOUBLE_EQ(pyramid.minimum(i, j, level), fresh.minimum(i, j, level));
+				EXPECT_DOUBLE_EQ(pyramid.maximum(i, j, level), fresh.maximum(i, j, level));
+			}
+		}
+	}
+	
+	EXPECT_DOUBLE_EQ(pyramid.maximum(0, 0, top), 100.0);
+}
@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <math/function/square_grid.hpp>
+#include <math/function/grid_reduction.hpp>
+#include <math/function/sparse_storage.hpp>
+#include <math/function/fixed_square_grid.hpp>
+#include <math/solver/laplace.hpp>
+
+
+TEST(GridReduction, WholeGridAndRegion) {
+	unsigned size = 150;
+	math::function::SquareGrid<double, double> grid(size, size, 0.01);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			grid.dataEvaluation(i,j) = std::sin(0.1 * i) * std::cos(0.07 * j);
+		}
+	}
+	
+	grid.dataEvaluation(37, 121) = 5.0;
+	grid.dataEvaluation(80, 3) = -4.0;
+	
+	double total = 0.0, squares = 0.0;
+	for (unsigned j = 0; j < size; ++j) {
+		for (unsigned i = 0; i < size; ++i) {
+			total += grid.dataEvaluation(i,j);
+			squares += grid.dataEvaluation(i,j) * grid.dataEvaluation(i,j);
+		}
+	}
+	
+	EXPECT_DOUBLE_EQ(math::function::maximum(grid), 5.0);
+	EXPECT_DOUBLE_EQ(math::function::minimum(grid), -4.0);
+	EXPECT_NEAR(math::function::sum(grid), total, 1e-9);
+	EXPECT_NEAR(math::function::norm2(grid), std::sqrt(squares), 1e-9);
+	
+	auto largest = math::function::argmax(grid);
+	EXPECT_TRUE(largest.found);
+	EXPECT_EQ(largest.i, 37u);
+	EXPECT_EQ(largest.j, 121u);
+	auto smallest = math::function::argmin(grid);
+	EXPECT_EQ(smallest.i, 80u);
+	EXPECT_EQ(smallest.j, 3u);
+	
+	// Sub-rectangle, clipped to the grid.
+	math::function::GridRegion region(100, 100, 1000, 10);
+	auto stats = math::function::statistics(grid, region);
+	EXPECT_EQ(stats.count, 50u * 10u);
+	double regionsum = 0.0;
+	for (unsigned j = 100; j < 110; ++j) for (unsigned i = 100; i < size; ++i) regionsum += grid.dataEvaluation(i,j);
+	EXPECT_NEAR(stats.sum, regionsum, 1e-12);
+	EXPECT_NEAR(stats.mean(), regionsum / 500.0, 1e-12);
+	EXPECT_THROW(math::function::sum(grid, math::function::GridRegion(size, 0, 1, 1)), std::invalid_argument);
+	
+	// Histogram of all points, upper bound included.
+	auto counts = math::function::histogram(grid, 10, -4.0, 5.0);
+	std::size_t counted = 0;
+	for (auto count : counts) counted += count;
+	EXPECT_EQ(counted, size * size);
+	EXPECT_EQ(counts.back(), 1u);
+	EXPECT_EQ(counts.front(), 1u);
+}
+
+
+TEST(GridReduction, Deterministic) {
+	unsigned size = 300;
+	math::function::SquareGrid<float, float> grid(size, size, 0.01f);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			grid.dataEvaluation(i,j) = 1.0f / (1.0f + i + 0.37f * j);
+		}
+	}
+	
+	// Same bits for any number of threads.
+	float reference = math::function::sum(grid);
+	for (unsigned threads : {2u, 3u, 8u, 0u}) {
+		EXPECT_EQ(math::function::sum(grid, math::function::GridRegion(), threads), reference);
+		EXPECT_EQ(math::function::norm2(grid, math::function::GridRegion(), threads), math::function::norm2(grid));
+	}
+	
+	// Ties go to the first point.
+	math::function::SquareGrid<float, float> flat(size, size, 0.01f);
+	flat.setValueAllSquares(1.0f);
+	auto extremum = math::function::argmax(flat, math::function::GridRegion(5, 7, 100, 100), 4);
+	EXPECT_EQ(extremum.i, 5u);
+	EXPECT_EQ(extremum.j, 7u);
+}
+
+
+TEST(GridReduction, FrozenMask) {
+	unsigned size = 20;
+	math::solver::laplace2::FDM<double, double> fdm(size, size, 0.1);
+	fdm.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 2.0);
+	fdm.dataEvaluation(5, 5) = 7.0;
+	
+	auto frozen = math::function::statistics(fdm, math::function::GridRegion(), math::function::frozenMask(fdm));
+	EXPECT_EQ(frozen.count, size);
+	EXPECT_DOUBLE_EQ(frozen.sum, 2.0 * size);
+	
+	auto free = math::function::frozenMask(fdm, false);
+	EXPECT_DOUBLE_EQ(math::function::maximum(fdm, math::function::GridRegion(), free, 2), 7.0);
+	EXPECT_DOUBLE_EQ(math::function::minimum(fdm, math::function::GridRegion(), free), 0.0);
+	EXPECT_THROW(math::function::minimum(fdm, math::function::GridRegion(3, 3, 1, 1), math::function::frozenMask(fdm)), std::invalid_argument);
+}
+
+
+template <typename Grid>
+void check_dense_rows(Grid& grid, const math::function::GridRegion& region) {
+	// Repeated values, so extrema have ties.
+	for (unsigned i = 0; i < grid.sizex(); ++i) {
+		for (unsigned j = 0; j < grid.sizey(); ++j) grid.dataEvaluation(i,j) = std::round(8.0f * std::sin(0.3f * i + 0.11f * j * j));
+	}
+	
+	// A mask selecting every point takes the point by point path.
+	auto every = [](unsigned, unsigned) {return true;};
+	auto dense = math::function::statistics(grid, region);
+	auto masked = math::function::statistics(grid, region, every);
+	EXPECT_EQ(dense.count, masked.count);
+	EXPECT_EQ(dense.minimum, masked.minimum);
+	EXPECT_EQ(dense.maximum, masked.maximum);
+	EXPECT_NEAR(dense.sum, masked.sum, 1e-3);
+	EXPECT_NEAR(dense.sumSquares, masked.sumSquares, 1e-2);
+	
+	auto largest = math::function::argmax(grid, region);
+	auto largestMasked = math::function::argmax(grid, region, every);
+	EXPECT_EQ(largest.value, largestMasked.value);
+	EXPECT_EQ(largest.i, largestMasked.i);
+	EXPECT_EQ(largest.j, largestMasked.j);
+	auto smallest = math::function::argmin(grid, region, 3);
+	auto smallestMasked = math::function::argmin(grid, region, every);
+	EXPECT_EQ(smallest.i, smallestMasked.i);
+	EXPECT_EQ(smallest.j, smallestMasked.j);
+	
+	EXPECT_EQ(math::function::histogram(grid, 7, -8.0f, 8.0f, region), math::function::histogram(grid, 7, -8.0f, 8.0f, region, every));
+}
+
+TEST(GridReduction, DenseRows) {
+	// Contiguous rows, read straight from memory.
+	math::function::SquareGrid<float, float> rows(301, 97, 0.1f);
+	check_dense_rows(rows, math::function::GridRegion());
+	check_dense_rows(rows, math::function::GridRegion(13, 5, 250, 40));
+	check_dense_rows(rows, math::function::GridRegion(290, 0, 20, 97));
+	
+	// Rows split over tiles, point by point.
+	math::function::SquareGrid<float, float, math::function::TiledLayout<8>> tiles(301, 97, 0.1f);
+	check_dense_rows(tiles, math::function::GridRegion());
+	check_dense_rows(tiles, math::function::GridRegion(3, 2, 5, 90));
+}
+
+
+TEST(GridReduction, SparseAndFixedStorages) {
+	// Blocks of a sparse storage live apart: rows are never read straight from memory.
+	math::function::SquareGrid<double, double, math::function::RowMajorLayout, math::function::SparseTileStorage<double, 2>> sparse(8, 1, 1.0);
+	sparse.dataEvaluation(2,0) = 5.0;
+	sparse.dataEvaluation(4,0) = 7.0;
+	auto every = [](unsigned, unsigned) {return true;};
+	math::function::GridRegion region(0, 0, 5, 1);
+	EXPECT_DOUBLE_EQ(math::function::statistics(sparse, region).sum, 12.0);
+	EXPECT_DOUBLE_EQ(math::function::statistics(sparse, region, every).sum, 12.0);
+	EXPECT_EQ(math::function::argmax(sparse).i, 4u);
+	
+	math::function::SquareGrid<float, float, math::function::RowMajorLayout, math::function::SparseTileStorage<float, 16>> tiles(301, 97, 0.1f);
+	check_dense_rows(tiles, math::function::GridRegion(7, 3, 200, 50));
+	
+	// Fixed grids hold their values in place, in a single block.
+	math::function::FixedSquareGrid<float, float, 64, 40> fixed(0.1f);
+	check_dense_rows(fixed, math::function::GridRegion());
+	check_dense_rows(fixed, math::function::GridRegion(5, 5, 50, 20));
+}
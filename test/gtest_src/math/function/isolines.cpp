@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <math/function/square_grid.hpp>
+#include <math/function/isolines.hpp>
+#include <math/solver/laplace.hpp>
+
+
+TEST(Isolines, Circles) {
+	unsigned size = 81;
+	math::function::SquareGrid<double, double> grid(size, size, 0.05, math::linear::StaticVector<double, 2>({-2.0, -2.0}));
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			auto point = grid.domainfromij(i,j);
+			grid.dataEvaluation(i,j) = std::sqrt(point.dot());
+		}
+	}
+	
+	// Two closed circles and one circle cut by the border into four arcs.
+	std::vector<double> levels({0.5, 1.2, 2.5});
+	auto contours = math::function::isolines(grid, levels, 4);
+	ASSERT_EQ(contours.size(), 3u);
+	for (unsigned l = 0; l < 2; ++l) {
+		ASSERT_EQ(contours[l].closed.size(), 1u);
+		EXPECT_EQ(contours[l].open.size(), 0u);
+		const auto& circle = contours[l].closed[0];
+		EXPECT_NEAR(circle.area(), M_PI * levels[l] * levels[l], 0.02);
+		for (unsigned k = 0; k < circle.numberOfVertices(); ++k) {
+			EXPECT_NEAR(std::sqrt(circle.vertex(k).dot()), levels[l], 0.01);
+		}
+	}
+	
+	EXPECT_EQ(contours[2].closed.size(), 0u);
+	ASSERT_EQ(contours[2].open.size(), 4u);
+	for (const auto& arc : contours[2].open) {
+		EXPECT_NEAR(std::sqrt(arc.start().dot()), 2.5, 0.01);
+		EXPECT_NEAR(std::sqrt(arc.end().dot()), 2.5, 0.01);
+		EXPECT_NEAR(std::max(std::fabs(arc.start().x()), std::fabs(arc.start().y())), 2.0, 1e-12);
+		EXPECT_NEAR(std::max(std::fabs(arc.end().x()), std::fabs(arc.end().y())), 2.0, 1e-12);
+	}
+	
+	// Single level, and levels outside of the range.
+	auto single = math::function::isolines(grid, 1.2);
+	EXPECT_EQ(single.closed.size(), 1u);
+	EXPECT_EQ(math::function::isolines(grid, 10.0).open.size(), 0u);
+}
+
+
+TEST(Isolines, Deterministic) {
+	unsigned size = 64;
+	math::function::SquareGrid<double, double> grid(size, size, 0.1);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			grid.dataEvaluation(i,j) = std::sin(0.3 * i) * std::cos(0.25 * j);
+		}
+	}
+	
+	std::vector<double> levels({-0.5, 0.0, 0.3, 0.8});
+	auto serial = math::function::isolines(grid, levels, 1);
+	auto parallel = math::function::isolines(grid, levels, 7);
+	for (unsigned l = 0; l < levels.size(); ++l) {
+		ASSERT_EQ(serial[l].open.size(), parallel[l].open.size());
+		ASSERT_EQ(serial[l].closed.size(), parallel[l].closed.size());
+		EXPECT_GT(serial[l].open.size() + serial[l].closed.size(), 0u);
+		for (unsigned c = 0; c < serial[l].open.size(); ++c) {
+			ASSERT_EQ(serial[l].open[c].numberOfVertices(), parallel[l].open[c].numberOfVertices());
+			for (unsigned k = 0; k < serial[l].open[c].numberOfVertices(); ++k) {
+				EXPECT_EQ(serial[l].open[c][k], parallel[l].open[c][k]);
+			}
+		}
+		for (unsigned c = 0; c < serial[l].closed.size(); ++c) {
+			ASSERT_EQ(serial[l].closed[c].numberOfVertices(), parallel[l].closed[c].numberOfVertices());
+			for (unsigned k = 0; k < serial[l].closed[c].numberOfVertices(); ++k) {
+				EXPECT_EQ(serial[l].closed[c][k], parallel[l].closed[c][k]);
+			}
+		}
+	}
+}
+
+
+TEST(Isolines, LaplaceSolution) {
+	// Linear potential between two plates: equipotentials are vertical lines.
+	unsigned size = 20;
+	math::solver::laplace2::FDM<double, double> fdm(size, size, 1.0);
+	fdm.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 0.0);
+	fdm.setBoundary(math::solver::laplace2::GridEdge::RightEdge, 19.0);
+	for (unsigned i = 0; i < size; ++i) {
+		fdm.setBoundary(i, 0, i);
+		fdm.setBoundary(i, size-1, i);
+	}
+	for (unsigned k = 0; k < 2000; ++k) fdm.naiveIteration();
+	
+	auto contours = math::function::isolines(fdm, std::vector<double>({4.5, 12.25}), 2);
+	EXPECT_EQ(contours[0].open.size(), 1u);
+	EXPECT_EQ(contours[0].open[0].numberOfVertices(), size);
+	for (unsigned k = 0; k < size; ++k) EXPECT_NEAR(contours[0].open[0][k].x(), 4.5, 1e-6);
+	EXPECT_NEAR(contours[1].open[0].length(), 19.0, 1e-6);
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <math/function/square_grid.hpp>
+#include <math/function/mapped_storage.hpp>
+
+
+TEST(MappedStorage, TemporaryBackedGrid) {
+	using Grid = math::function::SquareGrid<float, float, math::function::TiledLayout<4>, math::function::MappedStorage<float>>;
+	unsigned size = 9;
+	Grid grid(size, size, 0.5);
+	
+	EXPECT_GE(grid.storage().size(), size*size);
+	EXPECT_FLOAT_EQ(grid.dataEvaluation(3,4), 0.0);
+	
+	grid.storage().advise(math::function::AccessHint::Sequential);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			auto point = grid.domainfromij(i,j);
+			grid.dataEvaluation(i,j) = point.x() + 2.0*point.y();
+		}
+	}
+	
+	math::function::prefetchWindow(grid, 2, 2, 4, 4);
+	EXPECT_FLOAT_EQ(grid.evaluate(1.25, 2.5), 6.25);
+	EXPECT_NEAR(grid.evaluate_gradient(math::linear::StaticVector<float,2>({1.3, 2.2})).y(), 2.0, 1e-5);
+	
+	// Derived grids keep the mapped storage.
+	auto gradient = grid.gradient();
+	EXPECT_NEAR(gradient.dataEvaluation(2,3).x(), 1.0, 1e-5);
+	EXPECT_NEAR(gradient.dataEvaluation(2,3).y(), 2.0, 1e-5);
+}
+
+TEST(MappedStorage, FileBackedGrid) {
+	using Grid = math::function::SquareGrid<double, double, math::function::RowMajorLayout, math::function::MappedStorage<double>>;
+	std::string path = testing::TempDir() + "mapped_storage_test.bin";
+	unsigned size = 6;
+	
+	{
+		math::function::MappedStorage<double> storage(path, size*size, math::function::MappingMode::Create, 64);
+		Grid grid(size, size, 1.0, math::linear::StaticVector<double,2>(), std::move(storage));
+		for (unsigned i = 0; i < size; ++i) {
+			for (unsigned j = 0; j < size; ++j) grid.dataEvaluation(i,j) = 10.0*i + j;
+		}
+		
+		grid.storage().evict(0, size*size);
+		EXPECT_DOUBLE_EQ(grid.dataEvaluation(4,5), 45.0);
+		grid.storage().flush();
+	}
+	
+	{
+		// Private mapping: writes do not reach the file.
+		math::function::MappedStorage<double> storage(path, size*size, math::function::MappingMode::CopyOnWrite, 64);
+		Grid grid(size, size, 1.0, math::linear::StaticVector<double,2>(), std::move(storage));
+		EXPECT_DOUBLE_EQ(grid.dataEvaluation(4,5), 45.0);
+		EXPECT_DOUBLE_EQ(grid.evaluate(2.5, 1.5), 26.5);
+		grid.dataEvaluation(4,5) = -1.0;
+		
+		// Evicting keeps the private writes.
+		grid.storage().evict(0, size*size);
+		EXPECT_DOUBLE_EQ(grid.dataEvaluation(4,5), -1.0);
+	}
+	
+	{
+		math::function::MappedStorage<double> storage(path, size*size, math::function::MappingMode::Open, 64);
+		EXPECT_DOUBLE_EQ(storage[5*size + 4], 45.0);
+		EXPECT_THROW(math::function::MappedStorage<double>(path, 2*size*size, math::function::MappingMode::Open, 64), std::runtime_error);
+	}
+	
+	{
+		// Creating over an existing file grows it and keeps its contents.
+		math::function::MappedStorage<double> storage(path, 2*size*size, math::function::MappingMode::Create, 64);
+		EXPECT_DOUBLE_EQ(storage[5*size + 4], 45.0);
+		EXPECT_DOUBLE_EQ(storage[2*size*size - 1], 0.0);
+	}
+	
+	std::remove(path.c_str());
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <math/function/square_grid.hpp>
+#include <math/function/cubic_interpolation.hpp>
+#include <math/function/resample.hpp>
+#include <math/solver/laplace.hpp>
+
+
+namespace {
+
+template <typename Grid, typename Function>
+void fill(Grid& grid, Function function) {
+	for (unsigned i = 0; i < grid.sizex(); ++i) {
+		for (unsigned j = 0; j < grid.sizey(); ++j) {
+			auto point = grid.domainfromij(i,j);
+			grid.dataEvaluation(i,j) = function(point.x(), point.y());
+		}
+	}
+}
+
+}
+
+
+TEST(Resample, Prolongation) {
+	math::function::SquareGrid<double, double> coarse(11, 9, 0.2, math::linear::StaticVector<double, 2>({-1.0, 0.5}));
+	fill(coarse, [](double x, double y) {return 3.0 * x - 2.0 * y + 1.0;});
+	
+	// Bilinear is exact for linear fields, and matches evaluate() everywhere.
+	math::function::SquareGrid<double, double> fine(41, 33, 0.05, math::linear::StaticVector<double, 2>({-1.0, 0.5}));
+	math::function::prolongation(coarse, fine, math::function::ResampleMethod::Bilinear, 3);
+	for (unsigned i = 0; i < fine.sizex(); ++i) {
+		for (unsigned j = 0; j < fine.sizey(); ++j) {
+			auto point = fine.domainfromij(i,j);
+			EXPECT_NEAR(fine.dataEvaluation(i,j), 3.0 * point.x() - 2.0 * point.y() + 1.0, 1e-12);
+		}
+	}
+	
+	// Bicubic matches the Catmull-Rom interpolator.
+	fill(coarse, [](double x, double y) {return std::sin(2.0 * x) * std::cos(y);});
+	math::function::CubicInterpolator<double> cubic(coarse);
+	math::function::resample(coarse, fine, math::function::ResampleMethod::Bicubic, 2);
+	for (unsigned i = 0; i < fine.sizex(); ++i) {
+		for (unsigned j = 0; j < fine.sizey(); ++j) {
+			EXPECT_NEAR(fine.dataEvaluation(i,j), cubic.evaluate(fine.domainfromij(i,j)), 1e-12);
+		}
+	}
+}
+
+
+TEST(Resample, Restriction) {
+	math::function::SquareGrid<double, double> fine(21, 17, 0.1);
+	fill(fine, [](double x, double y) {return x * x + y;});
+	
+	// Full weighting of x^2 + y adds h^2 / 2 away from the edges.
+	math::function::SquareGrid<double, double> coarse(11, 9, 0.2);
+	math::function::restriction(fine, coarse, 4);
+	for (unsigned i = 1; i < coarse.sizex()-1; ++i) {
+		for (unsigned j = 1; j < coarse.sizey()-1; ++j) {
+			auto point = coarse.domainfromij(i,j);
+			EXPECT_NEAR(coarse.dataEvaluation(i,j), point.x() * point.x() + point.y() + 0.005, 1e-12);
+		}
+	}
+	
+	// Sub-grids of coarse points and invalid coarse grids.
+	math::function::SquareGrid<double, double> inner(4, 3, 0.2, math::linear::StaticVector<double, 2>({0.4, 0.6}));
+	math::function::restriction(fine, inner);
+	EXPECT_DOUBLE_EQ(inner.dataEvaluation(2,1), coarse.dataEvaluation(4,4));
+	
+	math::function::SquareGrid<double, double> shifted(4, 3, 0.2, math::linear::StaticVector<double, 2>({0.05, 0.0}));
+	EXPECT_THROW(math::function::restriction(fine, shifted), std::invalid_argument);
+	math::function::SquareGrid<double, double> large(12, 9, 0.2);
+	EXPECT_THROW(math::function::restriction(fine, large), std::invalid_argument);
+	math::function::SquareGrid<double, double> spaced(5, 5, 0.3);
+	EXPECT_THROW(math::function::restriction(fine, spaced), std::invalid_argument);
+}
+
+
+TEST(Resample, Affine) {
+	math::function::SquareGrid<double, double> source(41, 41, 0.05, math::linear::StaticVector<double, 2>({-1.0, -1.0}));
+	fill(source, [](double x, double y) {return 2.0 * x + y;});
+	
+	// Rotation by a quarter turn and a shift: target (x,y) reads source (-y + 0.1, x).
+	math::linear::StaticMatrix<double, 2, 2> rotation({0.0, -1.0, 1.0, 0.0});
+	math::linear::StaticVector<double, 2> offset({0.1, 0.0});
+	math::function::SquareGrid<double, double> target(15, 12, 0.07, math::linear::StaticVector<double, 2>({-0.5, -0.4}));
+	math::function::resample(source, target, rotation, offset, math::function::ResampleMethod::Bilinear, 3);
+	for (unsigned i = 0; i < target.sizex(); ++i) {
+		for (unsigned j = 0; j < target.sizey(); ++j) {
+			auto point = target.domainfromij(i,j);
+			EXPECT_NEAR(target.dataEvaluation(i,j), 2.0 * (0.1 - point.y()) + point.x(), 1e-12);
+		}
+	}
+	
+	// The identity map is the plain resample, also for bicubic.
+	math::function::SquareGrid<double, double> affine(15, 12, 0.07, math::linear::StaticVector<double, 2>({-0.5, -0.4}));
+	fill(source, [](double x, double y) {return std::exp(x) * y;});
+	math::function::resample(source, target, math::function::ResampleMethod::Bicubic);
+	math::function::resample(source, affine, math::linear::StaticMatrix<double, 2, 2>({1.0, 0.0, 0.0, 1.0}), math::linear::StaticVector<double, 2>(), math::function::ResampleMethod::Bicubic);
+	for (unsigned i = 0; i < target.sizex(); ++i) {
+		for (unsigned j = 0; j < target.sizey(); ++j) EXPECT_NEAR(affine.dataEvaluation(i,j), target.dataEvaluation(i,j), 1e-12);
+	}
+	
+	// Points outside of the source take the edge values.
+	math::function::SquareGrid<double, double> outside(3, 3, 1.0, math::linear::StaticVector<double, 2>({2.0, 0.0}));
+	math::function::resample(source, outside);
+	EXPECT_NEAR(outside.dataEvaluation(0,0), source.dataEvaluation(40,20), 1e-12);
+}
+
+
+TEST(Resample, WarmStart) {
+	math::solver::laplace2::FDM<double, double> coarse(6, 6, 2.0);
+	math::solver::laplace2::FDM<double, double> fine(11, 11, 1.0);
+	for (auto* fdm : {&coarse, &fine}) {
+		fdm->setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+		fdm->setBoundary(math::solver::laplace2::GridEdge::RightEdge, 5.0);
+	}
+	for (unsigned k = 0; k < 500; ++k) coarse.naiveIteration();
+	
+	// The boundary of the fine solver is kept, its interior starts from the coarse solution.
+	math::function::prolongation(coarse, fine);
+	for (unsigned j = 0; j < fine.sizey(); ++j) {
+		EXPECT_DOUBLE_EQ(fine.dataEvaluation(0,j).value(), 1.0);
+		EXPECT_DOUBLE_EQ(fine.dataEvaluation(10,j).value(), 5.0);
+	}
+	EXPECT_NEAR(fine.dataEvaluation(5,5).value(), coarse.dataEvaluation(2,2).value() * 0.5 + coarse.dataEvaluation(3,2).value() * 0.5, 1e-12);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <math/function/square_grid.hpp>
+#include <math/function/sparse_storage.hpp>
+
+
+TEST(SparseTileStorage, UniformBlocks) {
+	math::function::SparseTileStorage<double, 16> storage(100, 1.5);
+	EXPECT_EQ(storage.size(), 100u);
+	EXPECT_EQ(storage.blocks(), 7u);
+	EXPECT_EQ(storage.allocatedBlocks(), 0u);
+	
+	// Const access does not allocate.
+	const auto& constant = storage;
+	for (unsigned k = 0; k < 100; ++k) EXPECT_DOUBLE_EQ(constant[k], 1.5);
+	EXPECT_EQ(storage.allocatedBlocks(), 0u);
+	
+	// Writing materialises the block only.
+	storage[20] = 3.0;
+	EXPECT_EQ(storage.allocatedBlocks(), 1u);
+	EXPECT_FALSE(storage.uniform(1));
+	EXPECT_DOUBLE_EQ(constant[20], 3.0);
+	EXPECT_DOUBLE_EQ(constant[21], 1.5);
+	EXPECT_DOUBLE_EQ(constant[40], 1.5);
+	
+	// Collapses again once uniform.
+	EXPECT_EQ(storage.compact(), 0u);
+	storage[20] = 1.5;
+	EXPECT_EQ(storage.compact(), 1u);
+	EXPECT_EQ(storage.allocatedBlocks(), 0u);
+	
+	storage.fill(6, -2.0);
+	EXPECT_DOUBLE_EQ(constant[99], -2.0);
+	EXPECT_TRUE(storage.uniform(6));
+}
+
+
+TEST(SparseTileStorage, SquareGridAccessors) {
+	unsigned size = 20;
+	using Storage = math::function::SparseTileStorage<double, 16>;
+	math::function::SquareGrid<double, double, math::function::TiledLayout<4>, Storage> sparse(size, size, 0.1);
+	math::function::SquareGrid<double, double> dense(size, size, 0.1);
+	
+	sparse.setValueAllSquares(2.0);
+	dense.setValueAllSquares(2.0);
+	EXPECT_EQ(sparse.storage().allocatedBlocks(), 0u);
+	
+	for (unsigned i = 5; i < 9; ++i) {
+		for (unsigned j = 2; j < 7; ++j) {
+			sparse.dataEvaluation(i,j) = 0.1 * i * j;
+			dense.dataEvaluation(i,j) = 0.1 * i * j;
+		}
+	}
+	
+	// Only the tiles holding the changed points are allocated.
+	EXPECT_EQ(sparse.storage().allocatedBlocks(), 4u);
+	
+	const auto& reader = sparse;
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			EXPECT_DOUBLE_EQ(reader.dataEvaluation(i,j), dense.dataEvaluation(i,j));
+		}
+	}
+	
+	math::linear::StaticVector<double, 2> coord({0.63, 0.41});
+	EXPECT_DOUBLE_EQ(reader.evaluate(coord), dense.evaluate(coord));
+	EXPECT_DOUBLE_EQ(reader.evaluate_partial_x(coord), dense.evaluate_partial_x(coord));
+	
+	// Operators returning grids keep the storage kind.
+	auto gradient = reader.gradient();
+	EXPECT_DOUBLE_EQ(gradient.dataEvaluation(6,4).x(), dense.gradient().dataEvaluation(6,4).x());
+}
@@ -139,4 +139,74 @@ TEST(SquareGridTest, GradientTests) {
 	// display_grid<float, float>(small_partial_x);
 	// display_grid<float, float>(small_partial_y);
 	// display_grid<float, math::linear::StaticVector<float,2>>(small_gradient);
-}
\ No newline at end of file
+}
+
+TEST(SquareGridTest, PointwiseGradientTests) {
+	unsigned size = 6;
+	float step = 1 / (static_cast<float>(size-1));
+	
+	// Linear function: derivatives are exact everywhere, edges included.
+	math::function::SquareGrid<float, float> linear(size, size, step);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			auto point = linear.domainfromij(i,j);
+			linear.dataEvaluation(i, j) = 2.0*point.x() - 3.0*point.y();
+		}
+	}
+	
+	std::vector<math::linear::StaticVector<float, 2>> coords({
+		math::linear::StaticVector<float, 2>({0.0, 0.0}),
+		math::linear::StaticVector<float, 2>({0.13, 0.71}),
+		math::linear::StaticVector<float, 2>({0.5, 0.5}),
+		math::linear::StaticVector<float, 2>({1.0, 0.33}),
+		math::linear::StaticVector<float, 2>({1.0, 1.0}),
+	});
+	
+	for (const auto& coord : coords) {
+		EXPECT_NEAR(linear.evaluate_partial_x(coord), 2.0, 1e-4);
+		EXPECT_NEAR(linear.evaluate_partial_y(coord), -3.0, 1e-4);
+		EXPECT_NEAR(linear.evaluate_gradient(coord).x(), 2.0, 1e-4);
+		EXPECT_NEAR(linear.evaluate_gradient(coord).y(), -3.0, 1e-4);
+	}
+	
+	// Quadratic function: matches the interpolated derivative grids in the interior.
+	math::function::SquareGrid<float, float> quadratic(size, size, step);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			auto point = quadratic.domainfromij(i,j);
+			quadratic.dataEvaluation(i, j) = point.x()*point.x() / 2.0 + point.y()*point.y();
+		}
+	}
+	
+	auto partial_x = quadratic.partial_x();
+	auto partial_y = quadratic.partial_y();
+	std::vector<math::linear::StaticVector<float, 2>> inner({
+		math::linear::StaticVector<float, 2>({0.25, 0.3}),
+		math::linear::StaticVector<float, 2>({0.41, 0.59}),
+		math::linear::StaticVector<float, 2>({0.7, 0.22}),
+	});
+	
+	std::vector<float> xvalues;
+	std::vector<float> yvalues;
+	std::vector<math::linear::StaticVector<float, 2>> gradients;
+	quadratic.evaluate_partial_x(inner, xvalues);
+	quadratic.evaluate_partial_y(inner, yvalues);
+	quadratic.evaluate_gradient(inner, gradients);
+	ASSERT_EQ(xvalues.size(), inner.size());
+	ASSERT_EQ(yvalues.size(), inner.size());
+	ASSERT_EQ(gradients.size(), inner.size());
+	
+	for (unsigned k = 0; k < inner.size(); ++k) {
+		EXPECT_NEAR(xvalues[k], partial_x.evaluate(inner[k]), 1e-5);
+		EXPECT_NEAR(yvalues[k], partial_y.evaluate(inner[k]), 1e-5);
+		EXPECT_NEAR(gradients[k].x(), inner[k].x(), 1e-5);
+		EXPECT_NEAR(gradients[k].y(), 2.0*inner[k].y(), 1e-5);
+	}
+	
+	// Batched interpolation.
+	std::vector<float> values;
+	quadratic.evaluate(inner, values);
+	for (unsigned k = 0; k < inner.size(); ++k) EXPECT_FLOAT_EQ(values[k], quadratic.evaluate(inner[k]));
+	
+	EXPECT_THROW(quadratic.evaluate_partial_x(math::linear::StaticVector<float, 2>({1.1, 0.5})), std::invalid_argument);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <math/function/square_grid.hpp>
+#include <math/function/square_grid_view.hpp>
+#include <math/function/differential.hpp>
+#include <math/function/grid_reduction.hpp>
+#include <math/function/grid_export.hpp>
+#include <math/solver/laplace.hpp>
+
+
+TEST(SquareGridView, AccessorsAndInterpolation) {
+	unsigned size = 21;
+	math::function::SquareGrid<double, double> grid(size, size, 0.1, math::linear::StaticVector<double, 2>({-1.0, 2.0}));
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			auto point = grid.domainfromij(i,j);
+			grid.dataEvaluation(i,j) = point.x() * point.x() + 3.0 * point.y();
+		}
+	}
+	
+	// Points 4, 6, ... 16 in x and 2, 4, ... 10 in y.
+	auto view = math::function::gridView(grid, 4, 2, 7, 5, 2);
+	EXPECT_EQ(view.sizex(), 7u);
+	EXPECT_EQ(view.sizey(), 5u);
+	EXPECT_DOUBLE_EQ(view.spacing(), 0.2);
+	EXPECT_DOUBLE_EQ(view.start().x(), -0.6);
+	EXPECT_DOUBLE_EQ(view.start().y(), 2.2);
+	EXPECT_NEAR(view.end().x(), 0.6, 1e-12);
+	EXPECT_NEAR(view.end().y(), 3.0, 1e-12);
+	EXPECT_DOUBLE_EQ(view.dataEvaluation(3,1), grid.dataEvaluation(10,4));
+	EXPECT_EQ(view.domainfromij(3,1), grid.domainfromij(10,4));
+	
+	// Interpolation in world coordinates, on the view points.
+	EXPECT_NEAR(view.evaluate(-0.6, 2.2), grid.dataEvaluation(4,2), 1e-12);
+	math::function::SquareGrid<double, double> coarse(7, 5, 0.2, view.start());
+	for (unsigned i = 0; i < 7; ++i) for (unsigned j = 0; j < 5; ++j) coarse.dataEvaluation(i,j) = view.dataEvaluation(i,j);
+	math::linear::StaticVector<double, 2> coord({0.13, 2.71});
+	EXPECT_NEAR(view.evaluate(coord), coarse.evaluate(coord), 1e-12);
+	EXPECT_NEAR(view.evaluate_partial_x(coord), coarse.evaluate_partial_x(coord), 1e-12);
+	EXPECT_NEAR(view.evaluate_gradient(coord).y(), coarse.evaluate_gradient(coord).y(), 1e-12);
+	EXPECT_THROW(view.evaluate(0.8, 2.5), std::invalid_argument);
+	
+	// Writes go to the grid.
+	view.dataEvaluation(0,0) = 42.0;
+	EXPECT_DOUBLE_EQ(grid.dataEvaluation(4,2), 42.0);
+	
+	// Views of const grids and views of views.
+	const auto& constant = grid;
+	auto reader = math::function::gridView(constant, 1, 1, 19, 19);
+	auto inner = math::function::gridView(reader, 3, 1, 3, 3, 2);
+	EXPECT_DOUBLE_EQ(inner.dataEvaluation(0,0), 42.0);
+	EXPECT_DOUBLE_EQ(inner.spacing(), 0.2);
+	
+	EXPECT_THROW(math::function::gridView(grid, 4, 2, 10, 5, 2), std::invalid_argument);
+}
+
+
+TEST(SquareGridView, Algorithms) {
+	unsigned size = 30;
+	math::function::SquareGrid<double, double> grid(size, size, 0.1);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			grid.dataEvaluation(i,j) = 1.0 * i - 0.5 * j * j;
+		}
+	}
+	
+	auto view = math::function::gridView(grid, 10, 5, 12, 8);
+	
+	// Reductions.
+	EXPECT_DOUBLE_EQ(math::function::maximum(view), 21.0 - 0.5 * 25.0);
+	EXPECT_DOUBLE_EQ(math::function::sum(view), math::function::sum(grid, math::function::GridRegion(10, 5, 12, 8)));
+	
+	// Differential operators.
+	math::function::SquareGrid<double, double> laplacian(10, 6, 0.1);
+	math::function::laplacian(view, laplacian);
+	for (unsigned i = 0; i < 10; ++i) {
+		for (unsigned j = 0; j < 6; ++j) EXPECT_NEAR(laplacian.dataEvaluation(i,j), -100.0, 1e-9);
+	}
+	
+	// Exporters.
+	std::string path = testing::TempDir() + "square_grid_view.csv";
+	math::function::exportCSV(path, view);
+	std::ifstream file(path);
+	std::string line;
+	unsigned lines = 0;
+	while (std::getline(file, line)) ++lines;
+	EXPECT_EQ(lines, 1u + 12u * 8u);
+	std::remove(path.c_str());
+}
+
+
+TEST(SquareGridView, SubDomainSolver) {
+	unsigned size = 12;
+	math::solver::laplace2::FDM<double, double> whole(size, size, 1.0);
+	math::solver::laplace2::FDM<double, double> viewed(size, size, 1.0);
+	for (auto* fdm : {&whole, &viewed}) {
+		fdm->setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+		fdm->setBoundary(math::solver::laplace2::GridEdge::RightEdge, 2.0);
+		fdm->setBoundary(math::solver::laplace2::GridEdge::UpperEdge, 3.0);
+		fdm->setBoundary(math::solver::laplace2::GridEdge::LowerEdge, 4.0);
+	}
+	
+	// Iterating a view covering the grid matches the solver itself.
+	auto view = math::function::gridView(viewed, 0, 0, size, size);
+	for (unsigned k = 0; k < 5; ++k) {
+		whole.naiveIteration();
+		math::solver::laplace2::naiveIteration(view);
+	}
+	
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			EXPECT_DOUBLE_EQ(viewed.dataEvaluation(i,j).value(), whole.dataEvaluation(i,j).value());
+		}
+	}
+	
+	// A sub-domain leaves the rest untouched.
+	auto corner = math::function::gridView(viewed, 0, 0, 4, 4);
+	double outside = viewed.dataEvaluation(6,6).value();
+	math::solver::laplace2::naiveIteration(corner);
+	EXPECT_DOUBLE_EQ(viewed.dataEvaluation(6,6).value(), outside);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <math/function/square_grid.hpp>
+#include <math/function/differential.hpp>
+#include <math/function/vector_field_grid.hpp>
+
+
+TEST(VectorFieldGrid, ComponentPlanes) {
+	unsigned size = 13;
+	math::function::VectorFieldGrid<double, double> field(size, size, 0.5);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			field.setData(i, j, math::linear::StaticVector<double, 2>({1.0*i, -2.0*j}));
+		}
+	}
+	
+	EXPECT_DOUBLE_EQ(field.dataEvaluation(3,4).x(), 3.0);
+	EXPECT_DOUBLE_EQ(field.dataEvaluation(3,4).y(), -8.0);
+	EXPECT_DOUBLE_EQ(field.component(1, 3, 4), -8.0);
+	
+	// Planes are aligned, contiguous and hold a single component.
+	auto xs = field.component(0);
+	auto ys = field.component(1);
+	EXPECT_EQ(xs.size(), size*size);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(xs.data()) % 64, 0u);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ys.data()) % 64, 0u);
+	double sum = 0.0;
+	for (double value : ys) sum += value;
+	EXPECT_DOUBLE_EQ(sum, -2.0 * size * (size*(size-1)/2));
+	
+	// Writing through a span.
+	xs[field.datafromij(2,2)] = 7.0;
+	EXPECT_DOUBLE_EQ(field.dataEvaluation(2,2).x(), 7.0);
+	EXPECT_THROW(field.component(2), std::invalid_argument);
+	
+	// Interpolation is linear in each component.
+	auto value = field.evaluate(1.25, 2.0);
+	EXPECT_NEAR(value.x(), 2.5, 1e-12);
+	EXPECT_NEAR(value.y(), -8.0, 1e-12);
+}
+
+
+TEST(VectorFieldGrid, GradientAndMagnitude) {
+	unsigned size = 21;
+	math::function::SquareGrid<double, double> phi(size, size, 0.05);
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			auto point = phi.domainfromij(i,j);
+			phi.dataEvaluation(i,j) = std::sin(point.x()) * point.y();
+		}
+	}
+	
+	// Same values as the interleaved gradient.
+	auto interleaved = phi.gradient();
+	math::function::VectorFieldGrid<double, double> converted(interleaved);
+	math::function::VectorFieldGrid<double, double> field(size-2, size-2, phi.spacing(), interleaved.start());
+	math::function::gradient(phi, field, 3);
+	
+	auto magnitude = field.magnitude(2);
+	for (unsigned i = 0; i < size-2; ++i) {
+		for (unsigned j = 0; j < size-2; ++j) {
+			EXPECT_NEAR(field.dataEvaluation(i,j).x(), interleaved.dataEvaluation(i,j).x(), 1e-12);
+			EXPECT_NEAR(field.dataEvaluation(i,j).y(), interleaved.dataEvaluation(i,j).y(), 1e-12);
+			EXPECT_DOUBLE_EQ(converted.dataEvaluation(i,j).x(), interleaved.dataEvaluation(i,j).x());
+			
+			auto vector = field.dataEvaluation(i,j);
+			EXPECT_NEAR(magnitude.dataEvaluation(i,j), std::sqrt(vector.x()*vector.x() + vector.y()*vector.y()), 1e-12);
+		}
+	}
+	
+	math::function::VectorFieldGrid<double, double> wrong(size, size, phi.spacing());
+	EXPECT_THROW(math::function::gradient(phi, wrong), std::invalid_argument);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <math/linear/static_matrix.hpp>
+
+template <typename T, unsigned Rows, unsigned Cols>
+math::linear::StaticMatrix<T, Rows, Cols> make_matrix(T seed) {
+	math::linear::StaticMatrix<T, Rows, Cols> matrix;
+	for (unsigned i = 0; i < Rows; ++i) {
+		for (unsigned j = 0; j < Cols; ++j) matrix(i, j) = seed * static_cast<T>(i + 1) - static_cast<T>(j * j) + T(0.5);
+	}
+
+	return matrix;
+}
+
+template <typename T, unsigned Rows, unsigned Inter, unsigned Cols>
+void check_product(T seed) {
+	auto a = make_matrix<T, Rows, Inter>(seed);
+	auto b = make_matrix<T, Inter, Cols>(-seed);
+	math::linear::StaticMatrix<T, Rows, Cols> c = a * b;
+	for (unsigned i = 0; i < Rows; ++i) {
+		for (unsigned j = 0; j < Cols; ++j) {
+			T expected = T();
+			for (unsigned k = 0; k < Inter; ++k) expected += a(i, k) * b(k, j);
+			EXPECT_DOUBLE_EQ(c(i, j), expected);
+		}
+	}
+
+	math::linear::StaticVector<T, Inter> vec;
+	for (unsigned k = 0; k < Inter; ++k) vec[k] = seed - static_cast<T>(k);
+	math::linear::StaticVector<T, Rows> product = a * vec;
+	for (unsigned i = 0; i < Rows; ++i) {
+		T expected = T();
+		for (unsigned k = 0; k < Inter; ++k) expected += a(i, k) * vec[k];
+		EXPECT_DOUBLE_EQ(product[i], expected);
+	}
+}
+
+TEST(StaticMatrix, MatrixProduct) {
+	check_product<double, 2, 2, 2>(1.5);
+	check_product<double, 3, 3, 3>(-0.25);
+	check_product<double, 4, 4, 4>(2.0);
+	check_product<double, 2, 3, 4>(0.75);
+	check_product<double, 5, 5, 5>(1.25);
+	check_product<double, 3, 1, 2>(3.0);
+}
+
+TEST(StaticMatrix, ProductOperators) {
+	math::linear::StaticMatrix2 rotation({0.0, -1.0, 1.0, 0.0});
+	math::linear::StaticMatrix2 scale({2.0, 0.0, 0.0, 3.0});
+
+	// Not commutative: rotating then scaling differs from scaling then rotating.
+	auto first = scale * rotation;
+	auto second = rotation * scale;
+	EXPECT_DOUBLE_EQ(first(0, 1), -2.0);
+	EXPECT_DOUBLE_EQ(second(0, 1), -3.0);
+
+	math::linear::StaticMatrix2 accumulated = scale;
+	accumulated *= rotation;
+	for (unsigned k = 0; k < 4; ++k) EXPECT_DOUBLE_EQ(accumulated[k], first[k]);
+
+	// The identity is neutral.
+	auto matrix = make_matrix<double, 4, 4>(0.5);
+	auto identity = math::linear::StaticMatrix4::eye();
+	auto left = identity * matrix;
+	auto right = matrix * identity;
+	for (unsigned k = 0; k < 16; ++k) {
+		EXPECT_DOUBLE_EQ(left[k], matrix[k]);
+		EXPECT_DOUBLE_EQ(right[k], matrix[k]);
+	}
+
+	// Same results through matrixMultiplication.
+	auto product = math::linear::matrixMultiplication(matrix, identity);
+	for (unsigned k = 0; k < 16; ++k) EXPECT_DOUBLE_EQ(product[k], matrix[k]);
+
+	auto rotated = rotation * math::linear::StaticVector<double, 2>({1.0, 2.0});
+	EXPECT_DOUBLE_EQ(rotated.x(), -2.0);
+	EXPECT_DOUBLE_EQ(rotated.y(), 1.0);
+}
+
+template <typename T, unsigned N>
+void check_inverse(T seed) {
+	// Diagonally dominant, so well conditioned.
+	auto matrix = make_matrix<T, N, N>(seed);
+	for (unsigned i = 0; i < N; ++i) matrix(i, i) += T(4 * N * N) * seed;
+
+	auto result = matrix.tryInverse();
+	EXPECT_FALSE(result.singular);
+	auto identity = matrix * result.matrix;
+	for (unsigned i = 0; i < N; ++i) {
+		for (unsigned j = 0; j < N; ++j) EXPECT_NEAR(identity(i, j), i == j ? T(1) : T(0), 1e-12);
+	}
+
+	// Same values as the inverse throwing on singular matrices.
+	auto inverse = matrix.inverse();
+	for (unsigned k = 0; k < N * N; ++k) EXPECT_DOUBLE_EQ(inverse[k], result.matrix[k]);
+
+	// The inverse has the reciprocal determinant.
+	EXPECT_NEAR(matrix.det() * inverse.det(), T(1), 1e-12);
+}
+
+TEST(StaticMatrix, DeterminantAndInverse) {
+	constexpr math::linear::StaticMatrix2 matrix({3.0, 1.0, 2.0, 2.0});
+	static_assert(matrix.det() == 4.0, "Closed forms are constant expressions");
+	constexpr auto inverse = matrix.tryInverse();
+	static_assert(not inverse.singular and inverse.matrix(0, 0) == 0.5 and inverse.matrix(1, 0) == -0.5, "Closed forms are constant expressions");
+	EXPECT_DOUBLE_EQ(inverse.matrix(1, 1), 0.75);
+
+	EXPECT_DOUBLE_EQ(math::linear::StaticMatrix3({2.0, 0.0, 1.0, 1.0, 3.0, 2.0, 1.0, 1.0, 2.0}).det(), 6.0);
+	EXPECT_DOUBLE_EQ(math::linear::StaticMatrix4::eye().det(), 1.0);
+
+	check_inverse<double, 2>(1.5);
+	check_inverse<double, 3>(-0.25);
+	check_inverse<double, 4>(2.0);
+	check_inverse<double, 5>(1.25);
+
+	// Singular matrices are flagged, and do not invert.
+	math::linear::StaticMatrix3 singular({1.0, 2.0, 3.0, 2.0, 4.0, 6.0, 0.0, 1.0, 1.0});
+	EXPECT_DOUBLE_EQ(singular.det(), 0.0);
+	EXPECT_TRUE(singular.tryInverse().singular);
+	EXPECT_THROW(singular.inverse(), std::logic_error);
+	EXPECT_TRUE((math::linear::StaticMatrix4({1.0, 2.0, 3.0, 4.0, 1.0, 2.0, 3.0, 4.0, 0.0, 1.0, 0.0, 1.0, 1.0, 0.0, 1.0, 0.0}).tryInverse().singular));
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <math/memory/workspace.hpp>
+#include <math/function/square_grid.hpp>
+#include <math/function/square_grid_view.hpp>
+#include <math/function/sparse_storage.hpp>
+#include <math/solver/laplace.hpp>
+
+
+TEST(Workspace, Recycling) {
+	math::memory::Workspace workspace;
+	void* first = workspace.acquire(1000);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(first) % 64, 0u);
+	EXPECT_EQ(workspace.allocations(), 1u);
+	EXPECT_EQ(workspace.allocatedBytes(), 1024u);
+	
+	// Released buffers serve the next requests they fit, the smallest first.
+	void* large = workspace.acquire(4096);
+	workspace.release(first);
+	workspace.release(large);
+	EXPECT_EQ(workspace.acquire(500), first);
+	EXPECT_EQ(workspace.acquire(2000), large);
+	EXPECT_EQ(workspace.recycles(), 2u);
+	EXPECT_EQ(workspace.recycledBytes(), 512u + 2048u);
+	EXPECT_EQ(workspace.allocatedBytes(), 1024u + 4096u);
+	
+	// Nothing free fits: a new buffer.
+	void* other = workspace.acquire(100);
+	EXPECT_EQ(workspace.allocations(), 3u);
+	EXPECT_EQ(workspace.heldBytes(), 1024u + 4096u + 128u);
+	
+	workspace.release(other);
+	workspace.trim();
+	EXPECT_EQ(workspace.heldBytes(), 1024u + 4096u);
+	workspace.release(first);
+	workspace.release(large);
+}
+
+
+TEST(Workspace, GridOperators) {
+	math::function::SquareGrid<double, double> grid(40, 30, 0.1);
+	for (unsigned i = 0; i < 40; ++i) {
+		for (unsigned j = 0; j < 30; ++j) grid.dataEvaluation(i,j) = i * i - 3.0 * i * j;
+	}
+	
+	auto partial = grid.partial_x();
+	auto gradient = grid.gradient();
+	math::memory::Workspace workspace;
+	for (unsigned k = 0; k < 10; ++k) {
+		auto scratch = grid.partial_x(workspace);
+		auto scratchy = grid.partial_y(workspace);
+		auto scratchgradient = grid.gradient(workspace);
+		ASSERT_EQ(scratch.sizex(), partial.sizex());
+		EXPECT_EQ(scratch.start(), partial.start());
+		for (unsigned i = 0; i < scratch.sizex(); ++i) {
+			for (unsigned j = 0; j < scratch.sizey(); ++j) EXPECT_DOUBLE_EQ(scratch.dataEvaluation(i,j), partial.dataEvaluation(i,j));
+		}
+		EXPECT_DOUBLE_EQ(scratchy.dataEvaluation(5,5), grid.partial_y().dataEvaluation(5,5));
+		EXPECT_EQ(scratchgradient.dataEvaluation(7,3), gradient.dataEvaluation(7,3));
+	}
+	
+	// Only the first round allocates.
+	EXPECT_EQ(workspace.allocations(), 3u);
+	EXPECT_EQ(workspace.recycles(), 27u);
+	EXPECT_EQ(workspace.recycledBytes(), 9 * workspace.allocatedBytes());
+}
+
+
+TEST(Workspace, Solver) {
+	math::memory::Workspace workspace;
+	math::solver::laplace2::FDM<double, double> own(20, 20, 1.0);
+	math::solver::laplace2::FDM<double, double> borrowing(20, 20, 1.0, math::linear::StaticVector<double, 2>(), workspace);
+	for (auto* fdm : {&own, &borrowing}) {
+		fdm->setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+		fdm->setBoundary(math::solver::laplace2::GridEdge::UpperEdge, 3.0);
+	}
+	
+	for (unsigned k = 0; k < 50; ++k) {
+		own.naiveIteration();
+		borrowing.naiveIteration();
+	}
+	
+	for (unsigned i = 0; i < 20; ++i) {
+		for (unsigned j = 0; j < 20; ++j) EXPECT_DOUBLE_EQ(borrowing.dataEvaluation(i,j).value(), own.dataEvaluation(i,j).value());
+	}
+	EXPECT_EQ(workspace.allocations(), 1u);
+	EXPECT_EQ(workspace.recycles(), 49u);
+}
+
+
+TEST(Workspace, SparseSolver) {
+	using Storage = math::function::SparseTileStorage<math::solver::FiniteElement<double>, 16>;
+	math::memory::Workspace workspace;
+	math::solver::laplace2::FDM<double, double> dense(32, 32, 1.0);
+	math::solver::laplace2::FDM<double, double, math::function::RowMajorLayout, Storage> own(32, 32, 1.0);
+	math::solver::laplace2::FDM<double, double, math::function::RowMajorLayout, Storage> borrowing(32, 32, 1.0, math::linear::StaticVector<double, 2>(), workspace);
+	dense.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 0.0);
+	dense.setBoundary(math::solver::laplace2::GridEdge::UpperEdge, 5.0);
+	// Collapsed blocks keep frozen and free points apart.
+	for (auto* fdm : {&own, &borrowing}) {
+		fdm->setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 0.0);
+		fdm->setBoundary(math::solver::laplace2::GridEdge::UpperEdge, 5.0);
+		fdm->storage().compact([](const math::solver::FiniteElement<double>& a, const math::solver::FiniteElement<double>& b) {
+			return a.value() == b.value() and a.frozen() == b.frozen();
+		});
+	}
+	
+	// Uniform blocks of the solver fill their range of the borrowed copy.
+	for (unsigned k = 0; k < 3; ++k) {
+		dense.naiveIteration();
+		own.naiveIteration();
+		borrowing.naiveIteration();
+	}
+	
+	const auto& ownReader = own;
+	const auto& borrowingReader = borrowing;
+	for (unsigned i = 0; i < 32; ++i) {
+		for (unsigned j = 0; j < 32; ++j) {
+			EXPECT_DOUBLE_EQ(ownReader.dataEvaluation(i,j).value(), dense.dataEvaluation(i,j).value());
+			EXPECT_DOUBLE_EQ(borrowingReader.dataEvaluation(i,j).value(), dense.dataEvaluation(i,j).value());
+		}
+	}
+}
+
+
+TEST(Workspace, FreeSweeps) {
+	math::memory::Workspace workspace;
+	math::solver::laplace2::FDM<double, double> own(16, 16, 1.0);
+	math::solver::laplace2::FDM<double, double> viewed(16, 16, 1.0);
+	for (auto* fdm : {&own, &viewed}) {
+		fdm->setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+		fdm->setBoundary(math::solver::laplace2::GridEdge::LowerEdge, 2.0);
+	}
+	
+	auto view = math::function::gridView(viewed, 0, 0, 16, 16);
+	for (unsigned k = 0; k < 10; ++k) {
+		math::solver::laplace2::naiveIteration(own);
+		math::solver::laplace2::naiveIteration(view, workspace);
+	}
+	
+	for (unsigned i = 0; i < 16; ++i) {
+		for (unsigned j = 0; j < 16; ++j) EXPECT_DOUBLE_EQ(viewed.dataEvaluation(i,j).value(), own.dataEvaluation(i,j).value());
+	}
+	EXPECT_EQ(workspace.allocations(), 1u);
+	EXPECT_EQ(workspace.recycles(), 9u);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <math/function/square_grid.hpp>
+#include <math/parallel/snapshot.hpp>
+#include <math/solver/laplace.hpp>
+
+
+TEST(Snapshot, PinnedSlots) {
+	math::function::SquareGrid<double, double> grid(4, 4, 1.0);
+	math::parallel::SnapshotPublisher<math::function::SquareGrid<double, double>> publisher(grid);
+	
+	auto first = publisher.pin();
+	EXPECT_EQ(first.version(), 0u);
+	EXPECT_DOUBLE_EQ(first->dataEvaluation(1,1), 0.0);
+	
+	grid.dataEvaluation(1,1) = 1.0;
+	EXPECT_TRUE(publisher.publish(grid));
+	auto second = publisher.pin();
+	EXPECT_EQ(second.version(), 1u);
+	EXPECT_DOUBLE_EQ(second->dataEvaluation(1,1), 1.0);
+	EXPECT_DOUBLE_EQ(first->dataEvaluation(1,1), 0.0);
+	
+	// The third slot is free, then every other slot is pinned.
+	grid.dataEvaluation(1,1) = 2.0;
+	EXPECT_TRUE(publisher.publish(grid));
+	auto third = publisher.pin();
+	grid.dataEvaluation(1,1) = 3.0;
+	EXPECT_FALSE(publisher.publish(grid));
+	EXPECT_EQ(publisher.version(), 2u);
+	EXPECT_DOUBLE_EQ((*first).dataEvaluation(1,1), 0.0);
+	EXPECT_DOUBLE_EQ((*second).dataEvaluation(1,1), 1.0);
+	EXPECT_DOUBLE_EQ((*third).dataEvaluation(1,1), 2.0);
+	
+	// Releasing a snapshot frees its slot.
+	first.release();
+	EXPECT_FALSE(static_cast<bool>(first));
+	EXPECT_TRUE(publisher.publish(grid));
+	EXPECT_DOUBLE_EQ(publisher.pin()->dataEvaluation(1,1), 3.0);
+	
+	math::parallel::Snapshot<math::function::SquareGrid<double, double>> moved(std::move(second));
+	EXPECT_FALSE(static_cast<bool>(second));
+	EXPECT_EQ(moved.version(), 1u);
+}
+
+
+TEST(Snapshot, ConcurrentReaders) {
+	// The writer fills the whole grid with the sweep number, readers must never see a mix.
+	unsigned size = 64;
+	math::function::SquareGrid<double, double> grid(size, size, 1.0);
+	math::parallel::SnapshotPublisher<math::function::SquareGrid<double, double>> publisher(grid);
+	std::atomic<bool> done(false);
+	std::atomic<unsigned> torn(0);
+	std::atomic<unsigned> reads(0);
+	
+	std::vector<std::thread> readers;
+	for (unsigned r = 0; r < 3; ++r) {
+		readers.emplace_back([&]() {
+			unsigned long long last = 0;
+			while (not done.load()) {
+				auto snapshot = publisher.pin();
+				if (snapshot.version() < last) ++torn;
+				last = snapshot.version();
+				
+				double value = snapshot->dataEvaluation(0,0);
+				for (unsigned i = 0; i < size; ++i) {
+					for (unsigned j = 0; j < size; ++j) {
+						if (snapshot->dataEvaluation(i,j) != value) ++torn;
+					}
+				}
+				++reads;
+			}
+		});
+	}
+	
+	unsigned published = 0;
+	for (unsigned sweep = 1; sweep <= 2000; ++sweep) {
+		for (unsigned i = 0; i < size; ++i) {
+			for (unsigned j = 0; j < size; ++j) grid.dataEvaluation(i,j) = sweep;
+		}
+		if (publisher.publish(grid)) ++published;
+	}
+	
+	done.store(true);
+	for (auto& reader : readers) reader.join();
+	EXPECT_EQ(torn.load(), 0u);
+	EXPECT_GT(published, 0u);
+	EXPECT_EQ(publisher.version(), published);
+}
+
+
+TEST(Snapshot, SolverGrid) {
+	// Solver grids are published as their SquareGrid base, copied without the solver.
+	math::solver::laplace2::FDM<double, double> fdm(8, 8, 1.0);
+	fdm.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+	math::parallel::SnapshotPublisher<math::function::SquareGrid<double, math::solver::FiniteElement<double>>> publisher(fdm);
+	
+	for (unsigned k = 0; k < 10; ++k) {
+		fdm.naiveIteration();
+		EXPECT_TRUE(publisher.publish(fdm));
+	}
+	
+	auto snapshot = publisher.pin();
+	EXPECT_EQ(snapshot.version(), 10u);
+	EXPECT_DOUBLE_EQ(snapshot->dataEvaluation(0,3).value(), 1.0);
+	EXPECT_DOUBLE_EQ(snapshot->dataEvaluation(1,3).value(), fdm.dataEvaluation(1,3).value());
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <math/solver/laplace.hpp>
+#include <math/function/sparse_storage.hpp>
 
 template <typename T, typename E>
 void display_grid(const math::solver::laplace2::FDM<T,E>& grid) {
@@ -76,4 +77,136 @@ TEST(LaplaceFDM, ConstructorAndBasics) {
 	fdm.naiveIteration();
 	display_grid<float,float>(fdm);
 	*/
-}
\ No newline at end of file
+}
+
+TEST(LaplaceFDM, LayoutIndependentIteration) {
+	unsigned size = 10;
+	float step = 1.0;
+	math::solver::laplace2::FDM<float, float> rows(size, size, step);
+	math::solver::laplace2::FDM<float, float, math::function::MortonLayout> morton(size, size, step);
+	math::solver::laplace2::FDM<float, float, math::function::TiledLayout<4>> tiles(size, size, step);
+	
+	rows.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+	morton.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+	tiles.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+	rows.setBoundary(math::solver::laplace2::GridEdge::UpperEdge, 2.0);
+	morton.setBoundary(math::solver::laplace2::GridEdge::UpperEdge, 2.0);
+	tiles.setBoundary(math::solver::laplace2::GridEdge::UpperEdge, 2.0);
+	
+	for (unsigned k = 0; k < 20; ++k) {
+		rows.naiveIteration();
+		morton.naiveIteration();
+		tiles.naiveIteration();
+	}
+	
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			EXPECT_FLOAT_EQ(morton.dataEvaluation(i,j).value(), rows.dataEvaluation(i,j).value());
+			EXPECT_FLOAT_EQ(tiles.dataEvaluation(i,j).value(), rows.dataEvaluation(i,j).value());
+		}
+	}
+}
+
+
+TEST(LaplaceFDM, SparseStorageIteration) {
+	unsigned size = 64;
+	float step = 1.0;
+	using Storage = math::function::SparseTileStorage<math::solver::FiniteElement<float>, 64>;
+	math::solver::laplace2::FDM<float, float, math::function::TiledLayout<8>, Storage> sparse(size, size, step);
+	math::solver::laplace2::FDM<float, float> dense(size, size, step);
+	
+	// A frozen electrode covering whole tiles.
+	math::geometry2::SimplePolygon<float> electrode;
+	electrode.addVertex(math::linear::StaticVector<float, 2>({7.5, 7.4}));
+	electrode.addVertex(math::linear::StaticVector<float, 2>({40.6, 7.5}));
+	electrode.addVertex(math::linear::StaticVector<float, 2>({40.5, 40.6}));
+	electrode.addVertex(math::linear::StaticVector<float, 2>({7.4, 40.5}));
+	sparse.setBoundary(electrode, 1.0);
+	dense.setBoundary(electrode, 1.0);
+	sparse.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 0.0);
+	dense.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 0.0);
+	
+	// The 4x4 tiles inside the electrode are uniform.
+	unsigned tiles = sparse.storage().blocks();
+	for (unsigned ty = 1; ty < 5; ++ty) {
+		for (unsigned tx = 1; tx < 5; ++tx) {
+			EXPECT_TRUE(sparse.storage().uniform(ty * 8 + tx));
+		}
+	}
+	
+	for (unsigned k = 0; k < 10; ++k) {
+		sparse.naiveIteration();
+		dense.naiveIteration();
+	}
+	
+	// Uniform frozen tiles are never materialised, nor far tiles the sweeps have not reached.
+	EXPECT_LT(sparse.storage().allocatedBlocks(), tiles - 16);
+	
+	const auto& reader = sparse;
+	for (unsigned i = 0; i < size; ++i) {
+		for (unsigned j = 0; j < size; ++j) {
+			EXPECT_FLOAT_EQ(reader.dataEvaluation(i,j).value(), dense.dataEvaluation(i,j).value());
+			EXPECT_EQ(reader.dataEvaluation(i,j).frozen(), dense.dataEvaluation(i,j).frozen());
+		}
+	}
+}
+
+
+TEST(LaplaceFDM, SparseStorageFarField) {
+	using Storage = math::function::SparseTileStorage<math::solver::FiniteElement<float>, 64>;
+	math::solver::laplace2::FDM<float, float, math::function::TiledLayout<8>, Storage> sparse(64, 64, 1.0);
+	math::solver::laplace2::FDM<float, float> dense(64, 64, 1.0);
+	sparse.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+	dense.setBoundary(math::solver::laplace2::GridEdge::LeftEdge, 1.0);
+	EXPECT_EQ(sparse.storage().allocatedBlocks(), 8u);
+	
+	for (unsigned k = 0; k < 10; ++k) {
+		sparse.naiveIteration();
+		dense.naiveIteration();
+	}
+	
+	// The front reaches the second column of tiles; the constant far field stays uniform.
+	EXPECT_EQ(sparse.storage().allocatedBlocks(), 16u);
+	
+	const auto& reader = sparse;
+	for (unsigned i = 0; i < 64; ++i) {
+		for (unsigned j = 0; j < 64; ++j) EXPECT_FLOAT_EQ(reader.dataEvaluation(i,j).value(), dense.dataEvaluation(i,j).value());
+	}
+}
+
+
+TEST(LaplaceFDM, SparseStoragePartialTiles) {
+	using Storage = math::function::SparseTileStorage<math::solver::FiniteElement<double>, 16>;
+	math::solver::laplace2::FDM<double, double, math::function::TiledLayout<4>, Storage> sparse(30, 27, 1.0);
+	math::solver::laplace2::FDM<double, double, math::function::RowMajorLayout, Storage> rows(30, 27, 1.0);
+	math::solver::laplace2::FDM<double, double> dense(30, 27, 1.0);
+	
+	// Electrode of whole tiles, and grid sizes that are not whole tiles.
+	math::geometry2::SimplePolygon<double> electrode;
+	electrode.addVertex(math::linear::StaticVector<double, 2>({3.5, 3.5}));
+	electrode.addVertex(math::linear::StaticVector<double, 2>({15.5, 3.5}));
+	electrode.addVertex(math::linear::StaticVector<double, 2>({15.5, 11.5}));
+	electrode.addVertex(math::linear::StaticVector<double, 2>({3.5, 11.5}));
+	sparse.setBoundary(electrode, 2.0);
+	rows.setBoundary(electrode, 2.0);
+	dense.setBoundary(electrode, 2.0);
+	sparse.setBoundary(math::solver::laplace2::GridEdge::RightEdge, -1.0);
+	rows.setBoundary(math::solver::laplace2::GridEdge::RightEdge, -1.0);
+	dense.setBoundary(math::solver::laplace2::GridEdge::RightEdge, -1.0);
+	EXPECT_TRUE(sparse.storage().uniform(1 * 8 + 1));
+	
+	for (unsigned k = 0; k < 20; ++k) {
+		sparse.naiveIteration();
+		rows.naiveIteration();
+		dense.naiveIteration();
+	}
+	
+	const auto& tiles = sparse;
+	const auto& lines = rows;
+	for (unsigned i = 0; i < 30; ++i) {
+		for (unsigned j = 0; j < 27; ++j) {
+			EXPECT_DOUBLE_EQ(tiles.dataEvaluation(i,j).value(), dense.dataEvaluation(i,j).value());
+			EXPECT_DOUBLE_EQ(lines.dataEvaluation(i,j).value(), dense.dataEvaluation(i,j).value());
+		}
+	}
+}
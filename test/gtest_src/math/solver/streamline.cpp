@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <math/function/square_grid.hpp>
+#include <math/solver/laplace.hpp>
+#include <math/solver/streamline.hpp>
+
+using Vector = math::linear::StaticVector<double, 2>;
+using Field = math::function::SquareGrid<double, Vector>;
+
+Field make_field(Vector (*function)(const Vector&)) {
+	Field field(41, 41, 0.05, Vector({-1.0, -1.0}));
+	for (unsigned i = 0; i < field.sizex(); ++i) {
+		for (unsigned j = 0; j < field.sizey(); ++j) {
+			field.dataEvaluation(i,j) = function(field.domainfromij(i,j));
+		}
+	}
+	
+	return field;
+}
+
+
+TEST(Streamline, Rotation) {
+	Field field = make_field([](const Vector& p) {return Vector({-p.y(), p.x()});});
+	std::vector<Vector> seeds({Vector({0.5, 0.0}), Vector({0.0, -0.3}), Vector({-0.7, 0.1})});
+	
+	math::solver::StreamlineOptions<double> options;
+	options.step = 0.02;
+	options.maximumSteps = 200;
+	
+	for (auto method : {math::solver::StreamlineMethod::RK4, math::solver::StreamlineMethod::RK45}) {
+		options.method = method;
+		std::vector<math::solver::StreamlineStop> stops;
+		auto lines = math::solver::traceStreamlines(field, seeds, options, &stops);
+		ASSERT_EQ(lines.size(), seeds.size());
+		
+		// Circles around the origin, counter clockwise.
+		for (unsigned s = 0; s < seeds.size(); ++s) {
+			EXPECT_EQ(stops[s], math::solver::StreamlineStop::Steps);
+			EXPECT_EQ(lines[s].numberOfVertices(), 201u);
+			double radius = std::sqrt(seeds[s].dot());
+			for (unsigned v = 0; v < lines[s].numberOfVertices(); ++v) {
+				EXPECT_NEAR(std::sqrt(lines[s][v].dot()), radius, 1e-5);
+			}
+		}
+		
+		EXPECT_GT(lines[0][1].y(), 0.0);
+	}
+	
+	// RK45 takes longer steps on the same path.
+	options.method = math::solver::StreamlineMethod::RK45;
+	options.maximumStep = 0.2;
+	auto lines = math::solver::traceStreamlines(field, seeds, options);
+	EXPECT_GT(lines[0].length(), 2.0 * lines[0].numberOfVertices() * 0.02);
+}
+
+
+TEST(Streamline, Stops) {
+	Field field = make_field([](const Vector& p) {return Vector({1.0, 0.5 * p.y()});});
+	std::vector<Vector> seeds({Vector({0.0, 0.0}), Vector({-0.5, 0.2}), Vector({2.0, 0.0})});
+	
+	math::solver::StreamlineOptions<double> options;
+	options.step = 0.03;
+	std::vector<math::solver::StreamlineStop> stops;
+	
+	// Leaves through the right edge.
+	auto lines = math::solver::traceStreamlines(field, seeds, options, &stops);
+	EXPECT_EQ(stops[0], math::solver::StreamlineStop::Domain);
+	EXPECT_DOUBLE_EQ(lines[0].end().x(), 1.0);
+	EXPECT_NEAR(lines[0].end().y(), 0.0, 1e-12);
+	EXPECT_EQ(stops[1], math::solver::StreamlineStop::Domain);
+	EXPECT_DOUBLE_EQ(lines[1].end().x(), 1.0);
+	EXPECT_EQ(stops[2], math::solver::StreamlineStop::Domain);
+	EXPECT_EQ(lines[2].numberOfVertices(), 1u);
+	
+	// Backward, leaves through the left edge.
+	options.backward = true;
+	lines = math::solver::traceStreamlines(field, seeds, options, &stops);
+	EXPECT_DOUBLE_EQ(lines[0].end().x(), -1.0);
+	options.backward = false;
+	
+	// Hits a frozen region.
+	auto frozen = [](const Vector& p) {return p.x() > 0.5;};
+	lines = math::solver::traceStreamlines(field, seeds, options, frozen, &stops);
+	EXPECT_EQ(stops[0], math::solver::StreamlineStop::Frozen);
+	EXPECT_GT(lines[0].end().x(), 0.5);
+	EXPECT_LT(lines[0].end().x(), 0.5 + options.step + 1e-12);
+	
+	// Stagnation.
+	Field still = make_field([](const Vector&) {return Vector();});
+	lines = math::solver::traceStreamlines(still, seeds, options, &stops);
+	EXPECT_EQ(stops[0], math::solver::StreamlineStop::Stagnation);
+	EXPECT_EQ(lines[0].numberOfVertices(), 1u);
+}
+
+
+TEST(Streamline, BatchesAndThreads) {
+	Field field = make_field([](const Vector& p) {return Vector({-p.y() + 0.3, p.x() * p.x()});});
+	std::vector<Vector> seeds;
+	for (unsigned k = 0; k < 50; ++k) seeds.push_back(Vector({-0.9 + 0.036 * k, 0.8 - 0.03 * k}));
+	
+	math::solver::StreamlineOptions<double> options;
+	options.method = math::solver::StreamlineMethod::RK45;
+	auto reference = math::solver::traceStreamlines(field, seeds, options);
+	
+	options.batchSize = 7;
+	options.threads = 4;
+	auto threaded = math::solver::traceStreamlines(field, seeds, options);
+	
+	for (unsigned s = 0; s < seeds.size(); ++s) {
+		ASSERT_EQ(threaded[s].numberOfVertices(), reference[s].numberOfVertices());
+		for (unsigned v = 0; v < reference[s].numberOfVertices(); ++v) {
+			EXPECT_EQ(threaded[s][v], reference[s][v]);
+		}
+	}
+}
+
+
+TEST(Streamline, FrozenRegionOfSolver) {
+	math::solver::laplace2::FDM<double, double> fdm(11, 11, 0.1);
+	fdm.setBoundary(math::solver::laplace2::GridEdge::RightEdge, 1.0);
+	
+	auto frozen = math::solver::frozenRegion(fdm);
+	EXPECT_TRUE(frozen(Vector({0.98, 0.5})));
+	EXPECT_FALSE(frozen(Vector({0.9, 0.5})));
+	EXPECT_FALSE(frozen(Vector({2.0, 0.5})));
+}